@@ -77,6 +77,8 @@ constexpr auto kForwardMessagesOnAdd = 100;
 constexpr auto kProxyPromotionInterval = TimeId(60 * 60);
 constexpr auto kProxyPromotionMinDelay = TimeId(10);
 constexpr auto kSmallDelayMs = 5;
+constexpr auto kPeersPerRequest = 100;
+constexpr auto kMessagesPerRequest = 100;
 constexpr auto kUnreadMentionsPreloadIfLess = 5;
 constexpr auto kUnreadMentionsFirstRequestLimit = 10;
 constexpr auto kUnreadMentionsNextRequestLimit = 100;
@@ -185,7 +187,11 @@ MTPInputPrivacyKey ApiWrap::Privacy::Input(Key key) {
 
 ApiWrap::ApiWrap(not_null<AuthSession*> session)
 : _session(session)
+, _messageDataRequests(kMessagesPerRequest)
 , _messageDataResolveDelayed([=] { resolveMessageDatas(); })
+, _peerRequests(kPeersPerRequest)
+, _peerRequestsDelayed([=] { sendPeerRequests(); })
+, _webPageRequests(kMessagesPerRequest)
 , _webPagesTimer([=] { resolveWebPages(); })
 , _draftsSaveTimer([=] { saveDraftsToCloud(); })
 , _featuredSetsReadTimer([=] { readFeaturedSets(); })
@@ -491,81 +497,47 @@ void ApiWrap::sendMessageFail(const RPCError &error) {
 }
 
 void ApiWrap::requestMessageData(ChannelData *channel, MsgId msgId, RequestMessageDataCallback callback) {
-	auto &req = (channel ? _channelMessageDataRequests[channel][msgId] : _messageDataRequests[msgId]);
+	const auto id = FullMsgId(channel ? channel->bareId() : NoChannel, msgId);
 	if (callback) {
-		req.callbacks.append(callback);
+		_messageDataCallbacks[id].push_back(callback);
 	}
-	if (!req.requestId) _messageDataResolveDelayed.call();
-}
-
-QVector<MTPInputMessage> ApiWrap::collectMessageIds(const MessageDataRequests &requests) {
-	auto result = QVector<MTPInputMessage>();
-	result.reserve(requests.size());
-	for (auto i = requests.cbegin(), e = requests.cend(); i != e; ++i) {
-		if (i.value().requestId > 0) continue;
-		result.push_back(MTP_inputMessageID(MTP_int(i.key())));
+	if (_messageDataRequests.add(channel, id)) {
+		_messageDataResolveDelayed.call();
 	}
-	return result;
-}
-
-ApiWrap::MessageDataRequests *ApiWrap::messageDataRequests(ChannelData *channel, bool onlyExisting) {
-	if (channel) {
-		auto i = _channelMessageDataRequests.find(channel);
-		if (i == _channelMessageDataRequests.cend()) {
-			if (onlyExisting) {
-				return nullptr;
-			}
-			i = _channelMessageDataRequests.insert(channel, MessageDataRequests());
-		}
-		return &i.value();
-	}
-	return &_messageDataRequests;
 }
 
 void ApiWrap::resolveMessageDatas() {
-	if (_messageDataRequests.isEmpty() && _channelMessageDataRequests.isEmpty()) return;
-
-	auto ids = collectMessageIds(_messageDataRequests);
-	if (!ids.isEmpty()) {
-		auto requestId = request(MTPmessages_GetMessages(
-			MTP_vector<MTPInputMessage>(ids)
-		)).done([this](const MTPmessages_Messages &result, mtpRequestId requestId) {
-			gotMessageDatas(nullptr, result, requestId);
-		}).fail([this](const RPCError &error, mtpRequestId requestId) {
-			finalizeMessageDataRequest(nullptr, requestId);
-		}).afterDelay(kSmallDelayMs).send();
-		for (auto &request : _messageDataRequests) {
-			if (request.requestId > 0) continue;
-			request.requestId = requestId;
-		}
-	}
-	for (auto j = _channelMessageDataRequests.begin(); j != _channelMessageDataRequests.cend();) {
-		if (j->isEmpty()) {
-			j = _channelMessageDataRequests.erase(j);
-			continue;
-		}
-		auto ids = collectMessageIds(j.value());
-		if (!ids.isEmpty()) {
-			auto channel = j.key();
-			auto requestId = request(MTPchannels_GetMessages(
-				j.key()->inputChannel,
-				MTP_vector<MTPInputMessage>(ids)
-			)).done([=](const MTPmessages_Messages &result, mtpRequestId requestId) {
-				gotMessageDatas(channel, result, requestId);
-			}).fail([=](const RPCError &error, mtpRequestId requestId) {
-				finalizeMessageDataRequest(channel, requestId);
-			}).afterDelay(kSmallDelayMs).send();
-
-			for (auto &request : *j) {
-				if (request.requestId > 0) continue;
-				request.requestId = requestId;
-			}
+	for (const auto &batch : _messageDataRequests.take()) {
+		const auto channel = batch.group;
+		const auto ids = batch.ids;
+		auto inputs = QVector<MTPInputMessage>();
+		inputs.reserve(ids.size());
+		for (const auto &id : ids) {
+			inputs.push_back(MTP_inputMessageID(MTP_int(id.msg)));
+		}
+		const auto done = [=](const MTPmessages_Messages &result) {
+			gotMessageDatas(channel, result, ids);
+		};
+		const auto fail = [=](const RPCError &error) {
+			finalizeMessageDataRequest(channel, ids);
+		};
+		if (channel) {
+			request(MTPchannels_GetMessages(
+				channel->inputChannel,
+				MTP_vector<MTPInputMessage>(inputs)
+			)).done(done).fail(fail).afterDelay(kSmallDelayMs).send();
+		} else {
+			request(MTPmessages_GetMessages(
+				MTP_vector<MTPInputMessage>(inputs)
+			)).done(done).fail(fail).afterDelay(kSmallDelayMs).send();
 		}
-		++j;
 	}
 }
 
-void ApiWrap::gotMessageDatas(ChannelData *channel, const MTPmessages_Messages &msgs, mtpRequestId requestId) {
+void ApiWrap::gotMessageDatas(
+		ChannelData *channel,
+		const MTPmessages_Messages &msgs,
+		const std::vector<FullMsgId> &ids) {
 	auto handleResult = [&](auto &&result) {
 		_session->data().processUsers(result.vusers);
 		_session->data().processChats(result.vchats);
@@ -591,27 +563,19 @@ void ApiWrap::gotMessageDatas(ChannelData *channel, const MTPmessages_Messages &
 		LOG(("API Error: received messages.messagesNotModified! (ApiWrap::gotDependencyItem)"));
 		break;
 	}
-	finalizeMessageDataRequest(channel, requestId);
+	finalizeMessageDataRequest(channel, ids);
 }
 
 void ApiWrap::finalizeMessageDataRequest(
 		ChannelData *channel,
-		mtpRequestId requestId) {
-	auto requests = messageDataRequests(channel, true);
-	if (requests) {
-		for (auto i = requests->begin(); i != requests->cend();) {
-			if (i.value().requestId == requestId) {
-				for_const (auto &callback, i.value().callbacks) {
-					callback(channel, i.key());
-				}
-				i = requests->erase(i);
-			} else {
-				++i;
+		const std::vector<FullMsgId> &ids) {
+	_messageDataRequests.finished(ids);
+	for (const auto &id : ids) {
+		if (const auto callbacks = _messageDataCallbacks.take(id)) {
+			for (const auto &callback : *callbacks) {
+				callback(channel, id.msg);
 			}
 		}
-		if (channel && requests->isEmpty()) {
-			_channelMessageDataRequests.remove(channel);
-		}
 	}
 }
 
@@ -1138,41 +1102,69 @@ void ApiWrap::gotUserFull(
 }
 
 void ApiWrap::requestPeer(not_null<PeerData*> peer) {
-	if (_fullPeerRequests.contains(peer) || _peerRequests.contains(peer)) {
+	if (_fullPeerRequests.contains(peer)) {
 		return;
 	}
+	const auto type = peer->isUser()
+		? PeerRequestType::User
+		: peer->isChat()
+		? PeerRequestType::Chat
+		: PeerRequestType::Channel;
+	if (_peerRequests.add(type, peer)) {
+		_peerRequestsDelayed.call();
+	}
+}
 
-	const auto requestId = [&] {
+void ApiWrap::sendPeerRequests() {
+	for (const auto &batch : _peerRequests.take()) {
+		const auto peers = batch.ids;
 		const auto failHandler = [=](const RPCError &error) {
-			_peerRequests.remove(peer);
+			_peerRequests.finished(peers);
 		};
 		const auto chatHandler = [=](const MTPmessages_Chats &result) {
-			_peerRequests.remove(peer);
+			_peerRequests.finished(peers);
 			const auto &chats = result.match([](const auto &data) {
 				return data.vchats;
 			});
 			_session->data().applyMaximumChatVersions(chats);
 			_session->data().processChats(chats);
 		};
-		if (const auto user = peer->asUser()) {
-			return request(MTPusers_GetUsers(
-				MTP_vector<MTPInputUser>(1, user->inputUser)
+		switch (batch.group) {
+		case PeerRequestType::User: {
+			auto users = QVector<MTPInputUser>();
+			users.reserve(peers.size());
+			for (const auto peer : peers) {
+				users.push_back(peer->asUser()->inputUser);
+			}
+			request(MTPusers_GetUsers(
+				MTP_vector<MTPInputUser>(users)
 			)).done([=](const MTPVector<MTPUser> &result) {
-				_peerRequests.remove(user);
+				_peerRequests.finished(peers);
 				_session->data().processUsers(result);
 			}).fail(failHandler).send();
-		} else if (const auto chat = peer->asChat()) {
-			return request(MTPmessages_GetChats(
-				MTP_vector<MTPint>(1, chat->inputChat)
+		} break;
+		case PeerRequestType::Chat: {
+			auto chats = QVector<MTPint>();
+			chats.reserve(peers.size());
+			for (const auto peer : peers) {
+				chats.push_back(peer->asChat()->inputChat);
+			}
+			request(MTPmessages_GetChats(
+				MTP_vector<MTPint>(chats)
 			)).done(chatHandler).fail(failHandler).send();
-		} else if (const auto channel = peer->asChannel()) {
-			return request(MTPchannels_GetChannels(
-				MTP_vector<MTPInputChannel>(1, channel->inputChannel)
+		} break;
+		case PeerRequestType::Channel: {
+			auto channels = QVector<MTPInputChannel>();
+			channels.reserve(peers.size());
+			for (const auto peer : peers) {
+				channels.push_back(peer->asChannel()->inputChannel);
+			}
+			request(MTPchannels_GetChannels(
+				MTP_vector<MTPInputChannel>(channels)
 			)).done(chatHandler).fail(failHandler).send();
+		} break;
 		}
-		Unexpected("Peer type in requestPeer.");
-	}();
-	_peerRequests.insert(peer, requestId);
+	}
 }
 
 void ApiWrap::migrateChat(
@@ -1325,48 +1317,11 @@ void ApiWrap::markMediaRead(not_null<HistoryItem*> item) {
 }
 
 void ApiWrap::requestPeers(const QList<PeerData*> &peers) {
-	QVector<MTPint> chats;
-	QVector<MTPInputChannel> channels;
-	QVector<MTPInputUser> users;
-	chats.reserve(peers.size());
-	channels.reserve(peers.size());
-	users.reserve(peers.size());
 	for (const auto peer : peers) {
-		if (!peer
-			|| _fullPeerRequests.contains(peer)
-			|| _peerRequests.contains(peer)) {
-			continue;
-		}
-		if (const auto user = peer->asUser()) {
-			users.push_back(user->inputUser);
-		} else if (const auto chat = peer->asChat()) {
-			chats.push_back(chat->inputChat);
-		} else if (const auto channel = peer->asChannel()) {
-			channels.push_back(channel->inputChannel);
+		if (peer) {
+			requestPeer(peer);
 		}
 	}
-	const auto handleChats = [=](const MTPmessages_Chats &result) {
-		_session->data().processChats(result.match([](const auto &data) {
-			return data.vchats;
-		}));
-	};
-	if (!chats.isEmpty()) {
-		request(MTPmessages_GetChats(
-			MTP_vector<MTPint>(chats)
-		)).done(handleChats).send();
-	}
-	if (!channels.isEmpty()) {
-		request(MTPchannels_GetChannels(
-			MTP_vector<MTPInputChannel>(channels)
-		)).done(handleChats).send();
-	}
-	if (!users.isEmpty()) {
-		request(MTPusers_GetUsers(
-			MTP_vector<MTPInputUser>(users)
-		)).done([=](const MTPVector<MTPUser> &result) {
-			_session->data().processUsers(result);
-		}).send();
-	}
 }
 
 void ApiWrap::requestLastParticipants(not_null<ChannelData*> channel) {
@@ -2609,8 +2564,8 @@ void ApiWrap::gotStickerSet(uint64 setId, const MTPmessages_StickerSet &result)
 }
 
 void ApiWrap::requestWebPageDelayed(WebPageData *page) {
-	if (page->pendingTill <= 0) return;
-	_webPagesPending.insert(page, 0);
+	if (page->pendingTill <= 0 || _webPageRequests.requested(page)) return;
+	_webPagesPending.emplace(page);
 	auto left = (page->pendingTill - unixtime()) * 1000;
 	if (!_webPagesTimer.isActive() || left <= _webPagesTimer.remainingTime()) {
 		_webPagesTimer.callOnce((left < 0 ? 0 : left) + 1);
@@ -2619,83 +2574,64 @@ void ApiWrap::requestWebPageDelayed(WebPageData *page) {
 
 void ApiWrap::clearWebPageRequest(WebPageData *page) {
 	_webPagesPending.remove(page);
-	if (_webPagesPending.isEmpty() && _webPagesTimer.isActive()) {
+	_webPageRequests.remove(page);
+	if (_webPagesPending.empty() && _webPagesTimer.isActive()) {
 		_webPagesTimer.cancel();
 	}
 }
 
 void ApiWrap::clearWebPageRequests() {
 	_webPagesPending.clear();
+	_webPageRequests.clear();
 	_webPagesTimer.cancel();
 }
 
 void ApiWrap::resolveWebPages() {
-	auto ids = QVector<MTPInputMessage>(); // temp_req_id = -1
-	using IndexAndMessageIds = QPair<int32, QVector<MTPInputMessage>>;
-	using MessageIdsByChannel = QMap<ChannelData*, IndexAndMessageIds>;
-	MessageIdsByChannel idsByChannel; // temp_req_id = -index - 2
-
-	ids.reserve(_webPagesPending.size());
 	int32 t = unixtime(), m = INT_MAX;
-	for (auto i = _webPagesPending.begin(); i != _webPagesPending.cend(); ++i) {
-		if (i.value() > 0) continue;
-		if (i.key()->pendingTill <= t) {
-			const auto item = _session->data().findWebPageItem(i.key());
-			if (item) {
-				if (item->channelId() == NoChannel) {
-					ids.push_back(MTP_inputMessageID(MTP_int(item->id)));
-					i.value() = -1;
-				} else {
-					auto channel = item->history()->peer->asChannel();
-					auto channelMap = idsByChannel.find(channel);
-					if (channelMap == idsByChannel.cend()) {
-						channelMap = idsByChannel.insert(
-							channel,
-							IndexAndMessageIds(
-								idsByChannel.size(),
-								QVector<MTPInputMessage>(
-									1,
-									MTP_inputMessageID(MTP_int(item->id)))));
-					} else {
-						channelMap.value().second.push_back(
-							MTP_inputMessageID(MTP_int(item->id)));
-					}
-					i.value() = -channelMap.value().first - 2;
-				}
+	for (auto i = _webPagesPending.begin(); i != _webPagesPending.end();) {
+		const auto page = *i;
+		if (page->pendingTill <= t) {
+			if (const auto item = _session->data().findWebPageItem(page)) {
+				_webPageRequests.add(item->history()->peer->asChannel(), page);
+				i = _webPagesPending.erase(i);
+				continue;
 			}
 		} else {
-			m = qMin(m, i.key()->pendingTill - t);
-		}
-	}
-
-	auto requestId = mtpRequestId(0);
-	if (!ids.isEmpty()) {
-		requestId = request(MTPmessages_GetMessages(
-			MTP_vector<MTPInputMessage>(ids)
-		)).done([=](const MTPmessages_Messages &result, mtpRequestId requestId) {
-			gotWebPages(nullptr, result, requestId);
-		}).afterDelay(kSmallDelayMs).send();
-	}
-	QVector<mtpRequestId> reqsByIndex(idsByChannel.size(), 0);
-	for (auto i = idsByChannel.cbegin(), e = idsByChannel.cend(); i != e; ++i) {
-		reqsByIndex[i.value().first] = request(MTPchannels_GetMessages(
-			i.key()->inputChannel,
-			MTP_vector<MTPInputMessage>(i.value().second)
-		)).done([=, channel = i.key()](const MTPmessages_Messages &result, mtpRequestId requestId) {
-			gotWebPages(channel, result, requestId);
-		}).afterDelay(kSmallDelayMs).send();
-	}
-	if (requestId || !reqsByIndex.isEmpty()) {
-		for (auto &pendingRequestId : _webPagesPending) {
-			if (pendingRequestId > 0) continue;
-			if (pendingRequestId < 0) {
-				if (pendingRequestId == -1) {
-					pendingRequestId = requestId;
-				} else {
-					pendingRequestId = reqsByIndex[-pendingRequestId - 2];
-				}
+			m = qMin(m, page->pendingTill - t);
+		}
+		++i;
+	}
+
+	for (const auto &batch : _webPageRequests.take()) {
+		const auto channel = batch.group;
+		const auto pages = batch.ids;
+		auto ids = QVector<MTPInputMessage>();
+		ids.reserve(pages.size());
+		for (const auto page : pages) {
+			if (const auto item = _session->data().findWebPageItem(page)) {
+				ids.push_back(MTP_inputMessageID(MTP_int(item->id)));
 			}
 		}
+		if (ids.isEmpty()) {
+			_webPageRequests.finished(pages);
+			continue;
+		}
+		const auto done = [=](const MTPmessages_Messages &result) {
+			gotWebPages(channel, result, pages);
+		};
+		const auto fail = [=](const RPCError &error) {
+			_webPageRequests.finished(pages);
+		};
+		if (channel) {
+			request(MTPchannels_GetMessages(
+				channel->inputChannel,
+				MTP_vector<MTPInputMessage>(ids)
+			)).done(done).fail(fail).afterDelay(kSmallDelayMs).send();
+		} else {
+			request(MTPmessages_GetMessages(
+				MTP_vector<MTPInputMessage>(ids)
+			)).done(done).fail(fail).afterDelay(kSmallDelayMs).send();
+		}
 	}
 
 	if (m < INT_MAX) {
@@ -2989,7 +2925,12 @@ void ApiWrap::refreshFileReference(
 	});
 }
 
-void ApiWrap::gotWebPages(ChannelData *channel, const MTPmessages_Messages &msgs, mtpRequestId req) {
+void ApiWrap::gotWebPages(
+		ChannelData *channel,
+		const MTPmessages_Messages &msgs,
+		const std::vector<not_null<WebPageData*>> &pages) {
+	_webPageRequests.finished(pages);
+
 	const QVector<MTPMessage> *v = 0;
 	switch (msgs.type()) {
 	case mtpc_messages_messages: {
@@ -3040,15 +2981,10 @@ void ApiWrap::gotWebPages(ChannelData *channel, const MTPmessages_Messages &msgs
 		}
 	}
 
-	for (auto i = _webPagesPending.begin(); i != _webPagesPending.cend();) {
-		if (i.value() == req) {
-			if (i.key()->pendingTill > 0) {
-				i.key()->pendingTill = -1;
-				_session->data().notifyWebPageUpdateDelayed(i.key());
-			}
-			i = _webPagesPending.erase(i);
-		} else {
-			++i;
+	for (const auto page : pages) {
+		if (page->pendingTill > 0) {
+			page->pendingTill = -1;
+			_session->data().notifyWebPageUpdateDelayed(page);
 		}
 	}
 	_session->data().sendWebPageGamePollNotifications();
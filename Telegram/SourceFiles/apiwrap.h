@@ -10,6 +10,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "base/timer.h"
 #include "base/flat_map.h"
 #include "base/flat_set.h"
+#include "base/request_batches.h"
 #include "mtproto/sender.h"
 #include "chat_helpers/stickers.h"
 #include "data/data_messages.h"
@@ -418,12 +419,11 @@ public:
 	~ApiWrap();
 
 private:
-	struct MessageDataRequest {
-		using Callbacks = QList<RequestMessageDataCallback>;
-		mtpRequestId requestId = 0;
-		Callbacks callbacks;
+	enum class PeerRequestType {
+		User,
+		Chat,
+		Channel,
 	};
-	using MessageDataRequests = QMap<MsgId, MessageDataRequest>;
 	using SharedMediaType = Storage::SharedMediaType;
 
 	struct StickersByEmoji {
@@ -438,13 +438,14 @@ private:
 	void saveDraftsToCloud();
 
 	void resolveMessageDatas();
-	void gotMessageDatas(ChannelData *channel, const MTPmessages_Messages &result, mtpRequestId requestId);
+	void gotMessageDatas(
+		ChannelData *channel,
+		const MTPmessages_Messages &result,
+		const std::vector<FullMsgId> &ids);
 	void finalizeMessageDataRequest(
 		ChannelData *channel,
-		mtpRequestId requestId);
-
-	QVector<MTPInputMessage> collectMessageIds(const MessageDataRequests &requests);
-	MessageDataRequests *messageDataRequests(ChannelData *channel, bool onlyExisting = false);
+		const std::vector<FullMsgId> &ids);
+	void sendPeerRequests();
 	void applyPeerDialogs(const MTPmessages_PeerDialogs &dialogs);
 	void applyFeedDialogs(
 		not_null<Data::Feed*> feed,
@@ -474,7 +475,7 @@ private:
 	void gotWebPages(
 		ChannelData *channel,
 		const MTPmessages_Messages &result,
-		mtpRequestId req);
+		const std::vector<not_null<WebPageData*>> &pages);
 	void gotStickerSet(uint64 setId, const MTPmessages_StickerSet &result);
 
 	void channelRangeDifferenceSend(
@@ -617,13 +618,18 @@ private:
 
 	not_null<AuthSession*> _session;
 
-	MessageDataRequests _messageDataRequests;
-	QMap<ChannelData*, MessageDataRequests> _channelMessageDataRequests;
+	base::request_batches<ChannelData*, FullMsgId> _messageDataRequests;
+	base::flat_map<
+		FullMsgId,
+		std::vector<RequestMessageDataCallback>> _messageDataCallbacks;
 	SingleQueuedInvokation _messageDataResolveDelayed;
 
 	using PeerRequests = QMap<PeerData*, mtpRequestId>;
 	PeerRequests _fullPeerRequests;
-	PeerRequests _peerRequests;
+	base::request_batches<
+		PeerRequestType,
+		not_null<PeerData*>> _peerRequests;
+	SingleQueuedInvokation _peerRequestsDelayed;
 
 	PeerRequests _participantsRequests;
 	PeerRequests _botsRequests;
@@ -653,7 +659,10 @@ private:
 		not_null<ChannelData*>,
 		mtpRequestId> _rangeDifferenceRequests;
 
-	QMap<WebPageData*, mtpRequestId> _webPagesPending;
+	base::flat_set<not_null<WebPageData*>> _webPagesPending;
+	base::request_batches<
+		ChannelData*,
+		not_null<WebPageData*>> _webPageRequests;
 	base::Timer _webPagesTimer;
 
 	QMap<uint64, QPair<uint64, mtpRequestId> > _stickerSetRequests;
@@ -0,0 +1,168 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace base {
+
+// Bump allocator for many small objects that are created together, like
+// the ones parsed from a single network response.
+//
+// Memory is taken from chunks, each chunk counts the objects allocated in
+// it and is freed when all of them are deallocated and the arena doesn't
+// use the chunk anymore. So objects may outlive the arena and be freed on
+// any thread, but one long living object keeps its whole chunk in memory.
+//
+// Types that allocate with allocate_current() use the arena of the
+// innermost chunked_arena_scope on this thread, or the heap without one.
+class chunked_arena {
+public:
+	static constexpr auto kChunkSize = std::size_t(16 * 1024);
+
+	chunked_arena() = default;
+	chunked_arena(const chunked_arena &other) = delete;
+	chunked_arena &operator=(const chunked_arena &other) = delete;
+	~chunked_arena() {
+		if (_chunk) {
+			release(_chunk, kUsed - _allocated);
+		}
+	}
+
+	[[nodiscard]] void *allocate(std::size_t size) {
+		const auto full = kHeaderSize + align(size);
+		if (full > kChunkSize / 4) {
+			const auto single = create(full);
+			const auto result = place(single, 0);
+			release(single, kUsed - 1);
+			return result;
+		} else if (!_chunk || _offset + full > kChunkSize) {
+			if (_chunk) {
+				release(_chunk, kUsed - _allocated);
+			}
+			_chunk = create(kChunkSize);
+			_offset = 0;
+			_allocated = 0;
+		}
+		const auto result = place(_chunk, _offset);
+		_offset += full;
+		++_allocated;
+		return result;
+	}
+
+	// Allocates outside of any arena, compatible with deallocate().
+	[[nodiscard]] static void *allocate_single(std::size_t size) {
+		const auto raw = std::malloc(kHeaderSize + size);
+		if (!raw) {
+			throw std::bad_alloc();
+		}
+		*static_cast<chunk**>(raw) = nullptr;
+		return static_cast<char*>(raw) + kHeaderSize;
+	}
+
+	[[nodiscard]] static void *allocate_current(std::size_t size) {
+		return Current
+			? Current->allocate(size)
+			: allocate_single(size);
+	}
+
+	static void deallocate(void *pointer) {
+		if (!pointer) {
+			return;
+		}
+		const auto raw = static_cast<char*>(pointer) - kHeaderSize;
+		if (const auto owner = *reinterpret_cast<chunk**>(raw)) {
+			release(owner, 1);
+		} else {
+			std::free(raw);
+		}
+	}
+
+	// Count of chunks that are not freed yet in all the arenas.
+	[[nodiscard]] static std::size_t alive_chunks() {
+		return AliveChunks.load(std::memory_order_relaxed);
+	}
+
+private:
+	friend class chunked_arena_scope;
+
+	// While the arena allocates in a chunk its reference count starts
+	// from kUsed, so that objects could be freed before the arena adds
+	// the count of allocated objects with a single atomic operation.
+	static constexpr auto kUsed = std::size_t(1)
+		<< (sizeof(std::size_t) * CHAR_BIT - 2);
+
+	struct alignas(std::max_align_t) chunk {
+		std::atomic<std::size_t> references = kUsed;
+	};
+	static constexpr auto kAlignment = alignof(std::max_align_t);
+	static constexpr auto kHeaderSize = kAlignment;
+	static_assert(sizeof(chunk*) <= kHeaderSize);
+
+	static constexpr std::size_t align(std::size_t size) {
+		return (size + kAlignment - 1) & ~(kAlignment - 1);
+	}
+
+	static chunk *create(std::size_t size) {
+		const auto raw = std::malloc(sizeof(chunk) + size);
+		if (!raw) {
+			throw std::bad_alloc();
+		}
+		AliveChunks.fetch_add(1, std::memory_order_relaxed);
+		return new (raw) chunk();
+	}
+
+	static void *place(chunk *owner, std::size_t offset) {
+		const auto raw = reinterpret_cast<char*>(owner + 1) + offset;
+		*reinterpret_cast<chunk**>(raw) = owner;
+		return raw + kHeaderSize;
+	}
+
+	static void release(chunk *owner, std::size_t count) {
+		const auto was = owner->references.fetch_sub(
+			count,
+			std::memory_order_acq_rel);
+		if (was == count) {
+			owner->~chunk();
+			std::free(owner);
+			AliveChunks.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+	static inline thread_local chunked_arena *Current = nullptr;
+	static inline std::atomic<std::size_t> AliveChunks = 0;
+
+	chunk *_chunk = nullptr;
+	std::size_t _offset = 0;
+	std::size_t _allocated = 0;
+
+};
+
+// Makes allocate_current() use the passed arena on this thread while the
+// scope is alive, nullptr makes it use the heap.
+class chunked_arena_scope {
+public:
+	explicit chunked_arena_scope(chunked_arena *arena)
+	: _previous(std::exchange(chunked_arena::Current, arena)) {
+	}
+	chunked_arena_scope(const chunked_arena_scope &other) = delete;
+	chunked_arena_scope &operator=(const chunked_arena_scope &other) = delete;
+	~chunked_arena_scope() {
+		chunked_arena::Current = _previous;
+	}
+
+private:
+	chunked_arena *_previous = nullptr;
+
+};
+
+} // namespace base
@@ -0,0 +1,198 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "base/chunked_arena.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+const auto DisableBenchmark = true;
+
+namespace {
+
+struct Deleter {
+	void operator()(void *pointer) const {
+		base::chunked_arena::deallocate(pointer);
+	}
+};
+using Pointer = std::unique_ptr<void, Deleter>;
+
+Pointer Fill(void *pointer, std::size_t size, char value) {
+	std::memset(pointer, value, size);
+	return Pointer(pointer);
+}
+
+// Allocated like the data of the parsed MTProto values.
+struct Value {
+	static void *operator new(std::size_t size) {
+		return base::chunked_arena::allocate_current(size);
+	}
+	static void operator delete(void *pointer) {
+		base::chunked_arena::deallocate(pointer);
+	}
+
+	int data = 0;
+};
+
+bool Check(const Pointer &pointer, std::size_t size, char value) {
+	const auto bytes = static_cast<const char*>(pointer.get());
+	for (auto i = std::size_t(); i != size; ++i) {
+		if (bytes[i] != value) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+TEST_CASE("chunked_arena allocations", "[chunked_arena]") {
+	auto engine = std::mt19937(1);
+	auto pointers = std::vector<Pointer>();
+	auto sizes = std::vector<std::size_t>();
+
+	SECTION("objects don't overlap and are aligned") {
+		auto arena = base::chunked_arena();
+		for (auto i = 0; i != 10000; ++i) {
+			const auto size = std::size_t(engine() % 100)
+				+ ((i % 1000) ? 0 : base::chunked_arena::kChunkSize);
+			const auto pointer = arena.allocate(size);
+			REQUIRE(reinterpret_cast<std::uintptr_t>(pointer)
+				% alignof(std::max_align_t) == 0);
+			pointers.push_back(Fill(pointer, size, char(i)));
+			sizes.push_back(size);
+		}
+		for (auto i = 0; i != 10000; ++i) {
+			REQUIRE(Check(pointers[i], sizes[i], char(i)));
+		}
+	}
+
+	SECTION("objects outlive the arena") {
+		{
+			auto arena = base::chunked_arena();
+			for (auto i = 0; i != 1000; ++i) {
+				pointers.push_back(Fill(arena.allocate(64), 64, char(i)));
+			}
+		}
+		pointers.push_back(Fill(
+			base::chunked_arena::allocate_single(64),
+			64,
+			char(1000)));
+		for (auto i = 0; i != 1001; ++i) {
+			REQUIRE(Check(pointers[i], 64, char(i)));
+		}
+	}
+
+	SECTION("objects are freed on other threads") {
+		auto arena = base::chunked_arena();
+		for (auto i = 0; i != 10000; ++i) {
+			pointers.push_back(Fill(arena.allocate(48), 48, char(i)));
+		}
+		auto first = std::vector<Pointer>();
+		for (auto i = 0; i != 10000; i += 2) {
+			first.push_back(std::move(pointers[i]));
+		}
+		auto thread = std::thread([&] {
+			first.clear();
+		});
+		for (auto i = 1; i < 10000; i += 2) {
+			pointers[i] = nullptr;
+		}
+		thread.join();
+	}
+}
+
+TEST_CASE("chunked_arena scope", "[chunked_arena]") {
+	const auto chunks = base::chunked_arena::alive_chunks();
+	auto stored = std::unique_ptr<Value>();
+
+	SECTION("values created after the scope don't keep the chunk") {
+		{
+			auto arena = base::chunked_arena();
+			auto parsed = std::vector<std::unique_ptr<Value>>();
+			{
+				const auto scope = base::chunked_arena_scope(&arena);
+				for (auto i = 0; i != 100; ++i) {
+					parsed.push_back(std::make_unique<Value>());
+				}
+			}
+			REQUIRE(base::chunked_arena::alive_chunks() == chunks + 1);
+
+			stored = std::make_unique<Value>();
+			stored->data = parsed.back()->data + 1;
+		}
+		REQUIRE(base::chunked_arena::alive_chunks() == chunks);
+		REQUIRE(stored->data == 1);
+	}
+
+	SECTION("values created in the scope keep the chunk") {
+		{
+			auto arena = base::chunked_arena();
+			const auto scope = base::chunked_arena_scope(&arena);
+			stored = std::make_unique<Value>();
+			{
+				const auto heap = base::chunked_arena_scope(nullptr);
+				auto detached = std::make_unique<Value>();
+			}
+		}
+		REQUIRE(base::chunked_arena::alive_chunks() == chunks + 1);
+		stored = nullptr;
+		REQUIRE(base::chunked_arena::alive_chunks() == chunks);
+	}
+}
+
+TEST_CASE("chunked_arena benchmark", "[chunked_arena]") {
+	if (DisableBenchmark) {
+		return;
+	}
+
+	// Objects of a large parsed response: messages, users, entities.
+	constexpr auto kCount = 20000;
+	constexpr auto kResponses = 200;
+	auto engine = std::mt19937(1);
+	auto sizes = std::vector<std::size_t>();
+	for (auto i = 0; i != kCount; ++i) {
+		sizes.push_back(16 + (engine() % 20) * 8);
+	}
+	auto pointers = std::vector<void*>(kCount);
+	const auto measure = [&](auto &&parse, auto &&deallocate) {
+		const auto start = std::chrono::steady_clock::now();
+		for (auto i = 0; i != kResponses; ++i) {
+			parse();
+			for (const auto pointer : pointers) {
+				deallocate(pointer);
+			}
+		}
+		return std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now() - start).count();
+	};
+	const auto heap = measure([&] {
+		for (auto i = 0; i != kCount; ++i) {
+			pointers[i] = ::operator new(sizes[i]);
+		}
+	}, [](void *pointer) {
+		::operator delete(pointer);
+	});
+	const auto chunked = measure([&] {
+		auto arena = base::chunked_arena();
+		for (auto i = 0; i != kCount; ++i) {
+			pointers[i] = arena.allocate(sizes[i]);
+		}
+	}, [](void *pointer) {
+		base::chunked_arena::deallocate(pointer);
+	});
+	std::cout
+		<< "heap: " << heap << " ms, "
+		<< "chunked_arena: " << chunked << " ms" << std::endl;
+	REQUIRE(chunked <= heap);
+}
@@ -0,0 +1,331 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include "base/assertion.h"
+
+namespace base {
+
+// Sorted set of unique values for lists with hundreds of thousands items.
+//
+// Values are kept in sorted chunks of at most 2 * kChunkSize items and
+// chunk sizes are summed in a Fenwick tree, so that finding a value,
+// finding its index and finding a value by index are all O(log n) while
+// insert and remove move only the values of one chunk. Merging two sets
+// with non-overlapping values only moves the chunks.
+template <typename Type, typename Compare = std::less<>>
+class chunked_flat_set {
+public:
+	using value_type = Type;
+
+	static constexpr auto kChunkSize = 256;
+
+	int size() const {
+		return _size;
+	}
+	int chunks_count() const {
+		return int(_chunks.size());
+	}
+	bool empty() const {
+		return !_size;
+	}
+	const Type &front() const {
+		return _chunks.front().front();
+	}
+	const Type &back() const {
+		return _chunks.back().back();
+	}
+	void clear() {
+		_chunks.clear();
+		_tree.clear();
+		_size = 0;
+	}
+
+	bool contains(const Type &value) const {
+		const auto chunk = findChunk(value);
+		if (chunk == int(_chunks.size())) {
+			return false;
+		}
+		const auto &values = _chunks[chunk];
+		const auto i = std::lower_bound(
+			values.begin(),
+			values.end(),
+			value,
+			Compare());
+		return (i != values.end()) && !Compare()(value, *i);
+	}
+
+	// Index of the first value that is not less than the passed one.
+	int lower_bound_index(const Type &value) const {
+		const auto chunk = findChunk(value);
+		if (chunk == int(_chunks.size())) {
+			return _size;
+		}
+		const auto &values = _chunks[chunk];
+		const auto i = std::lower_bound(
+			values.begin(),
+			values.end(),
+			value,
+			Compare());
+		return countBefore(chunk) + int(i - values.begin());
+	}
+
+	// Values with indices in [from, till).
+	std::vector<Type> slice(int from, int till) const {
+		Expects(from >= 0 && from <= till && till <= _size);
+
+		auto result = std::vector<Type>();
+		if (from == till) {
+			return result;
+		}
+		result.reserve(till - from);
+		auto [chunk, offset] = findIndex(from);
+		for (auto left = till - from; left > 0; ++chunk, offset = 0) {
+			const auto &values = _chunks[chunk];
+			const auto add = std::min(left, int(values.size()) - offset);
+			result.insert(
+				result.end(),
+				values.begin() + offset,
+				values.begin() + offset + add);
+			left -= add;
+		}
+		return result;
+	}
+
+	bool insert(const Type &value) {
+		if (_chunks.empty()) {
+			_chunks.push_back({ value });
+			_size = 1;
+			rebuildTree();
+			return true;
+		}
+		const auto chunk = std::min(
+			findChunk(value),
+			int(_chunks.size()) - 1);
+		auto &values = _chunks[chunk];
+		const auto i = std::lower_bound(
+			values.begin(),
+			values.end(),
+			value,
+			Compare());
+		if (i != values.end() && !Compare()(value, *i)) {
+			return false;
+		}
+		values.insert(i, value);
+		++_size;
+		if (values.size() > 2 * kChunkSize) {
+			splitChunk(chunk);
+		} else {
+			addToTree(chunk, 1);
+		}
+		return true;
+	}
+
+	bool remove(const Type &value) {
+		const auto chunk = findChunk(value);
+		if (chunk == int(_chunks.size())) {
+			return false;
+		}
+		auto &values = _chunks[chunk];
+		const auto i = std::lower_bound(
+			values.begin(),
+			values.end(),
+			value,
+			Compare());
+		if (i == values.end() || Compare()(value, *i)) {
+			return false;
+		}
+		values.erase(i);
+		--_size;
+		if (values.size() < kChunkSize / 4) {
+			joinChunk(chunk);
+		} else {
+			addToTree(chunk, -1);
+		}
+		return true;
+	}
+
+	// Values in [first, last) may be unsorted and contain duplicates.
+	// Returns the count of the values that were added.
+	template <
+		typename Iterator,
+		typename = typename std::iterator_traits<Iterator>::iterator_category>
+	int merge(Iterator first, Iterator last) {
+		auto values = std::vector<Type>(first, last);
+		std::sort(values.begin(), values.end(), Compare());
+		values.erase(
+			std::unique(values.begin(), values.end(), [](
+					const Type &a,
+					const Type &b) {
+				return !Compare()(a, b);
+			}),
+			values.end());
+		if (values.empty()) {
+			return 0;
+		}
+		auto other = chunked_flat_set();
+		other._size = int(values.size());
+		for (auto i = 0; i < other._size; i += kChunkSize) {
+			const auto till = std::min(i + kChunkSize, other._size);
+			other._chunks.emplace_back(
+				std::make_move_iterator(values.begin() + i),
+				std::make_move_iterator(values.begin() + till));
+		}
+		other.rebuildTree();
+		return merge(std::move(other));
+	}
+
+	template <typename Range>
+	int merge(const Range &range) {
+		return merge(std::begin(range), std::end(range));
+	}
+
+	// Returns the count of the values that were added.
+	int merge(chunked_flat_set &&other) {
+		if (other.empty()) {
+			return 0;
+		} else if (empty()) {
+			*this = std::move(other);
+			return _size;
+		} else if (other._size < kChunkSize) {
+			// Small chunks would make the tree large, add values one by one.
+			const auto was = _size;
+			for (const auto &values : other._chunks) {
+				for (const auto &value : values) {
+					insert(value);
+				}
+			}
+			other.clear();
+			return _size - was;
+		} else if (Compare()(back(), other.front())) {
+			_chunks.insert(
+				_chunks.end(),
+				std::make_move_iterator(other._chunks.begin()),
+				std::make_move_iterator(other._chunks.end()));
+		} else if (Compare()(other.back(), front())) {
+			_chunks.insert(
+				_chunks.begin(),
+				std::make_move_iterator(other._chunks.begin()),
+				std::make_move_iterator(other._chunks.end()));
+		} else {
+			// Insert values of the smaller set to the larger one.
+			const auto was = _size;
+			if (other._size > _size) {
+				std::swap(*this, other);
+			}
+			for (const auto &values : other._chunks) {
+				for (const auto &value : values) {
+					insert(value);
+				}
+			}
+			other.clear();
+			return _size - was;
+		}
+		const auto result = other._size;
+		_size += result;
+		other.clear();
+		rebuildTree();
+		return result;
+	}
+
+private:
+	// Index of the first chunk with the last value not less than passed.
+	int findChunk(const Type &value) const {
+		const auto i = std::lower_bound(
+			_chunks.begin(),
+			_chunks.end(),
+			value,
+			[](const std::vector<Type> &values, const Type &value) {
+				return Compare()(values.back(), value);
+			});
+		return int(i - _chunks.begin());
+	}
+
+	int countBefore(int chunk) const {
+		auto result = 0;
+		for (auto i = chunk; i > 0; i -= (i & -i)) {
+			result += _tree[i];
+		}
+		return result;
+	}
+
+	// Chunk containing the value with this index and offset in the chunk.
+	std::pair<int, int> findIndex(int index) const {
+		const auto count = int(_chunks.size());
+		auto step = 1;
+		while (step * 2 <= count) {
+			step *= 2;
+		}
+		auto position = 0;
+		for (; step > 0; step /= 2) {
+			if (position + step <= count
+				&& _tree[position + step] <= index) {
+				position += step;
+				index -= _tree[position];
+			}
+		}
+		return { position, index };
+	}
+
+	void addToTree(int chunk, int delta) {
+		const auto count = int(_chunks.size());
+		for (auto i = chunk + 1; i <= count; i += (i & -i)) {
+			_tree[i] += delta;
+		}
+	}
+
+	void rebuildTree() {
+		const auto count = int(_chunks.size());
+		_tree.assign(count + 1, 0);
+		for (auto i = 1; i <= count; ++i) {
+			_tree[i] += int(_chunks[i - 1].size());
+			const auto parent = i + (i & -i);
+			if (parent <= count) {
+				_tree[parent] += _tree[i];
+			}
+		}
+	}
+
+	void splitChunk(int chunk) {
+		auto &values = _chunks[chunk];
+		auto second = std::vector<Type>(
+			std::make_move_iterator(values.begin() + kChunkSize),
+			std::make_move_iterator(values.end()));
+		values.erase(values.begin() + kChunkSize, values.end());
+		_chunks.insert(_chunks.begin() + chunk + 1, std::move(second));
+		rebuildTree();
+	}
+
+	void joinChunk(int chunk) {
+		auto &values = _chunks[chunk];
+		const auto next = chunk + 1;
+		if (values.empty()) {
+			_chunks.erase(_chunks.begin() + chunk);
+		} else if (next < int(_chunks.size())
+			&& values.size() + _chunks[next].size() <= 2 * kChunkSize) {
+			auto &nextValues = _chunks[next];
+			nextValues.insert(
+				nextValues.begin(),
+				std::make_move_iterator(values.begin()),
+				std::make_move_iterator(values.end()));
+			_chunks.erase(_chunks.begin() + chunk);
+		} else {
+			addToTree(chunk, -1);
+			return;
+		}
+		rebuildTree();
+	}
+
+	std::vector<std::vector<Type>> _chunks;
+	std::vector<int> _tree;
+	int _size = 0;
+
+};
+
+} // namespace base
@@ -0,0 +1,220 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "base/chunked_flat_set.h"
+#include "base/flat_set.h"
+
+#include <chrono>
+#include <random>
+#include <set>
+#include <iostream>
+
+const auto DisableBenchmark = true;
+constexpr auto kQueryLimit = 50;
+
+template <typename Set>
+std::vector<int> AllValues(const Set &set) {
+	return set.slice(0, set.size());
+}
+
+TEST_CASE("chunked_flat_sets should keep items sorted", "[chunked_flat_set]") {
+	base::chunked_flat_set<int> v;
+	REQUIRE(v.insert(0));
+	REQUIRE(v.insert(5));
+	REQUIRE(v.insert(4));
+	REQUIRE(v.insert(2));
+	REQUIRE(!v.insert(4));
+
+	REQUIRE(v.size() == 4);
+	REQUIRE(v.contains(4));
+	REQUIRE(!v.contains(3));
+	REQUIRE(AllValues(v) == std::vector<int>{ 0, 2, 4, 5 });
+
+	SECTION("indices are counted from the front") {
+		REQUIRE(v.lower_bound_index(-1) == 0);
+		REQUIRE(v.lower_bound_index(3) == 2);
+		REQUIRE(v.lower_bound_index(4) == 2);
+		REQUIRE(v.lower_bound_index(6) == 4);
+		REQUIRE(v.slice(1, 3) == std::vector<int>{ 2, 4 });
+	}
+
+	SECTION("removing items keeps the rest") {
+		REQUIRE(v.remove(4));
+		REQUIRE(!v.remove(4));
+		REQUIRE(AllValues(v) == std::vector<int>{ 0, 2, 5 });
+	}
+
+	SECTION("merging unsorted values with duplicates") {
+		const auto values = { 7, 3, 5, 3, -1 };
+		REQUIRE(v.merge(values) == 3);
+		REQUIRE(AllValues(v) == std::vector<int>{ -1, 0, 2, 3, 4, 5, 7 });
+	}
+}
+
+TEST_CASE("chunked_flat_sets merged one by one", "[chunked_flat_set]") {
+	auto v = base::chunked_flat_set<int>();
+	constexpr auto kCount = 100000;
+	for (auto i = 0; i != kCount; ++i) {
+		const auto values = { i };
+		REQUIRE(v.merge(values) == 1);
+	}
+	REQUIRE(v.size() == kCount);
+	REQUIRE(v.chunks_count() <= kCount / base::chunked_flat_set<int>::kChunkSize);
+	REQUIRE(v.lower_bound_index(kCount / 2) == kCount / 2);
+}
+
+TEST_CASE("large chunked_flat_sets", "[chunked_flat_set]") {
+	auto engine = std::mt19937(1);
+	auto v = base::chunked_flat_set<int>();
+	auto check = std::set<int>();
+	const auto compare = [&] {
+		REQUIRE(v.size() == int(check.size()));
+		const auto values = AllValues(v);
+		REQUIRE(std::equal(
+			values.begin(),
+			values.end(),
+			check.begin(),
+			check.end()));
+	};
+
+	for (auto i = 0; i != 20000; ++i) {
+		const auto value = int(engine() % 30000);
+		REQUIRE(v.insert(value) == check.emplace(value).second);
+	}
+	compare();
+
+	SECTION("finding by index") {
+		for (auto i = 0; i != 1000; ++i) {
+			const auto value = int(engine() % 30000);
+			const auto index = v.lower_bound_index(value);
+			const auto expected = std::distance(
+				check.begin(),
+				check.lower_bound(value));
+			REQUIRE(index == expected);
+			REQUIRE(v.contains(value) == (check.count(value) > 0));
+			if (index < v.size()) {
+				REQUIRE(v.slice(index, index + 1).front()
+					== *check.lower_bound(value));
+			}
+		}
+	}
+
+	SECTION("removing most of the items") {
+		for (auto i = 0; i != 100000; ++i) {
+			const auto value = int(engine() % 30000);
+			REQUIRE(v.remove(value) == (check.erase(value) > 0));
+		}
+		compare();
+	}
+
+	SECTION("merging sets") {
+		auto after = base::chunked_flat_set<int>();
+		auto before = base::chunked_flat_set<int>();
+		auto inside = base::chunked_flat_set<int>();
+		for (auto i = 0; i != 3000; ++i) {
+			const auto value = int(engine() % 30000);
+			after.insert(value + 30000);
+			before.insert(value - 30000);
+			inside.insert(value);
+			check.emplace(value + 30000);
+			check.emplace(value - 30000);
+			check.emplace(value);
+		}
+		const auto was = v.size();
+		const auto added = v.merge(std::move(after))
+			+ v.merge(std::move(before))
+			+ v.merge(std::move(inside));
+		REQUIRE(added == int(check.size()) - was);
+		REQUIRE(after.empty());
+		compare();
+	}
+}
+
+// Replays a shared media stream of a large channel: slices of server ids
+// are loaded while scrolling from a random place in both directions, new
+// messages are added at the bottom, some are deleted and each change is
+// followed by an around query, just like in Storage::SparseIdsList.
+template <typename Set, typename Insert, typename Query>
+std::chrono::milliseconds ReplaySharedMedia(Insert insert, Query query) {
+	constexpr auto kCount = 100000;
+	constexpr auto kSlice = 100;
+
+	const auto start = std::chrono::steady_clock::now();
+	auto engine = std::mt19937(1);
+	auto set = Set();
+	auto around = kCount * 2 / 3;
+	auto till = around;
+	auto from = around;
+	auto last = kCount * 3;
+	while (from > 0 || till < kCount * 3) {
+		auto ids = std::vector<int>();
+		const auto up = (till == kCount * 3) || (from > 0 && engine() % 2);
+		if (up) {
+			for (auto i = 0; i != kSlice && from > 0; ++i) {
+				ids.push_back(from -= 3);
+			}
+		} else {
+			for (auto i = 0; i != kSlice && till < kCount * 3; ++i) {
+				ids.push_back(till += 3);
+			}
+		}
+		insert(set, ids);
+		query(set, ids.front());
+		if (engine() % 8 == 0) {
+			insert(set, std::vector<int>(1, ++last));
+			query(set, last);
+		}
+		if (engine() % 8 == 0) {
+			set.remove(ids.back());
+			query(set, ids.back());
+		}
+	}
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - start);
+}
+
+TEST_CASE("chunked_flat_set shared media benchmark", "[chunked_flat_set]") {
+	if (DisableBenchmark) {
+		return;
+	}
+	using Flat = base::flat_set<int>;
+	const auto flat = ReplaySharedMedia<Flat>([](
+			Flat &set,
+			const std::vector<int> &ids) {
+		set.merge(ids.begin(), ids.end());
+	}, [](const Flat &set, int aroundId) {
+		const auto position = std::lower_bound(
+			set.begin(),
+			set.end(),
+			aroundId);
+		const auto before = std::min(
+			int(position - set.begin()),
+			kQueryLimit);
+		const auto after = std::min(
+			int(set.end() - position),
+			kQueryLimit + 1);
+		return std::vector<int>(position - before, position + after);
+	});
+
+	using Chunked = base::chunked_flat_set<int>;
+	const auto chunked = ReplaySharedMedia<Chunked>([](
+			Chunked &set,
+			const std::vector<int> &ids) {
+		set.merge(ids.begin(), ids.end());
+	}, [](const Chunked &set, int aroundId) {
+		const auto position = set.lower_bound_index(aroundId);
+		return set.slice(
+			std::max(position - kQueryLimit, 0),
+			std::min(position + kQueryLimit + 1, set.size()));
+	});
+
+	std::cout
+		<< "flat_set: " << flat.count() << " ms, "
+		<< "chunked_flat_set: " << chunked.count() << " ms" << std::endl;
+	REQUIRE(chunked <= flat);
+}
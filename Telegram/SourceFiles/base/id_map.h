@@ -0,0 +1,195 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "base/assertion.h"
+
+namespace base {
+
+// Hash map from non-zero integer ids to values for large tables that are
+// only growing, like all the peers known to a session.
+//
+// Elements are kept in a single array with open addressing and linear
+// probing, so a lookup usually touches one cache line and there is no
+// allocation for each element. Zero id marks an empty slot, so it can't
+// be a key, and elements can't be erased, only the whole map cleared.
+// Pointers to values are invalidated when the map grows.
+template <typename Id, typename Value>
+class id_map {
+	using slot = std::pair<Id, Value>;
+
+	template <typename Slot>
+	class iterator_base {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = slot;
+		using difference_type = std::ptrdiff_t;
+		using pointer = Slot*;
+		using reference = Slot&;
+
+		iterator_base(Slot *from, Slot *till) : _from(from), _till(till) {
+			skipEmpty();
+		}
+
+		reference operator*() const {
+			return *_from;
+		}
+		pointer operator->() const {
+			return _from;
+		}
+		iterator_base &operator++() {
+			++_from;
+			skipEmpty();
+			return *this;
+		}
+		iterator_base operator++(int) {
+			auto result = *this;
+			++*this;
+			return result;
+		}
+		friend bool operator==(
+				const iterator_base &a,
+				const iterator_base &b) {
+			return (a._from == b._from);
+		}
+		friend bool operator!=(
+				const iterator_base &a,
+				const iterator_base &b) {
+			return (a._from != b._from);
+		}
+
+	private:
+		void skipEmpty() {
+			while (_from != _till && _from->first == Id()) {
+				++_from;
+			}
+		}
+
+		Slot *_from = nullptr;
+		Slot *_till = nullptr;
+
+	};
+
+public:
+	using iterator = iterator_base<slot>;
+	using const_iterator = iterator_base<const slot>;
+
+	[[nodiscard]] int size() const {
+		return _size;
+	}
+	[[nodiscard]] bool empty() const {
+		return !_size;
+	}
+
+	[[nodiscard]] Value *find(Id id) {
+		const auto index = lookup(id);
+		return (index >= 0) ? &_slots[index].second : nullptr;
+	}
+	[[nodiscard]] const Value *find(Id id) const {
+		const auto index = lookup(id);
+		return (index >= 0) ? &_slots[index].second : nullptr;
+	}
+	[[nodiscard]] bool contains(Id id) const {
+		return (lookup(id) >= 0);
+	}
+
+	// Returns the value and true if it was inserted, or the existing value
+	// and false, like std::unordered_map::emplace.
+	template <typename ...Args>
+	std::pair<Value*, bool> emplace(Id id, Args &&...args) {
+		Expects(id != Id());
+
+		if ((_size + 1) * kLoadDenominator > _slots.size() * kLoadNumerator) {
+			rehash(_slots.empty() ? kMinCapacity : (_slots.size() * 2));
+		}
+		auto index = position(id);
+		for (; _slots[index].first != Id(); index = next(index)) {
+			if (_slots[index].first == id) {
+				return { &_slots[index].second, false };
+			}
+		}
+		_slots[index] = slot(id, Value(std::forward<Args>(args)...));
+		++_size;
+		return { &_slots[index].second, true };
+	}
+
+	void clear() {
+		_slots = std::vector<slot>();
+		_size = 0;
+	}
+
+	iterator begin() {
+		return iterator(_slots.data(), _slots.data() + _slots.size());
+	}
+	iterator end() {
+		const auto till = _slots.data() + _slots.size();
+		return iterator(till, till);
+	}
+	const_iterator begin() const {
+		return const_iterator(_slots.data(), _slots.data() + _slots.size());
+	}
+	const_iterator end() const {
+		const auto till = _slots.data() + _slots.size();
+		return const_iterator(till, till);
+	}
+
+private:
+	static constexpr auto kMinCapacity = std::size_t(16);
+	static constexpr auto kLoadNumerator = std::size_t(3);
+	static constexpr auto kLoadDenominator = std::size_t(4);
+
+	std::size_t position(Id id) const {
+		// Fibonacci hashing spreads the sequential ids over the table.
+		const auto hash = std::uint64_t(id) * 0x9E3779B97F4A7C15ULL;
+		return std::size_t(hash >> (64 - _shift));
+	}
+	std::size_t next(std::size_t index) const {
+		return (index + 1) & (_slots.size() - 1);
+	}
+
+	std::ptrdiff_t lookup(Id id) const {
+		if (_slots.empty() || id == Id()) {
+			return -1;
+		}
+		for (auto index = position(id);; index = next(index)) {
+			const auto &current = _slots[index].first;
+			if (current == id) {
+				return std::ptrdiff_t(index);
+			} else if (current == Id()) {
+				return -1;
+			}
+		}
+	}
+
+	void rehash(std::size_t capacity) {
+		auto old = std::exchange(_slots, std::vector<slot>(capacity));
+		_shift = 0;
+		while ((std::size_t(1) << _shift) < capacity) {
+			++_shift;
+		}
+		for (auto &element : old) {
+			if (element.first != Id()) {
+				auto index = position(element.first);
+				while (_slots[index].first != Id()) {
+					index = next(index);
+				}
+				_slots[index] = std::move(element);
+			}
+		}
+	}
+
+	std::vector<slot> _slots;
+	int _size = 0;
+	int _shift = 0;
+
+};
+
+} // namespace base
@@ -0,0 +1,70 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "base/id_map.h"
+
+#include <memory>
+#include <set>
+
+TEST_CASE("id_map finds inserted values", "[id_map]") {
+	auto map = base::id_map<std::uint64_t, int>();
+	REQUIRE(map.empty());
+	REQUIRE(map.find(1) == nullptr);
+	REQUIRE(!map.contains(0));
+
+	constexpr auto kCount = 10000;
+	for (auto i = 1; i <= kCount; ++i) {
+		// Ids of different peer types differ in the high bits only.
+		const auto id = std::uint64_t(i % 3) << 32 | std::uint64_t(i);
+		const auto [value, inserted] = map.emplace(id, i);
+		REQUIRE(inserted);
+		REQUIRE(*value == i);
+	}
+	REQUIRE(map.size() == kCount);
+
+	for (auto i = 1; i <= kCount; ++i) {
+		const auto id = std::uint64_t(i % 3) << 32 | std::uint64_t(i);
+		const auto value = map.find(id);
+		REQUIRE(value != nullptr);
+		REQUIRE(*value == i);
+		REQUIRE(!map.contains(id + (std::uint64_t(3) << 32)));
+	}
+
+	SECTION("existing values are not replaced") {
+		const auto [value, inserted] = map.emplace(std::uint64_t(1) << 32 | 1, 0);
+		REQUIRE(!inserted);
+		REQUIRE(*value == 1);
+		REQUIRE(map.size() == kCount);
+	}
+
+	SECTION("iteration visits each value once") {
+		auto visited = std::set<int>();
+		for (const auto &[id, value] : map) {
+			REQUIRE(std::uint32_t(id) == std::uint32_t(value));
+			REQUIRE(visited.emplace(value).second);
+		}
+		REQUIRE(visited.size() == kCount);
+	}
+
+	SECTION("clear removes everything") {
+		map.clear();
+		REQUIRE(map.empty());
+		REQUIRE(map.find(1) == nullptr);
+		REQUIRE(map.begin() == map.end());
+	}
+}
+
+TEST_CASE("id_map holds move only values", "[id_map]") {
+	auto map = base::id_map<int, std::unique_ptr<int>>();
+	for (auto i = 1; i != 100; ++i) {
+		map.emplace(i, std::make_unique<int>(i));
+	}
+	for (auto i = 1; i != 100; ++i) {
+		REQUIRE(**map.find(i) == i);
+	}
+}
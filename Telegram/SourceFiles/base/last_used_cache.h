@@ -18,6 +18,8 @@ public:
 	void remove(Entry entry);
 	void clear();
 
+	int size() const;
+	Entry lowest() const;
 	Entry take_lowest();
 
 private:
@@ -54,6 +56,16 @@ void last_used_cache<Entry>::clear() {
 	_map.clear();
 }
 
+template <typename Entry>
+int last_used_cache<Entry>::size() const {
+	return int(_map.size());
+}
+
+template <typename Entry>
+Entry last_used_cache<Entry>::lowest() const {
+	return _queue.empty() ? Entry() : _queue.front();
+}
+
 template <typename Entry>
 Entry last_used_cache<Entry>::take_lowest() {
 	if (_queue.empty()) {
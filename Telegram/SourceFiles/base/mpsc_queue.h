@@ -0,0 +1,77 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace base {
+
+// Unbounded lock-free queue for many producers and one consumer.
+//
+// push() may be called from any thread, it allocates a node and does one
+// atomic exchange, so producers never wait for each other or for the
+// consumer. pop() and for_each() should be called only from the consumer
+// thread. While a push() is in progress the values pushed after it are not
+// popped or enumerated yet.
+template <typename Type>
+class mpsc_queue {
+public:
+	mpsc_queue() : _head(new node()), _tail(_head.load()) {
+	}
+	mpsc_queue(const mpsc_queue &other) = delete;
+	mpsc_queue &operator=(const mpsc_queue &other) = delete;
+	~mpsc_queue() {
+		while (_tail) {
+			delete std::exchange(_tail, _tail->next.load());
+		}
+	}
+
+	void push(Type &&value) {
+		const auto added = new node();
+		added->value.emplace(std::move(value));
+		const auto previous = _head.exchange(added, std::memory_order_acq_rel);
+		previous->next.store(added, std::memory_order_release);
+	}
+
+	std::optional<Type> pop() {
+		const auto next = _tail->next.load(std::memory_order_acquire);
+		if (!next) {
+			return std::nullopt;
+		}
+		auto result = std::move(next->value);
+		next->value.reset();
+		delete std::exchange(_tail, next);
+		return result;
+	}
+
+	// Enumerates the values that can be popped now, without popping them.
+	template <typename Callback>
+	void for_each(Callback &&callback) const {
+		auto next = _tail->next.load(std::memory_order_acquire);
+		while (next) {
+			callback(*next->value);
+			next = next->next.load(std::memory_order_acquire);
+		}
+	}
+
+private:
+	struct node {
+		std::atomic<node*> next = nullptr;
+		std::optional<Type> value;
+	};
+
+	// The last pushed node.
+	std::atomic<node*> _head;
+
+	// The last popped node, its value is already taken.
+	node *_tail = nullptr;
+
+};
+
+} // namespace base
@@ -0,0 +1,91 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "base/mpsc_queue.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST_CASE("mpsc_queue keeps the order of one producer", "[mpsc_queue]") {
+	base::mpsc_queue<int> queue;
+	REQUIRE(!queue.pop());
+
+	queue.push(1);
+	queue.push(2);
+	REQUIRE(queue.pop() == 1);
+	queue.push(3);
+	REQUIRE(queue.pop() == 2);
+	REQUIRE(queue.pop() == 3);
+	REQUIRE(!queue.pop());
+
+	SECTION("values are enumerated without popping") {
+		queue.push(4);
+		queue.push(5);
+		auto values = std::vector<int>();
+		queue.for_each([&](int value) {
+			values.push_back(value);
+		});
+		REQUIRE(values == std::vector<int>{ 4, 5 });
+		REQUIRE(queue.pop() == 4);
+		REQUIRE(queue.pop() == 5);
+		REQUIRE(!queue.pop());
+	}
+
+	SECTION("move only values are supported") {
+		base::mpsc_queue<std::unique_ptr<int>> values;
+		values.push(std::make_unique<int>(5));
+		const auto value = values.pop();
+		REQUIRE(value.has_value());
+		REQUIRE(**value == 5);
+	}
+
+	SECTION("values left in the queue are destroyed") {
+		const auto counter = std::make_shared<int>(0);
+		{
+			base::mpsc_queue<std::shared_ptr<int>> values;
+			values.push(std::shared_ptr<int>(counter));
+			values.push(std::shared_ptr<int>(counter));
+			REQUIRE(counter.use_count() == 3);
+		}
+		REQUIRE(counter.use_count() == 1);
+	}
+}
+
+TEST_CASE("mpsc_queue with many producers", "[mpsc_queue]") {
+	constexpr auto kProducers = 4;
+	constexpr auto kValues = 100000;
+
+	base::mpsc_queue<std::pair<int, int>> queue;
+	auto producers = std::vector<std::thread>();
+	for (auto i = 0; i != kProducers; ++i) {
+		producers.emplace_back([&queue, i] {
+			for (auto j = 0; j != kValues; ++j) {
+				queue.push({ i, j });
+			}
+		});
+	}
+
+	// Values of each producer should come in the order they were pushed.
+	auto expected = std::vector<int>(kProducers, 0);
+	auto left = kProducers * kValues;
+	while (left > 0) {
+		if (const auto value = queue.pop()) {
+			REQUIRE(value->second == expected[value->first]);
+			++expected[value->first];
+			--left;
+		} else {
+			std::this_thread::yield();
+		}
+	}
+	for (auto &producer : producers) {
+		producer.join();
+	}
+	REQUIRE(!queue.pop());
+	REQUIRE(expected == std::vector<int>(kProducers, kValues));
+}
@@ -0,0 +1,479 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "base/openssl_aes.h"
+
+#include "base/assertion.h"
+
+#if defined _M_X64 || defined _M_IX86 || defined __x86_64__ || defined __i386__
+#define BASE_AES_NI_SUPPORTED
+#include <wmmintrin.h>
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define BASE_AES_NI_TARGET
+#else // _MSC_VER
+#include <cpuid.h>
+#define BASE_AES_NI_TARGET __attribute__((target("aes,sse2")))
+#endif // _MSC_VER
+#endif // x86 or x64
+
+namespace openssl {
+namespace {
+
+// Decrypted data is hashed by parts that fit in the L1 data cache.
+constexpr auto kHashChunkSize = 4096;
+
+// Independent CTR blocks are encrypted together to hide aesenc latency.
+constexpr auto kCtrParallelBlocks = 8;
+
+const unsigned char *Bytes(bytes::const_span data) {
+	return reinterpret_cast<const unsigned char*>(data.data());
+}
+
+unsigned char *Bytes(bytes::span data) {
+	return reinterpret_cast<unsigned char*>(data.data());
+}
+
+void IncrementCounter(unsigned char *counter) {
+	for (auto i = kAesBlockSize; i != 0;) {
+		if (++counter[--i]) {
+			break;
+		}
+	}
+}
+
+AES_KEY FallbackKey(const unsigned char *key, bool encrypt) {
+	auto result = AES_KEY();
+	if (encrypt) {
+		AES_set_encrypt_key(key, kAesKeySize * CHAR_BIT, &result);
+	} else {
+		AES_set_decrypt_key(key, kAesKeySize * CHAR_BIT, &result);
+	}
+	return result;
+}
+
+void FallbackIge(
+		const unsigned char *source,
+		unsigned char *destination,
+		size_t length,
+		const AES_KEY &aes,
+		unsigned char *iv,
+		bool encrypt) {
+	AES_ige_encrypt(
+		source,
+		destination,
+		length,
+		&aes,
+		iv,
+		encrypt ? AES_ENCRYPT : AES_DECRYPT);
+}
+
+void FallbackCtr(
+		unsigned char *data,
+		size_t length,
+		const unsigned char *key,
+		unsigned char *ivec,
+		unsigned char *ecount,
+		unsigned int *num) {
+	auto aes = AES_KEY();
+	AES_set_encrypt_key(key, kAesKeySize * CHAR_BIT, &aes);
+	CRYPTO_ctr128_encrypt(
+		data,
+		data,
+		length,
+		&aes,
+		ivec,
+		ecount,
+		num,
+		(block128_f)AES_encrypt);
+}
+
+#ifdef BASE_AES_NI_SUPPORTED
+
+constexpr auto kRoundKeys = 15;
+
+struct RoundKeys {
+	__m128i keys[kRoundKeys];
+};
+
+bool ComputeHasAesInstructions() {
+	constexpr auto kAesBit = (1U << 25);
+	constexpr auto kSse2Bit = (1U << 26);
+#ifdef _MSC_VER
+	int info[4] = { 0 };
+	__cpuid(info, 1);
+	const auto ecx = unsigned(info[2]);
+	const auto edx = unsigned(info[3]);
+#else // _MSC_VER
+	auto eax = 0U, ebx = 0U, ecx = 0U, edx = 0U;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+		return false;
+	}
+#endif // _MSC_VER
+	return (ecx & kAesBit) && (edx & kSse2Bit);
+}
+
+BASE_AES_NI_TARGET __m128i ExpandEven(__m128i previous, __m128i assist) {
+	assist = _mm_shuffle_epi32(assist, 0xFF);
+	previous = _mm_xor_si128(previous, _mm_slli_si128(previous, 4));
+	previous = _mm_xor_si128(previous, _mm_slli_si128(previous, 4));
+	previous = _mm_xor_si128(previous, _mm_slli_si128(previous, 4));
+	return _mm_xor_si128(previous, assist);
+}
+
+BASE_AES_NI_TARGET __m128i ExpandOdd(__m128i previous, __m128i even) {
+	const auto assist = _mm_shuffle_epi32(
+		_mm_aeskeygenassist_si128(even, 0x00),
+		0xAA);
+	previous = _mm_xor_si128(previous, _mm_slli_si128(previous, 4));
+	previous = _mm_xor_si128(previous, _mm_slli_si128(previous, 4));
+	previous = _mm_xor_si128(previous, _mm_slli_si128(previous, 4));
+	return _mm_xor_si128(previous, assist);
+}
+
+BASE_AES_NI_TARGET void ExpandEncryptKey(
+		const unsigned char *key,
+		RoundKeys &result) {
+	auto &k = result.keys;
+	k[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+	k[1] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + 16));
+
+	// The round constant must be an immediate value.
+#define BASE_AES_EXPAND(index, rcon) \
+	k[index] = ExpandEven( \
+		k[index - 2], \
+		_mm_aeskeygenassist_si128(k[index - 1], rcon)); \
+	if (index + 1 < kRoundKeys) { \
+		k[index + 1] = ExpandOdd(k[index - 1], k[index]); \
+	}
+
+	BASE_AES_EXPAND(2, 0x01);
+	BASE_AES_EXPAND(4, 0x02);
+	BASE_AES_EXPAND(6, 0x04);
+	BASE_AES_EXPAND(8, 0x08);
+	BASE_AES_EXPAND(10, 0x10);
+	BASE_AES_EXPAND(12, 0x20);
+	BASE_AES_EXPAND(14, 0x40);
+
+#undef BASE_AES_EXPAND
+}
+
+BASE_AES_NI_TARGET void ExpandDecryptKey(
+		const unsigned char *key,
+		RoundKeys &result) {
+	auto encrypt = RoundKeys();
+	ExpandEncryptKey(key, encrypt);
+
+	const auto last = kRoundKeys - 1;
+	result.keys[0] = encrypt.keys[last];
+	for (auto i = 1; i != last; ++i) {
+		result.keys[i] = _mm_aesimc_si128(encrypt.keys[last - i]);
+	}
+	result.keys[last] = encrypt.keys[0];
+}
+
+BASE_AES_NI_TARGET __m128i EncryptBlock(__m128i block, const RoundKeys &keys) {
+	block = _mm_xor_si128(block, keys.keys[0]);
+	for (auto i = 1; i != kRoundKeys - 1; ++i) {
+		block = _mm_aesenc_si128(block, keys.keys[i]);
+	}
+	return _mm_aesenclast_si128(block, keys.keys[kRoundKeys - 1]);
+}
+
+BASE_AES_NI_TARGET __m128i DecryptBlock(__m128i block, const RoundKeys &keys) {
+	block = _mm_xor_si128(block, keys.keys[0]);
+	for (auto i = 1; i != kRoundKeys - 1; ++i) {
+		block = _mm_aesdec_si128(block, keys.keys[i]);
+	}
+	return _mm_aesdeclast_si128(block, keys.keys[kRoundKeys - 1]);
+}
+
+// C[i] = E(P[i] ^ C[i - 1]) ^ P[i - 1] or
+// P[i] = D(C[i] ^ P[i - 1]) ^ C[i - 1], iv is (C[-1], P[-1]) in both cases.
+BASE_AES_NI_TARGET void AesNiIge(
+		const unsigned char *source,
+		unsigned char *destination,
+		size_t length,
+		const RoundKeys &keys,
+		unsigned char *iv,
+		bool encrypt) {
+	const auto ivs = reinterpret_cast<__m128i*>(iv);
+	auto ciphertext = _mm_loadu_si128(ivs);
+	auto plaintext = _mm_loadu_si128(ivs + 1);
+	const auto from = reinterpret_cast<const __m128i*>(source);
+	const auto till = from + (length / kAesBlockSize);
+	auto to = reinterpret_cast<__m128i*>(destination);
+	if (encrypt) {
+		for (auto i = from; i != till; ++i, ++to) {
+			const auto block = _mm_loadu_si128(i);
+			const auto result = _mm_xor_si128(
+				EncryptBlock(_mm_xor_si128(block, ciphertext), keys),
+				plaintext);
+			_mm_storeu_si128(to, result);
+			ciphertext = result;
+			plaintext = block;
+		}
+	} else {
+		for (auto i = from; i != till; ++i, ++to) {
+			const auto block = _mm_loadu_si128(i);
+			const auto result = _mm_xor_si128(
+				DecryptBlock(_mm_xor_si128(block, plaintext), keys),
+				ciphertext);
+			_mm_storeu_si128(to, result);
+			ciphertext = block;
+			plaintext = result;
+		}
+	}
+	_mm_storeu_si128(ivs, ciphertext);
+	_mm_storeu_si128(ivs + 1, plaintext);
+}
+
+uint64 SwapBytes(uint64 value) {
+#ifdef _MSC_VER
+	return _byteswap_uint64(value);
+#else // _MSC_VER
+	return __builtin_bswap64(value);
+#endif // _MSC_VER
+}
+
+// The big endian counter is kept in registers while encrypting, writing
+// it to memory after each increment stalls the following vector load.
+class Counter {
+public:
+	explicit Counter(const unsigned char *ivec) {
+		memcpy(&_high, ivec, sizeof(_high));
+		memcpy(&_low, ivec + sizeof(_high), sizeof(_low));
+		_high = SwapBytes(_high);
+		_low = SwapBytes(_low);
+	}
+
+	BASE_AES_NI_TARGET __m128i take() {
+		const auto result = _mm_set_epi64x(
+			int64(SwapBytes(_low)),
+			int64(SwapBytes(_high)));
+		if (!++_low) {
+			++_high;
+		}
+		return result;
+	}
+
+	void save(unsigned char *ivec) const {
+		const auto high = SwapBytes(_high);
+		const auto low = SwapBytes(_low);
+		memcpy(ivec, &high, sizeof(high));
+		memcpy(ivec + sizeof(high), &low, sizeof(low));
+	}
+
+private:
+	uint64 _high = 0;
+	uint64 _low = 0;
+
+};
+
+BASE_AES_NI_TARGET void AesNiCtrBlocks(
+		unsigned char *data,
+		size_t blocks,
+		const RoundKeys &keys,
+		unsigned char *ivec) {
+	const auto &k = keys.keys;
+	auto counter = Counter(ivec);
+	auto to = reinterpret_cast<__m128i*>(data);
+	while (blocks >= kCtrParallelBlocks) {
+		__m128i stream[kCtrParallelBlocks];
+		for (auto i = 0; i != kCtrParallelBlocks; ++i) {
+			stream[i] = _mm_xor_si128(counter.take(), k[0]);
+		}
+		for (auto round = 1; round != kRoundKeys - 1; ++round) {
+			for (auto i = 0; i != kCtrParallelBlocks; ++i) {
+				stream[i] = _mm_aesenc_si128(stream[i], k[round]);
+			}
+		}
+		for (auto i = 0; i != kCtrParallelBlocks; ++i) {
+			stream[i] = _mm_aesenclast_si128(stream[i], k[kRoundKeys - 1]);
+			_mm_storeu_si128(
+				to + i,
+				_mm_xor_si128(_mm_loadu_si128(to + i), stream[i]));
+		}
+		to += kCtrParallelBlocks;
+		blocks -= kCtrParallelBlocks;
+	}
+	for (; blocks != 0; --blocks, ++to) {
+		const auto stream = EncryptBlock(counter.take(), keys);
+		_mm_storeu_si128(to, _mm_xor_si128(_mm_loadu_si128(to), stream));
+	}
+	counter.save(ivec);
+}
+
+BASE_AES_NI_TARGET void AesNiCtr(
+		unsigned char *data,
+		size_t length,
+		const unsigned char *key,
+		unsigned char *ivec,
+		unsigned char *ecount,
+		unsigned int *num) {
+	auto n = *num;
+	for (; n != 0 && length != 0; --length) {
+		*data++ ^= ecount[n];
+		n = (n + 1) % kAesBlockSize;
+	}
+	if (!length) {
+		*num = n;
+		return;
+	}
+	auto keys = RoundKeys();
+	ExpandEncryptKey(key, keys);
+
+	const auto blocks = length / kAesBlockSize;
+	AesNiCtrBlocks(data, blocks, keys, ivec);
+	data += blocks * kAesBlockSize;
+	length -= blocks * kAesBlockSize;
+
+	if (length) {
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(ecount),
+			EncryptBlock(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(ivec)),
+				keys));
+		IncrementCounter(ivec);
+		for (; n != length; ++n) {
+			data[n] ^= ecount[n];
+		}
+	}
+	*num = n;
+}
+
+#endif // BASE_AES_NI_SUPPORTED
+
+void Ige(
+		bytes::const_span source,
+		bytes::span destination,
+		bytes::const_span key,
+		bytes::const_span iv,
+		bool encrypt) {
+	Expects(source.size() == destination.size());
+	Expects(source.size() % kAesBlockSize == 0);
+	Expects(key.size() == kAesKeySize);
+	Expects(iv.size() == kAesIgeIvSize);
+
+	auto ivCopy = bytes::array<kAesIgeIvSize>();
+	bytes::copy(ivCopy, iv);
+	const auto ivBytes = Bytes(bytes::make_span(ivCopy));
+#ifdef BASE_AES_NI_SUPPORTED
+	if (HasAesInstructions()) {
+		auto keys = RoundKeys();
+		if (encrypt) {
+			ExpandEncryptKey(Bytes(key), keys);
+		} else {
+			ExpandDecryptKey(Bytes(key), keys);
+		}
+		AesNiIge(
+			Bytes(source),
+			Bytes(destination),
+			source.size(),
+			keys,
+			ivBytes,
+			encrypt);
+		return;
+	}
+#endif // BASE_AES_NI_SUPPORTED
+	FallbackIge(
+		Bytes(source),
+		Bytes(destination),
+		source.size(),
+		FallbackKey(Bytes(key), encrypt),
+		ivBytes,
+		encrypt);
+}
+
+} // namespace
+
+bool HasAesInstructions() {
+#ifdef BASE_AES_NI_SUPPORTED
+	static const auto result = ComputeHasAesInstructions();
+	return result;
+#else // BASE_AES_NI_SUPPORTED
+	return false;
+#endif // BASE_AES_NI_SUPPORTED
+}
+
+void AesIgeEncrypt(
+		bytes::const_span source,
+		bytes::span destination,
+		bytes::const_span key,
+		bytes::const_span iv) {
+	Ige(source, destination, key, iv, true);
+}
+
+void AesIgeDecrypt(
+		bytes::const_span source,
+		bytes::span destination,
+		bytes::const_span key,
+		bytes::const_span iv) {
+	Ige(source, destination, key, iv, false);
+}
+
+void AesIgeDecryptSha256(
+		bytes::const_span source,
+		bytes::span destination,
+		bytes::const_span key,
+		bytes::const_span iv,
+		not_null<SHA256_CTX*> context) {
+	Expects(source.size() == destination.size());
+	Expects(source.size() % kAesBlockSize == 0);
+	Expects(key.size() == kAesKeySize);
+	Expects(iv.size() == kAesIgeIvSize);
+
+	// Both implementations leave the iv for the next part in ivCopy.
+	auto ivCopy = bytes::array<kAesIgeIvSize>();
+	bytes::copy(ivCopy, iv);
+	const auto ivBytes = Bytes(bytes::make_span(ivCopy));
+#ifdef BASE_AES_NI_SUPPORTED
+	auto keys = RoundKeys();
+	const auto aesni = HasAesInstructions();
+	if (aesni) {
+		ExpandDecryptKey(Bytes(key), keys);
+	}
+#else // BASE_AES_NI_SUPPORTED
+	const auto aesni = false;
+#endif // BASE_AES_NI_SUPPORTED
+	const auto aes = aesni ? AES_KEY() : FallbackKey(Bytes(key), false);
+	const auto length = int(source.size());
+	for (auto offset = 0; offset < length; offset += kHashChunkSize) {
+		const auto size = std::min(length - offset, kHashChunkSize);
+		const auto from = Bytes(source.subspan(offset, size));
+		const auto to = Bytes(destination.subspan(offset, size));
+#ifdef BASE_AES_NI_SUPPORTED
+		if (aesni) {
+			AesNiIge(from, to, size, keys, ivBytes, false);
+		} else {
+			FallbackIge(from, to, size, aes, ivBytes, false);
+		}
+#else // BASE_AES_NI_SUPPORTED
+		FallbackIge(from, to, size, aes, ivBytes, false);
+#endif // BASE_AES_NI_SUPPORTED
+		SHA256_Update(context, to, size);
+	}
+}
+
+void AesCtrEncrypt(
+		bytes::span data,
+		bytes::const_span key,
+		not_null<unsigned char*> ivec,
+		not_null<unsigned char*> ecount,
+		not_null<unsigned int*> num) {
+	Expects(key.size() == kAesKeySize);
+
+#ifdef BASE_AES_NI_SUPPORTED
+	if (HasAesInstructions()) {
+		AesNiCtr(Bytes(data), data.size(), Bytes(key), ivec, ecount, num);
+		return;
+	}
+#endif // BASE_AES_NI_SUPPORTED
+	FallbackCtr(Bytes(data), data.size(), Bytes(key), ivec, ecount, num);
+}
+
+} // namespace openssl
@@ -0,0 +1,57 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/openssl_help.h"
+
+namespace openssl {
+
+// AES-256 in IGE and CTR modes, using the AES-NI instructions when the
+// processor supports them and the OpenSSL functions otherwise.
+//
+// OpenSSL's AES_ige_encrypt() and AES_encrypt() use table based AES even
+// on processors with AES-NI. IGE is chained in both directions, so only
+// a faster block cipher helps it, while CTR blocks are independent and
+// are encrypted eight at a time to fill the AES-NI pipeline.
+constexpr auto kAesKeySize = 32;
+constexpr auto kAesBlockSize = 16;
+constexpr auto kAesIgeIvSize = 32;
+
+[[nodiscard]] bool HasAesInstructions();
+
+// Source and destination sizes should be equal and divisible by the block
+// size. Source and destination may be the same. Key and iv are not changed.
+void AesIgeEncrypt(
+	bytes::const_span source,
+	bytes::span destination,
+	bytes::const_span key,
+	bytes::const_span iv);
+void AesIgeDecrypt(
+	bytes::const_span source,
+	bytes::span destination,
+	bytes::const_span key,
+	bytes::const_span iv);
+
+// Decrypts the source and passes the result to SHA256_Update() by parts,
+// while each part is still in the processor cache.
+void AesIgeDecryptSha256(
+	bytes::const_span source,
+	bytes::span destination,
+	bytes::const_span key,
+	bytes::const_span iv,
+	not_null<SHA256_CTX*> context);
+
+// Same state as in CRYPTO_ctr128_encrypt(): a big endian 128 bit counter,
+// the last encrypted counter and the count of its used bytes.
+void AesCtrEncrypt(
+	bytes::span data,
+	bytes::const_span key,
+	not_null<unsigned char*> ivec,
+	not_null<unsigned char*> ecount,
+	not_null<unsigned int*> num);
+
+} // namespace openssl
@@ -0,0 +1,215 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "base/openssl_aes.h"
+
+#include <chrono>
+#include <random>
+#include <iostream>
+
+const auto DisableBenchmark = true;
+
+namespace {
+
+bytes::vector RandomBytes(std::mt19937 &engine, int size) {
+	auto result = bytes::vector(size);
+	for (auto &byte : result) {
+		byte = bytes::type(engine() & 0xFF);
+	}
+	return result;
+}
+
+bytes::vector OpenSSLIge(
+		const bytes::vector &source,
+		const bytes::vector &key,
+		const bytes::vector &iv,
+		bool encrypt) {
+	auto aes = AES_KEY();
+	const auto raw = reinterpret_cast<const unsigned char*>(key.data());
+	if (encrypt) {
+		AES_set_encrypt_key(raw, 256, &aes);
+	} else {
+		AES_set_decrypt_key(raw, 256, &aes);
+	}
+	auto ivCopy = iv;
+	auto result = bytes::vector(source.size());
+	AES_ige_encrypt(
+		reinterpret_cast<const unsigned char*>(source.data()),
+		reinterpret_cast<unsigned char*>(result.data()),
+		source.size(),
+		&aes,
+		reinterpret_cast<unsigned char*>(ivCopy.data()),
+		encrypt ? AES_ENCRYPT : AES_DECRYPT);
+	return result;
+}
+
+struct CtrState {
+	unsigned char ivec[16] = { 0 };
+	unsigned char ecount[16] = { 0 };
+	unsigned int num = 0;
+};
+
+void OpenSSLCtr(bytes::span data, const bytes::vector &key, CtrState &state) {
+	auto aes = AES_KEY();
+	AES_set_encrypt_key(
+		reinterpret_cast<const unsigned char*>(key.data()),
+		256,
+		&aes);
+	CRYPTO_ctr128_encrypt(
+		reinterpret_cast<const unsigned char*>(data.data()),
+		reinterpret_cast<unsigned char*>(data.data()),
+		data.size(),
+		&aes,
+		state.ivec,
+		state.ecount,
+		&state.num,
+		(block128_f)AES_encrypt);
+}
+
+} // namespace
+
+TEST_CASE("aes ige matches openssl", "[openssl_aes]") {
+	auto engine = std::mt19937(1);
+	const auto key = RandomBytes(engine, openssl::kAesKeySize);
+	const auto iv = RandomBytes(engine, openssl::kAesIgeIvSize);
+
+	for (const auto size : { 16, 32, 48, 1024, 4096 + 16, 65536 }) {
+		const auto plain = RandomBytes(engine, size);
+		auto encrypted = bytes::vector(size);
+		openssl::AesIgeEncrypt(plain, encrypted, key, iv);
+		REQUIRE(encrypted == OpenSSLIge(plain, key, iv, true));
+
+		auto decrypted = bytes::vector(size);
+		openssl::AesIgeDecrypt(encrypted, decrypted, key, iv);
+		REQUIRE(decrypted == plain);
+
+		SECTION("in place") {
+			auto data = plain;
+			openssl::AesIgeEncrypt(data, data, key, iv);
+			REQUIRE(data == encrypted);
+			openssl::AesIgeDecrypt(data, data, key, iv);
+			REQUIRE(data == plain);
+		}
+
+		SECTION("fused with sha256") {
+			auto context = SHA256_CTX();
+			SHA256_Init(&context);
+			SHA256_Update(&context, key.data(), key.size());
+			openssl::AesIgeDecryptSha256(
+				encrypted,
+				decrypted,
+				key,
+				iv,
+				&context);
+			auto hash = bytes::vector(SHA256_DIGEST_LENGTH);
+			SHA256_Final(
+				reinterpret_cast<unsigned char*>(hash.data()),
+				&context);
+			REQUIRE(decrypted == plain);
+			REQUIRE(hash == openssl::Sha256(key, plain));
+		}
+	}
+}
+
+TEST_CASE("aes ctr matches openssl", "[openssl_aes]") {
+	auto engine = std::mt19937(2);
+	const auto key = RandomBytes(engine, openssl::kAesKeySize);
+	const auto iv = RandomBytes(engine, openssl::kAesBlockSize);
+	const auto plain = RandomBytes(engine, 100000);
+
+	auto expected = CtrState();
+	auto state = CtrState();
+	memcpy(expected.ivec, iv.data(), iv.size());
+	memcpy(state.ivec, iv.data(), iv.size());
+
+	// Counter overflow into the higher bytes.
+	for (auto i = 8; i != 16; ++i) {
+		expected.ivec[i] = state.ivec[i] = 0xFF;
+	}
+	expected.ivec[15] = state.ivec[15] = 0xF0;
+
+	auto reference = plain;
+	auto data = plain;
+	auto offset = 0;
+	while (offset < int(plain.size())) {
+		const auto size = std::min(
+			int(engine() % 300),
+			int(plain.size()) - offset);
+		const auto part = bytes::make_span(data).subspan(offset, size);
+		openssl::AesCtrEncrypt(
+			part,
+			key,
+			state.ivec,
+			state.ecount,
+			&state.num);
+		OpenSSLCtr(
+			bytes::make_span(reference).subspan(offset, size),
+			key,
+			expected);
+		REQUIRE(state.num == expected.num);
+		REQUIRE(!memcmp(state.ivec, expected.ivec, sizeof(state.ivec)));
+		offset += size;
+	}
+	REQUIRE(data == reference);
+}
+
+TEST_CASE("aes benchmark", "[openssl_aes]") {
+	if (DisableBenchmark) {
+		return;
+	}
+	constexpr auto kTotal = 64 * 1024 * 1024;
+
+	auto engine = std::mt19937(3);
+	const auto key = RandomBytes(engine, openssl::kAesKeySize);
+	const auto iv = RandomBytes(engine, openssl::kAesIgeIvSize);
+	const auto measure = [](auto &&method) {
+		const auto start = std::chrono::steady_clock::now();
+		method();
+		return std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now() - start).count();
+	};
+	std::cout
+		<< "AES-NI: " << (openssl::HasAesInstructions() ? "yes" : "no")
+		<< std::endl;
+	for (const auto size : { 1024, 16 * 1024, 256 * 1024, 1024 * 1024 }) {
+		auto data = RandomBytes(engine, size);
+		const auto times = kTotal / size;
+		const auto openSSLIge = measure([&] {
+			for (auto i = 0; i != times; ++i) {
+				data = OpenSSLIge(data, key, iv, false);
+			}
+		});
+		const auto ige = measure([&] {
+			for (auto i = 0; i != times; ++i) {
+				openssl::AesIgeDecrypt(data, data, key, iv);
+			}
+		});
+		auto expected = CtrState();
+		const auto openSSLCtr = measure([&] {
+			for (auto i = 0; i != times; ++i) {
+				OpenSSLCtr(data, key, expected);
+			}
+		});
+		auto state = CtrState();
+		const auto ctr = measure([&] {
+			for (auto i = 0; i != times; ++i) {
+				openssl::AesCtrEncrypt(
+					data,
+					key,
+					state.ivec,
+					state.ecount,
+					&state.num);
+			}
+		});
+		std::cout
+			<< size << " bytes, 64 MB total. "
+			<< "IGE decrypt: " << openSSLIge << " ms -> " << ige << " ms, "
+			<< "CTR: " << openSSLCtr << " ms -> " << ctr << " ms"
+			<< std::endl;
+	}
+}
@@ -0,0 +1,102 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include "base/assertion.h"
+#include "base/algorithm.h"
+#include "base/flat_map.h"
+#include "base/flat_set.h"
+
+namespace base {
+
+// Collects ids that are requested at about the same time, so that they
+// are sent as a few vector requests instead of one request for each id.
+//
+// Each id is added with the group it must be requested in, for example
+// the channel of a message. take() splits all the waiting ids into
+// batches of one group and of a limited size. An id that is waiting or
+// is being requested is not added again until its batch is finished().
+template <typename Group, typename Id>
+class request_batches {
+public:
+	struct batch {
+		Group group;
+		std::vector<Id> ids;
+	};
+
+	explicit request_batches(int limit) : _limit(limit) {
+		Expects(limit > 0);
+	}
+
+	// Returns false if the id is already waiting or being requested.
+	bool add(const Group &group, const Id &id) {
+		if (!_requested.emplace(id).second) {
+			return false;
+		}
+		_waiting[group].push_back(id);
+		return true;
+	}
+
+	// Forgets an id that was not taken yet.
+	void remove(const Id &id) {
+		for (auto i = _waiting.begin(); i != _waiting.end(); ++i) {
+			auto &ids = i->second;
+			const auto j = std::find(ids.begin(), ids.end(), id);
+			if (j != ids.end()) {
+				ids.erase(j);
+				if (ids.empty()) {
+					_waiting.erase(i);
+				}
+				_requested.remove(id);
+				return;
+			}
+		}
+	}
+
+	[[nodiscard]] bool requested(const Id &id) const {
+		return _requested.contains(id);
+	}
+	[[nodiscard]] bool waiting() const {
+		return !_waiting.empty();
+	}
+
+	[[nodiscard]] std::vector<batch> take() {
+		auto result = std::vector<batch>();
+		for (auto &[group, ids] : base::take(_waiting)) {
+			for (auto from = ids.begin(); from != ids.end();) {
+				const auto count = std::min(int(ids.end() - from), _limit);
+				result.push_back({
+					group,
+					std::vector<Id>(from, from + count) });
+				from += count;
+			}
+		}
+		return result;
+	}
+
+	// The request of the batch is done or has failed.
+	void finished(const std::vector<Id> &ids) {
+		for (const auto &id : ids) {
+			_requested.remove(id);
+		}
+	}
+
+	void clear() {
+		_waiting.clear();
+		_requested.clear();
+	}
+
+private:
+	const int _limit = 0;
+	base::flat_map<Group, std::vector<Id>> _waiting;
+	base::flat_set<Id> _requested;
+
+};
+
+} // namespace base
@@ -0,0 +1,71 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "base/request_batches.h"
+
+using Batches = base::request_batches<int, int>;
+
+TEST_CASE("request_batches group and split ids", "[request_batches]") {
+	auto batches = Batches(2);
+	REQUIRE(!batches.waiting());
+	REQUIRE(batches.add(1, 10));
+	REQUIRE(batches.add(2, 20));
+	REQUIRE(batches.add(1, 11));
+	REQUIRE(batches.add(1, 12));
+	REQUIRE(!batches.add(1, 11));
+	REQUIRE(batches.waiting());
+
+	const auto taken = batches.take();
+	REQUIRE(!batches.waiting());
+	REQUIRE(taken.size() == 3);
+	REQUIRE(taken[0].group == 1);
+	REQUIRE(taken[0].ids == std::vector<int>{ 10, 11 });
+	REQUIRE(taken[1].group == 1);
+	REQUIRE(taken[1].ids == std::vector<int>{ 12 });
+	REQUIRE(taken[2].group == 2);
+	REQUIRE(taken[2].ids == std::vector<int>{ 20 });
+
+	SECTION("ids being requested are not added again") {
+		REQUIRE(batches.requested(11));
+		REQUIRE(!batches.add(2, 11));
+		REQUIRE(!batches.waiting());
+	}
+
+	SECTION("finished ids can be requested again") {
+		batches.finished(taken[0].ids);
+		REQUIRE(!batches.requested(10));
+		REQUIRE(batches.requested(12));
+		REQUIRE(batches.add(3, 10));
+		REQUIRE(!batches.add(3, 12));
+		const auto again = batches.take();
+		REQUIRE(again.size() == 1);
+		REQUIRE(again[0].group == 3);
+		REQUIRE(again[0].ids == std::vector<int>{ 10 });
+	}
+}
+
+TEST_CASE("request_batches forget removed ids", "[request_batches]") {
+	auto batches = Batches(100);
+	batches.add(1, 10);
+	batches.add(2, 20);
+	batches.add(2, 21);
+
+	batches.remove(10);
+	batches.remove(21);
+	REQUIRE(!batches.requested(10));
+	REQUIRE(batches.requested(20));
+
+	const auto taken = batches.take();
+	REQUIRE(taken.size() == 1);
+	REQUIRE(taken[0].group == 2);
+	REQUIRE(taken[0].ids == std::vector<int>{ 20 });
+
+	batches.clear();
+	REQUIRE(!batches.requested(20));
+	REQUIRE(batches.add(2, 20));
+}
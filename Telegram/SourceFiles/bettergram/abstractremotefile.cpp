@@ -1,10 +1,7 @@
 #include "abstractremotefile.h"
-#include "bettergramservice.h"
+#include "networkfetcher.h"
 
-#include <QTimer>
-#include <QtNetwork/QNetworkAccessManager>
-#include <QtNetwork/QNetworkRequest>
-#include <QtNetwork/QNetworkReply>
+#include <QTimerEvent>
 
 namespace Bettergram {
 
@@ -73,10 +70,10 @@ void AbstractRemoteFile::downloadIfNeeded()
 void AbstractRemoteFile::forceDownload()
 {
 	stopDownloadLaterTimer();
-	download();
+	download(true);
 }
 
-void AbstractRemoteFile::download()
+void AbstractRemoteFile::download(bool isRefreshNeeded)
 {
 	if (!_link.isValid()) {
 		resetData();
@@ -93,30 +90,52 @@ void AbstractRemoteFile::download()
 
 	_isDownloading = true;
 
-	QNetworkAccessManager *networkManager = new QNetworkAccessManager();
+	NetworkFetcher::CachePolicy cachePolicy = NetworkFetcher::CachePolicy::NoCache;
 
-	QNetworkRequest request;
-	request.setUrl(_link);
+	if (isCacheable()) {
+		cachePolicy = isRefreshNeeded
+				? NetworkFetcher::CachePolicy::RefreshCache
+				: NetworkFetcher::CachePolicy::PreferCache;
+	}
 
-	QNetworkReply *reply = networkManager->get(request);
+	NetworkFetcher::instance()->get(_link,
+									NetworkFetcher::Source::Other,
+									cachePolicy,
+									this,
+									[this](const NetworkFetcher::Result &result) {
+		// The link may be changed while we were downloading the previous one
+		if (result.url != _link) {
+			_isDownloading = false;
+			download();
+			return;
+		}
 
-	connect(reply, &QNetworkReply::finished, this, [this, reply]() {
 		_isDownloading = false;
 
-		if(reply->error() == QNetworkReply::NoError) {
+		if(result.error == QNetworkReply::NoError) {
 			_failedCount = 0;
-			dataDownloaded(reply->readAll());
-			_lastDownloadTime = QDateTime::currentDateTime();
+			dataDownloaded(result.data);
+
+			// Cached data keeps the time of its real download
+			if (!result.isFromCache) {
+				_lastDownloadTime = QDateTime::currentDateTime();
+			}
+
 			emit downloaded();
 		} else {
-			LOG(("Can not download file at %1. %2 (%3)")
-				.arg(_link.toString())
-				.arg(reply->errorString())
-				.arg(reply->error()));
+			if (result.isTimedOut()) {
+				LOG(("Can not download file at %1 due timeout")
+					.arg(_link.toString()));
+			} else {
+				LOG(("Can not download file at %1. %2 (%3)")
+					.arg(_link.toString())
+					.arg(result.errorString)
+					.arg(result.error));
+			}
 
 			// If the file does not exist on the server then
 			// there is no any reason to try download it soon
-			if (reply->error() == QNetworkReply::ContentNotFoundError) {
+			if (result.error == QNetworkReply::ContentNotFoundError) {
 				_failedCount = 10000;
 			} else {
 				_failedCount++;
@@ -125,36 +144,6 @@ void AbstractRemoteFile::download()
 			downloadLater();
 		}
 	});
-
-	connect(reply, &QNetworkReply::finished, [networkManager, reply]() {
-		reply->deleteLater();
-		networkManager->deleteLater();
-	});
-
-	connect(this, &AbstractRemoteFile::destroyed, networkManager, [networkManager, reply] {
-		reply->deleteLater();
-		networkManager->deleteLater();
-	});
-
-	QTimer::singleShot(BettergramService::networkTimeout(), Qt::VeryCoarseTimer, networkManager,
-					   [networkManager, reply, this] {
-		_isDownloading = false;
-		_failedCount++;
-
-		reply->deleteLater();
-		networkManager->deleteLater();
-
-		LOG(("Can not download file at %1 due timeout")
-			.arg(_link.toString()));
-
-		downloadLater();
-	});
-
-	connect(reply, &QNetworkReply::sslErrors, this, [](QList<QSslError> errors) {
-		for(const QSslError &error : errors) {
-			LOG(("%1").arg(error.errorString()));
-		}
-	});
 }
 
 void AbstractRemoteFile::timerEvent(QTimerEvent *timerEvent)
@@ -185,6 +174,11 @@ void AbstractRemoteFile::downloadLater()
 	_downloadLaterTimerId = startTimer(timeout, Qt::VeryCoarseTimer);
 }
 
+bool AbstractRemoteFile::isCacheable() const
+{
+	return false;
+}
+
 bool AbstractRemoteFile::checkLink(const QUrl &link)
 {
 	Q_UNUSED(link);
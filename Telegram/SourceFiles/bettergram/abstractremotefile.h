@@ -41,7 +41,11 @@ protected:
 
 	virtual bool checkLink(const QUrl &link);
 
-	void download();
+	/// Cacheable files are stored in the local cache database and are not downloaded again at restarts
+	virtual bool isCacheable() const;
+
+	/// If isRefreshNeeded is true we download the file even if it is in the cache
+	void download(bool isRefreshNeeded = false);
 	void stopDownloadLaterTimer();
 
 	void timerEvent(QTimerEvent *timerEvent) override;
@@ -6,6 +6,7 @@
 #include "resourcegrouplist.h"
 #include "pinnednewslist.h"
 #include "aditem.h"
+#include "servicebenchmark.h"
 
 #include <auth_session.h>
 #include <mainwidget.h>
@@ -22,9 +23,6 @@
 #include <QTimerEvent>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QtNetwork/QNetworkAccessManager>
-#include <QtNetwork/QNetworkRequest>
-#include <QtNetwork/QNetworkReply>
 
 namespace Bettergram {
 
@@ -74,6 +72,24 @@ int BettergramService::networkTimeout()
 	return _networkTimeout;
 }
 
+QString BettergramService::apiUrl(const QString &path)
+{
+	static const QString base = qEnvironmentVariableIsSet("BETTERGRAM_API_URL")
+			? QString::fromLocal8Bit(qgetenv("BETTERGRAM_API_URL"))
+			: QStringLiteral("https://api.bettergram.io/v1");
+
+	return base + '/' + path;
+}
+
+QString BettergramService::pricesUrl(const QString &path)
+{
+	static const QString base = qEnvironmentVariableIsSet("BETTERGRAM_PRICES_URL")
+			? QString::fromLocal8Bit(qgetenv("BETTERGRAM_PRICES_URL"))
+			: QStringLiteral("https://%1.livecoinwatch.com").arg(_pricesUrlPrefix);
+
+	return base + '/' + path;
+}
+
 const QString &BettergramService::defaultLastUpdateString()
 {
 	return _defaultLastUpdateString;
@@ -117,31 +133,9 @@ void BettergramService::sendStatUrl(UrlSource urlSource, const QUrl &targetUrl)
 	urlQuery.addQueryItem(QStringLiteral("source"), convertUrlSourceToString(urlSource));
 	urlQuery.addQueryItem(QStringLiteral("url"), targetUrl.toString());
 
-	QUrl url(QStringLiteral("https://api.bettergram.io/v1/links_stat?").arg(urlQuery.toString()));
-
-	QNetworkAccessManager *networkManager = new QNetworkAccessManager();
-
-	QNetworkRequest request;
-	request.setUrl(url);
+	QUrl url(apiUrl(QStringLiteral("links_stat?")).arg(urlQuery.toString()));
 
-	QNetworkReply *reply = networkManager->get(request);
-
-	//	connect(reply, &QNetworkReply::finished, this, [] {
-	//		// Do nothing here
-	//	});
-
-	connect(reply, &QNetworkReply::finished, [networkManager, reply]() {
-		reply->deleteLater();
-		networkManager->deleteLater();
-	});
-
-	QTimer::singleShot(_networkTimeout * 2, Qt::VeryCoarseTimer, networkManager,
-					   [networkManager, reply] {
-		reply->deleteLater();
-		networkManager->deleteLater();
-
-		LOG(("Can not send link stat"));
-	});
+	NetworkFetcher::instance()->send(url);
 }
 
 QString BettergramService::convertUrlSourceToString(BettergramService::UrlSource urlSource)
@@ -456,33 +450,13 @@ void BettergramService::getIsPaid()
 
 void BettergramService::getCryptoPriceNames()
 {
-	QUrl url(QStringLiteral("https://%1.livecoinwatch.com/currencies").arg(_pricesUrlPrefix));
-
-	QNetworkAccessManager *networkManager = new QNetworkAccessManager();
-
-	QNetworkRequest request;
-	request.setUrl(url);
-
-	QNetworkReply *reply = networkManager->get(request);
-
-	connect(reply, &QNetworkReply::finished,
-			this, &BettergramService::onGetCryptoPriceNamesFinished);
-
-	connect(reply, &QNetworkReply::finished, [networkManager, reply]() {
-		reply->deleteLater();
-		networkManager->deleteLater();
-	});
-
-	QTimer::singleShot(_networkTimeout, Qt::VeryCoarseTimer, networkManager,
-					   [networkManager, reply] {
-		reply->deleteLater();
-		networkManager->deleteLater();
-
-		LOG(("Can not get crypto price names due timeout"));
+	NetworkFetcher::instance()->get(pricesUrl(QStringLiteral("currencies")),
+									NetworkFetcher::Source::Prices,
+									NetworkFetcher::CachePolicy::NoCache,
+									this,
+									[this](const NetworkFetcher::Result &result) {
+		onGetCryptoPriceNamesFinished(result);
 	});
-
-	connect(reply, &QNetworkReply::sslErrors,
-			this, &BettergramService::onSslFailed);
 }
 
 QUrl BettergramService::getCryptoPriceValues(int offset, int count)
@@ -492,8 +466,7 @@ QUrl BettergramService::getCryptoPriceValues(int offset, int count)
 		return QUrl();
 	}
 
-	QUrl url(QStringLiteral("https://%1.livecoinwatch.com/coins?sort=%2&order=%3&offset=%4&limit=%5")
-			 .arg(_pricesUrlPrefix)
+	QUrl url(pricesUrl(QStringLiteral("coins?sort=%1&order=%2&offset=%3&limit=%4"))
 			 .arg(_cryptoPriceList->sortString())
 			 .arg(_cryptoPriceList->orderString())
 			 .arg(offset)
@@ -511,8 +484,7 @@ QUrl BettergramService::getCryptoPriceValues(int offset, int count, const QStrin
 		return QUrl();
 	}
 
-	QUrl url(QStringLiteral("https://%1.livecoinwatch.com/coins?sort=%2&order=%3&offset=%4&limit=%5&only=%6")
-			 .arg(_pricesUrlPrefix)
+	QUrl url(pricesUrl(QStringLiteral("coins?sort=%1&order=%2&offset=%3&limit=%4&only=%5"))
 			 .arg(_cryptoPriceList->sortString())
 			 .arg(_cryptoPriceList->orderString())
 			 .arg(offset)
@@ -536,15 +508,13 @@ QUrl BettergramService::getSearchCryptoPriceValues(int offset, int count)
 	if (_cryptoPriceList->sortOrder() == CryptoPriceList::SortOrder::Rank) {
 		QStringList shortNames = _cryptoPriceList->getSearchListShortNames(offset, count);
 
-		url = QStringLiteral("https://%1.livecoinwatch.com/coins?sort=none&limit=%2&only=%3")
-				.arg(_pricesUrlPrefix)
+		url = pricesUrl(QStringLiteral("coins?sort=none&limit=%1&only=%2"))
 				.arg(shortNames.size())
 				.arg(shortNames.join(QStringLiteral(",")));
 	} else {
 		QStringList shortNames = _cryptoPriceList->getSearchListShortNames();
 
-		url = QStringLiteral("https://%1.livecoinwatch.com/coins?sort=%2&order=%3&offset=%4&limit=%5&only=%6")
-				.arg(_pricesUrlPrefix)
+		url = pricesUrl(QStringLiteral("coins?sort=%1&order=%2&offset=%3&limit=%4&only=%5"))
 				.arg(_cryptoPriceList->sortString())
 				.arg(_cryptoPriceList->orderString())
 				.arg(offset)
@@ -565,49 +535,34 @@ void BettergramService::searchCryptoPriceNames()
 
 	const QString searchText = _cryptoPriceList->searchText();
 
-	const QUrl url(QStringLiteral("https://%1.livecoinwatch.com/currencies?search=%2&type=coin")
-				   .arg(_pricesUrlPrefix)
+	const QUrl url(pricesUrl(QStringLiteral("currencies?search=%1&type=coin"))
 				   .arg(searchText));
 
-	QNetworkAccessManager *networkManager = new QNetworkAccessManager();
-
-	QNetworkRequest request;
-	request.setUrl(url);
-
-	QNetworkReply *reply = networkManager->get(request);
-
-	connect(reply, &QNetworkReply::finished, this, [this, url, searchText, reply] {
-		if (isApiDeprecated(reply)) {
+	NetworkFetcher::instance()->get(url,
+									NetworkFetcher::Source::Prices,
+									NetworkFetcher::CachePolicy::NoCache,
+									this,
+									[this, searchText](const NetworkFetcher::Result &result) {
+		if (isApiDeprecated(result)) {
 			return;
 		}
 
-		if(reply->error() == QNetworkReply::NoError) {
+		if(result.error == QNetworkReply::NoError) {
 			// We parse the response only if the search text is the same
 			if (_cryptoPriceList->searchText() == searchText) {
-				_cryptoPriceList->parseSearchNames(reply->readAll());
+				ServiceBenchmark::Parse parse("prices/search", result.data.size());
+
+				_cryptoPriceList->parseSearchNames(result.data);
 			}
+		} else if (result.isTimedOut()) {
+			LOG(("Can not search crypto price values due timeout. Search text: '%1'").arg(searchText));
 		} else {
 			LOG(("Can not search crypto price values. Search text: '%1'. %2 (%3)")
 				.arg(searchText)
-				.arg(reply->errorString())
-				.arg(reply->error()));
+				.arg(result.errorString)
+				.arg(result.error));
 		}
 	});
-
-	connect(reply, &QNetworkReply::finished, [networkManager, reply, searchText]() {
-		reply->deleteLater();
-		networkManager->deleteLater();
-	});
-
-	QTimer::singleShot(_networkTimeout, Qt::VeryCoarseTimer, networkManager,
-					   [networkManager, reply, searchText] {
-		reply->deleteLater();
-		networkManager->deleteLater();
-
-		LOG(("Can not search crypto price values due timeout. Search text: '%1'").arg(searchText));
-	});
-
-	connect(reply, &QNetworkReply::sslErrors, this, &BettergramService::onSslFailed);
 }
 
 void BettergramService::getCryptoPriceValues(const QUrl &url)
@@ -617,86 +572,57 @@ void BettergramService::getCryptoPriceValues(const QUrl &url)
 		return;
 	}
 
-	QNetworkAccessManager *networkManager = new QNetworkAccessManager();
-
-	QNetworkRequest request;
-	request.setUrl(url);
-
-	QNetworkReply *reply = networkManager->get(request);
-
-	connect(reply, &QNetworkReply::finished, this, [this, url, reply] {
-		if (isApiDeprecated(reply)) {
+	NetworkFetcher::instance()->get(url,
+									NetworkFetcher::Source::Prices,
+									NetworkFetcher::CachePolicy::NoCache,
+									this,
+									[this, url](const NetworkFetcher::Result &result) {
+		if (isApiDeprecated(result)) {
 			return;
 		}
 
-		if(reply->error() == QNetworkReply::NoError) {
-			_cryptoPriceList->parseValues(reply->readAll(), url);
+		if(result.error == QNetworkReply::NoError) {
+			{
+				ServiceBenchmark::Parse parse("prices/values", result.data.size());
+				_cryptoPriceList->parseValues(result.data, url);
+			}
 
 			if (_cryptoPriceList->mayFetchStats()) {
 				getCryptoPriceStats();
 			}
+		} else if (result.isTimedOut()) {
+			LOG(("Can not get crypto price values due timeout"));
 		} else {
 			LOG(("Can not get crypto price values. %1 (%2)")
-				.arg(reply->errorString())
-				.arg(reply->error()));
+				.arg(result.errorString)
+				.arg(result.error));
 		}
 	});
-
-	connect(reply, &QNetworkReply::finished, [networkManager, reply]() {
-		reply->deleteLater();
-		networkManager->deleteLater();
-	});
-
-	QTimer::singleShot(_networkTimeout, Qt::VeryCoarseTimer, networkManager,
-					   [networkManager, reply] {
-		reply->deleteLater();
-		networkManager->deleteLater();
-
-		LOG(("Can not get crypto price values due timeout"));
-	});
-
-	connect(reply, &QNetworkReply::sslErrors,
-			this, &BettergramService::onSslFailed);
 }
 
 void BettergramService::getCryptoPriceStats()
 {
-	QNetworkAccessManager *networkManager = new QNetworkAccessManager();
-
-	QNetworkRequest request;
-	request.setUrl(QStringLiteral("https://%1.livecoinwatch.com/stats").arg(_pricesUrlPrefix));
-
-	QNetworkReply *reply = networkManager->get(request);
-
-	connect(reply, &QNetworkReply::finished, this, [this, reply] {
-		if (isApiDeprecated(reply)) {
+	NetworkFetcher::instance()->get(pricesUrl(QStringLiteral("stats")),
+									NetworkFetcher::Source::Prices,
+									NetworkFetcher::CachePolicy::NoCache,
+									this,
+									[this](const NetworkFetcher::Result &result) {
+		if (isApiDeprecated(result)) {
 			return;
 		}
 
-		if(reply->error() == QNetworkReply::NoError) {
-			_cryptoPriceList->parseStats(reply->readAll());
+		if(result.error == QNetworkReply::NoError) {
+			ServiceBenchmark::Parse parse("prices/stats", result.data.size());
+
+			_cryptoPriceList->parseStats(result.data);
+		} else if (result.isTimedOut()) {
+			LOG(("Can not get crypto price stats due timeout"));
 		} else {
 			LOG(("Can not get crypto price stats. %1 (%2)")
-				.arg(reply->errorString())
-				.arg(reply->error()));
+				.arg(result.errorString)
+				.arg(result.error));
 		}
 	});
-
-	connect(reply, &QNetworkReply::finished, [networkManager, reply]() {
-		reply->deleteLater();
-		networkManager->deleteLater();
-	});
-
-	QTimer::singleShot(_networkTimeout, Qt::VeryCoarseTimer, networkManager,
-					   [networkManager, reply] {
-		reply->deleteLater();
-		networkManager->deleteLater();
-
-		LOG(("Can not get crypto price stats due timeout"));
-	});
-
-	connect(reply, &QNetworkReply::sslErrors,
-			this, &BettergramService::onSslFailed);
 }
 
 void BettergramService::getRssFeedsContent()
@@ -722,265 +648,178 @@ void BettergramService::getRssFeeds(RssChannelList *rssChannelList,
 {
 	channel->startFetching();
 
-	QNetworkAccessManager *networkManager = new QNetworkAccessManager();
-
-	QNetworkRequest request;
-	request.setUrl(channel->feedLink());
-
-	QNetworkReply *reply = networkManager->get(request);
-
-	connect(reply, &QNetworkReply::finished, this, [rssChannelList, reply, channel] {
-		if(reply->error() == QNetworkReply::NoError) {
-			channel->fetchingSucceed(reply->readAll());
+	const NetworkFetcher::Source source = (rssChannelList == _videoChannelList)
+			? NetworkFetcher::Source::Videos
+			: NetworkFetcher::Source::News;
+
+	NetworkFetcher::instance()->get(channel->feedLink(),
+									source,
+									NetworkFetcher::CachePolicy::NoCache,
+									this,
+									[rssChannelList, channel](const NetworkFetcher::Result &result) {
+		if(result.error == QNetworkReply::NoError) {
+			channel->fetchingSucceed(result.data);
 		} else {
-			LOG(("Can not get RSS feeds from the channel %1. %2 (%3)")
-				.arg(channel->feedLink().toString())
-				.arg(reply->errorString())
-				.arg(reply->error()));
+			if (result.isTimedOut()) {
+				LOG(("Can not get RSS feeds from the channel %1 due timeout")
+					.arg(channel->feedLink().toString()));
+			} else {
+				LOG(("Can not get RSS feeds from the channel %1. %2 (%3)")
+					.arg(channel->feedLink().toString())
+					.arg(result.errorString)
+					.arg(result.error));
+			}
 
 			channel->fetchingFailed();
 		}
 
+		ServiceBenchmark::Parse parse("rss/feed", result.data.size());
 		rssChannelList->parseFeeds();
 	});
-
-	connect(reply, &QNetworkReply::finished, [networkManager, reply]() {
-		reply->deleteLater();
-		networkManager->deleteLater();
-	});
-
-	QTimer::singleShot(_networkTimeout, Qt::VeryCoarseTimer, networkManager,
-					   [networkManager, reply, channel] {
-		reply->deleteLater();
-		networkManager->deleteLater();
-
-		LOG(("Can not get RSS feeds from the channel %1 due timeout")
-			.arg(channel->feedLink().toString()));
-
-		channel->fetchingFailed();
-	});
-
-	connect(reply, &QNetworkReply::sslErrors, this, [channel] (QList<QSslError> errors) {
-		LOG(("Got SSL errors in during getting RSS feeds from the channel: %1")
-			.arg(channel->feedLink().toString()));
-
-		for(const QSslError &error : errors) {
-			LOG(("%1").arg(error.errorString()));
-		}
-	});
 }
 
 void BettergramService::getRssChannelList()
 {
-	QUrl url("https://api.bettergram.io/v1/news");
-
-	QNetworkAccessManager *networkManager = new QNetworkAccessManager();
-
-	QNetworkRequest request;
-	request.setUrl(url);
-
-	QNetworkReply *reply = networkManager->get(request);
-
-	connect(reply, &QNetworkReply::finished,
-			this, &BettergramService::onGetRssChannelListFinished);
-
-	connect(reply, &QNetworkReply::finished, [networkManager, reply]() {
-		reply->deleteLater();
-		networkManager->deleteLater();
+	NetworkFetcher::instance()->get(apiUrl(QStringLiteral("news")),
+									NetworkFetcher::Source::News,
+									NetworkFetcher::CachePolicy::NoCache,
+									this,
+									[this](const NetworkFetcher::Result &result) {
+		onGetRssChannelListFinished(result);
 	});
-
-	QTimer::singleShot(_networkTimeout, Qt::VeryCoarseTimer, networkManager,
-					   [networkManager, reply] {
-		reply->deleteLater();
-		networkManager->deleteLater();
-
-		LOG(("Can not get RSS channel list due timeout"));
-	});
-
-	connect(reply, &QNetworkReply::sslErrors, this, &BettergramService::onSslFailed);
 }
 
 void BettergramService::getVideoChannelList()
 {
-	QUrl url("https://api.bettergram.io/v1/videos");
-
-	QNetworkAccessManager *networkManager = new QNetworkAccessManager();
-
-	QNetworkRequest request;
-	request.setUrl(url);
-
-	QNetworkReply *reply = networkManager->get(request);
-
-	connect(reply, &QNetworkReply::finished,
-			this, &BettergramService::onGetVideoChannelListFinished);
-
-	connect(reply, &QNetworkReply::finished, [networkManager, reply]() {
-		reply->deleteLater();
-		networkManager->deleteLater();
+	NetworkFetcher::instance()->get(apiUrl(QStringLiteral("videos")),
+									NetworkFetcher::Source::Videos,
+									NetworkFetcher::CachePolicy::NoCache,
+									this,
+									[this](const NetworkFetcher::Result &result) {
+		onGetVideoChannelListFinished(result);
 	});
-
-	QTimer::singleShot(_networkTimeout, Qt::VeryCoarseTimer, networkManager,
-					   [networkManager, reply] {
-		reply->deleteLater();
-		networkManager->deleteLater();
-
-		LOG(("Can not get video channel list due timeout"));
-	});
-
-	connect(reply, &QNetworkReply::sslErrors, this, &BettergramService::onSslFailed);
 }
 
 void BettergramService::getResourceGroupList()
 {
-	QUrl url("https://api.bettergram.io/v1/resources");
-
-	QNetworkAccessManager *networkManager = new QNetworkAccessManager();
-
-	QNetworkRequest request;
-	request.setUrl(url);
-
-	QNetworkReply *reply = networkManager->get(request);
-
-	connect(reply, &QNetworkReply::finished,
-			this, &BettergramService::onGetResourceGroupListFinished);
-
-	connect(reply, &QNetworkReply::finished, [networkManager, reply]() {
-		reply->deleteLater();
-		networkManager->deleteLater();
+	NetworkFetcher::instance()->get(apiUrl(QStringLiteral("resources")),
+									NetworkFetcher::Source::Resources,
+									NetworkFetcher::CachePolicy::NoCache,
+									this,
+									[this](const NetworkFetcher::Result &result) {
+		onGetResourceGroupListFinished(result);
 	});
-
-	QTimer::singleShot(_networkTimeout, Qt::VeryCoarseTimer, networkManager,
-					   [networkManager, reply] {
-		reply->deleteLater();
-		networkManager->deleteLater();
-
-		LOG(("Can not get resource group list due timeout"));
-	});
-
-	connect(reply, &QNetworkReply::sslErrors, this, &BettergramService::onSslFailed);
 }
 
 void BettergramService::getPinnedNewsList()
 {
-	QUrl url("https://api.bettergram.io/v1/pinned_news");
-
-	QNetworkAccessManager *networkManager = new QNetworkAccessManager();
-
-	QNetworkRequest request;
-	request.setUrl(url);
-
-	QNetworkReply *reply = networkManager->get(request);
-
-	connect(reply, &QNetworkReply::finished,
-			this, &BettergramService::onGetPinnedNewsListFinished);
-
-	connect(reply, &QNetworkReply::finished, [networkManager, reply]() {
-		reply->deleteLater();
-		networkManager->deleteLater();
+	NetworkFetcher::instance()->get(apiUrl(QStringLiteral("pinned_news")),
+									NetworkFetcher::Source::News,
+									NetworkFetcher::CachePolicy::NoCache,
+									this,
+									[this](const NetworkFetcher::Result &result) {
+		onGetPinnedNewsListFinished(result);
 	});
-
-	QTimer::singleShot(_networkTimeout, Qt::VeryCoarseTimer, networkManager,
-					   [networkManager, reply] {
-		reply->deleteLater();
-		networkManager->deleteLater();
-
-		LOG(("Can not get pinned news list due timeout"));
-	});
-
-	connect(reply, &QNetworkReply::sslErrors, this, &BettergramService::onSslFailed);
 }
 
-void BettergramService::onGetCryptoPriceNamesFinished()
+void BettergramService::onGetCryptoPriceNamesFinished(const NetworkFetcher::Result &result)
 {
-	QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-
-	if (isApiDeprecated(reply)) {
+	if (isApiDeprecated(result)) {
 		return;
 	}
 
-	if(reply->error() == QNetworkReply::NoError) {
-		_cryptoPriceList->parseNames(reply->readAll());
+	if(result.error == QNetworkReply::NoError) {
+		ServiceBenchmark::Parse parse("prices/names", result.data.size());
+
+		_cryptoPriceList->parseNames(result.data);
+	} else if (result.isTimedOut()) {
+		LOG(("Can not get crypto price names due timeout"));
 	} else {
 		LOG(("Can not get crypto price names. %1 (%2)")
-			.arg(reply->errorString())
-			.arg(reply->error()));
+			.arg(result.errorString)
+			.arg(result.error));
 	}
 }
 
-void BettergramService::onSslFailed(QList<QSslError> errors)
+void BettergramService::onGetResourceGroupListFinished(const NetworkFetcher::Result &result)
 {
-	for(const QSslError &error : errors) {
-		LOG(("%1").arg(error.errorString()));
-	}
-}
-
-void BettergramService::onGetResourceGroupListFinished()
-{
-	QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-
-	if (isApiDeprecated(reply)) {
+	if (isApiDeprecated(result)) {
 		return;
 	}
 
-	if(reply->error() == QNetworkReply::NoError) {
-		_resourceGroupList->parse(reply->readAll());
+	if(result.error == QNetworkReply::NoError) {
+		ServiceBenchmark::Parse parse("resources", result.data.size());
+
+		_resourceGroupList->parse(result.data);
+	} else if (result.isTimedOut()) {
+		LOG(("Can not get resource group list due timeout"));
 	} else {
 		LOG(("Can not get resource group list. %1 (%2)")
-			.arg(reply->errorString())
-			.arg(reply->error()));
+			.arg(result.errorString)
+			.arg(result.error));
 	}
 }
 
-void BettergramService::onGetPinnedNewsListFinished()
+void BettergramService::onGetPinnedNewsListFinished(const NetworkFetcher::Result &result)
 {
-	QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-
-	if (isApiDeprecated(reply)) {
+	if (isApiDeprecated(result)) {
 		return;
 	}
 
-	if(reply->error() == QNetworkReply::NoError) {
-		_pinnedNewsList->parse(reply->readAll());
+	if(result.error == QNetworkReply::NoError) {
+		ServiceBenchmark::Parse parse("pinned_news", result.data.size());
+
+		_pinnedNewsList->parse(result.data);
+	} else if (result.isTimedOut()) {
+		LOG(("Can not get pinned news list due timeout"));
 	} else {
 		LOG(("Can not get pinned news list. %1 (%2)")
-			.arg(reply->errorString())
-			.arg(reply->error()));
+			.arg(result.errorString)
+			.arg(result.error));
 	}
 }
 
-void BettergramService::onGetRssChannelListFinished()
+void BettergramService::onGetRssChannelListFinished(const NetworkFetcher::Result &result)
 {
-	QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-
-	if (isApiDeprecated(reply)) {
+	if (isApiDeprecated(result)) {
 		return;
 	}
 
-	if(reply->error() == QNetworkReply::NoError) {
-		_rssChannelList->parseChannelList(reply->readAll());
+	if(result.error == QNetworkReply::NoError) {
+		{
+			ServiceBenchmark::Parse parse("rss/channels", result.data.size());
+			_rssChannelList->parseChannelList(result.data);
+		}
+
 		getRssFeedsContent();
+	} else if (result.isTimedOut()) {
+		LOG(("Can not get rss channel list due timeout"));
 	} else {
 		LOG(("Can not get rss channel list. %1 (%2)")
-			.arg(reply->errorString())
-			.arg(reply->error()));
+			.arg(result.errorString)
+			.arg(result.error));
 	}
 }
 
-void BettergramService::onGetVideoChannelListFinished()
+void BettergramService::onGetVideoChannelListFinished(const NetworkFetcher::Result &result)
 {
-	QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-
-	if (isApiDeprecated(reply)) {
+	if (isApiDeprecated(result)) {
 		return;
 	}
 
-	if(reply->error() == QNetworkReply::NoError) {
-		_videoChannelList->parseChannelList(reply->readAll());
+	if(result.error == QNetworkReply::NoError) {
+		{
+			ServiceBenchmark::Parse parse("videos/channels", result.data.size());
+			_videoChannelList->parseChannelList(result.data);
+		}
+
 		getVideoFeedsContent();
+	} else if (result.isTimedOut()) {
+		LOG(("Can not get video channel list due timeout"));
 	} else {
 		LOG(("Can not get video channel list. %1 (%2)")
-			.arg(reply->errorString())
-			.arg(reply->error()));
+			.arg(result.errorString)
+			.arg(result.error));
 	}
 }
 
@@ -991,43 +830,20 @@ void BettergramService::getNextAd(bool reset)
 		return;
 	}
 
-	QString url = "https://api.bettergram.io/v1/ads/next";
+	QString url = apiUrl(QStringLiteral("ads/next"));
 
 	if (!reset && !_currentAd->isEmpty()) {
 		url += "?last=";
 		url += _currentAd->id();
 	}
 
-	QNetworkAccessManager *networkManager = new QNetworkAccessManager();
-
-	QNetworkRequest request;
-	request.setUrl(url);
-
-	QNetworkReply *reply = networkManager->get(request);
-
-	connect(reply, &QNetworkReply::finished,
-			this, &BettergramService::onGetNextAdFinished);
-
-	connect(reply, &QNetworkReply::finished, [networkManager, reply]() {
-		reply->deleteLater();
-		networkManager->deleteLater();
-	});
-
-	connect(this, &BettergramService::destroyed, networkManager, [networkManager, reply] {
-		reply->deleteLater();
-		networkManager->deleteLater();
+	NetworkFetcher::instance()->get(url,
+									NetworkFetcher::Source::Other,
+									NetworkFetcher::CachePolicy::NoCache,
+									this,
+									[this](const NetworkFetcher::Result &result) {
+		onGetNextAdFinished(result);
 	});
-
-	QTimer::singleShot(_networkTimeout, Qt::VeryCoarseTimer, networkManager,
-					   [networkManager, reply, this] {
-		reply->deleteLater();
-		networkManager->deleteLater();
-
-		getNextAdLater();
-	});
-
-	connect(reply, &QNetworkReply::sslErrors,
-			this, &BettergramService::onSslFailed);
 }
 
 void BettergramService::getNextAdLater(bool reset)
@@ -1120,16 +936,14 @@ bool BettergramService::parseNextAd(const QByteArray &byteArray)
 	return true;
 }
 
-void BettergramService::onGetNextAdFinished()
+void BettergramService::onGetNextAdFinished(const NetworkFetcher::Result &result)
 {
-	QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-
-	if (isApiDeprecated(reply)) {
+	if (isApiDeprecated(result)) {
 		return;
 	}
 
-	if(reply->error() == QNetworkReply::NoError) {
-		if (parseNextAd(reply->readAll())) {
+	if(result.error == QNetworkReply::NoError) {
+		if (parseNextAd(result.data)) {
 			getNextAdLater();
 		} else {
 			// Try to get new ad without previous ad id
@@ -1137,8 +951,8 @@ void BettergramService::onGetNextAdFinished()
 		}
 	} else {
 		//	LOG(("Can not get next ad item. %1 (%2)")
-		//				  .arg(reply->errorString())
-		//				  .arg(reply->error()));
+		//				  .arg(result.errorString)
+		//				  .arg(result.error));
 
 		getNextAdLater();
 	}
@@ -1170,36 +984,25 @@ void BettergramService::checkForNewUpdates()
 	checker.start();
 }
 
-bool BettergramService::isApiDeprecated(const QNetworkReply *reply)
+bool BettergramService::isApiDeprecated(const NetworkFetcher::Result &result)
 {
-	if (!reply) {
-		LOG(("Unable to check for deprecated API because reply is null"));
-
-		// The reply does not contain 410 (Gone) HTTP status,
-		// but we can not continue without valid reply object
-		return true;
+	if (result.isFromCache) {
+		return false;
 	}
 
-	QVariant statusCodeVariant = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
-
-	if (!statusCodeVariant.isValid()) {
-		if (reply->error() == QNetworkReply::ContentGoneError) {
+	if (!result.statusCode) {
+		if (result.error == QNetworkReply::ContentGoneError) {
 			showDeprecatedApiMessage();
 			return true;
 		}
 
-		LOG(("Unable to get HTTP status code. Url: %1").arg(reply->url().toString()));
-		return false;
-	}
-
-	bool okInt = false;
-	int statusCode = statusCodeVariant.toInt(&okInt);
-
-	if (!okInt) {
+		if (!result.isTimedOut()) {
+			LOG(("Unable to get HTTP status code. Url: %1").arg(result.url.toString()));
+		}
 		return false;
 	}
 
-	if (statusCode == 410) {
+	if (result.statusCode == 410) {
 		showDeprecatedApiMessage();
 		return true;
 	} else {
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "networkfetcher.h"
+
 #include <base/observer.h>
 
 #include <QObject>
@@ -161,6 +163,15 @@ private:
 	bool _isDeprecatedApiMessageShown = false;
 
 	static void checkForNewUpdates();
+
+	/// Returns url of the Bettergram API method.
+	/// The BETTERGRAM_API_URL environment variable overrides the server, for example for benchmarks
+	static QString apiUrl(const QString &path);
+
+	/// Returns url of the crypto prices API method.
+	/// The BETTERGRAM_PRICES_URL environment variable overrides the server, for example for benchmarks
+	static QString pricesUrl(const QString &path);
+
 	static void sendStatUrl(UrlSource urlSource, const QUrl &targetUrl);
 	static QString convertUrlSourceToString(UrlSource urlSource);
 
@@ -207,8 +218,16 @@ private:
 
 	/// Check response for 410 (Gone) HTTP status.
 	/// If the reply has this status we show message box that the user should update the application.
-	/// @return true if the reply has 410 (Gone) HTTP status or when reply is null, false otherwise
-	bool isApiDeprecated(const QNetworkReply *reply);
+	/// @return true if the reply has 410 (Gone) HTTP status, false otherwise
+	bool isApiDeprecated(const NetworkFetcher::Result &result);
+
+	void onGetCryptoPriceNamesFinished(const NetworkFetcher::Result &result);
+	void onGetNextAdFinished(const NetworkFetcher::Result &result);
+	void onGetResourceGroupListFinished(const NetworkFetcher::Result &result);
+	void onGetPinnedNewsListFinished(const NetworkFetcher::Result &result);
+	void onGetRssChannelListFinished(const NetworkFetcher::Result &result);
+	void onGetVideoChannelListFinished(const NetworkFetcher::Result &result);
+
 	void showDeprecatedApiMessage();
 
 private slots:
@@ -217,15 +236,6 @@ private slots:
 
 	void onUpdateRssFeedsContent();
 	void onUpdateVideoFeedsContent();
-
-	void onGetCryptoPriceNamesFinished();
-	void onGetNextAdFinished();
-	void onGetResourceGroupListFinished();
-	void onGetPinnedNewsListFinished();
-	void onGetRssChannelListFinished();
-	void onGetVideoChannelListFinished();
-
-	void onSslFailed(QList<QSslError> errors);
 };
 
 } // namespace Bettergram
@@ -0,0 +1,309 @@
+#include "networkfetcher.h"
+#include "bettergramservice.h"
+#include "servicebenchmark.h"
+
+#include <auth_session.h>
+#include <logs.h>
+#include <data/data_session.h>
+#include <data/data_types.h>
+#include <storage/cache/storage_cache_database.h>
+
+#include <QCoreApplication>
+#include <QTimer>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkRequest>
+
+namespace Bettergram {
+
+const int NetworkFetcher::_maxRunningCount = 8;
+
+bool NetworkFetcher::Result::isTimedOut() const
+{
+	return error == QNetworkReply::OperationCanceledError;
+}
+
+NetworkFetcher *NetworkFetcher::instance()
+{
+	static NetworkFetcher *result = new NetworkFetcher(QCoreApplication::instance());
+	return result;
+}
+
+NetworkFetcher::NetworkFetcher(QObject *parent) :
+	QObject(parent),
+	_networkManager(new QNetworkAccessManager(this))
+{
+}
+
+const char *NetworkFetcher::sourceName(Source source)
+{
+	switch (source) {
+	case Source::Prices:
+		return "fetch/prices";
+	case Source::News:
+		return "fetch/news";
+	case Source::Videos:
+		return "fetch/videos";
+	case Source::Resources:
+		return "fetch/resources";
+	case Source::Other:
+		return "fetch/other";
+	}
+	return "fetch/other";
+}
+
+QNetworkRequest NetworkFetcher::createNetworkRequest(const QUrl &url)
+{
+	QNetworkRequest request(url);
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+	request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+#endif // Qt >= 5.8.0
+
+	return request;
+}
+
+NetworkFetcher::Source NetworkFetcher::visibleSource() const
+{
+	return _visibleSource;
+}
+
+void NetworkFetcher::setVisibleSource(Source visibleSource)
+{
+	_visibleSource = visibleSource;
+}
+
+void NetworkFetcher::get(const QUrl &url,
+						 Source source,
+						 CachePolicy cachePolicy,
+						 QObject *context,
+						 Callback callback)
+{
+	const QString key = url.toString();
+	const auto i = _requests.find(key);
+
+	if (i != _requests.end()) {
+		Request &request = i->second;
+
+		request.waiters.push_back({ context, std::move(callback) });
+
+		if (source != Source::Other && source == _visibleSource) {
+			request.source = source;
+		}
+
+		if (cachePolicy > request.cachePolicy) {
+			request.cachePolicy = cachePolicy;
+		}
+
+		return;
+	}
+
+	Request request;
+	request.url = url;
+	request.source = source;
+	request.cachePolicy = cachePolicy;
+	request.waiters.push_back({ context, std::move(callback) });
+
+	_requests.emplace(key, std::move(request));
+
+	if (cachePolicy == CachePolicy::PreferCache) {
+		lookupCache(key);
+	} else {
+		enqueue(key);
+	}
+}
+
+void NetworkFetcher::send(const QUrl &url)
+{
+	QNetworkReply *reply = _networkManager->get(createNetworkRequest(url));
+	ServiceBenchmark::watch("fetch/send", reply);
+
+	connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+
+	QTimer::singleShot(BettergramService::networkTimeout() * 2, Qt::VeryCoarseTimer, reply, [reply] {
+		LOG(("Can not send request to %1 due timeout").arg(reply->url().toString()));
+		reply->abort();
+	});
+}
+
+void NetworkFetcher::lookupCache(const QString &key)
+{
+	if (!AuthSession::Exists()) {
+		enqueue(key);
+		return;
+	}
+
+	_requests[key].state = State::CacheLookup;
+
+	Auth().data().cache().get(Data::UrlCacheKey(key), [=](QByteArray &&data) {
+		crl::on_main(this, [=, data = std::move(data)]() mutable {
+			cacheLookupFinished(key, std::move(data));
+		});
+	});
+}
+
+void NetworkFetcher::cacheLookupFinished(const QString &key, QByteArray &&data)
+{
+	const auto i = _requests.find(key);
+
+	if (i == _requests.end() || i->second.state != State::CacheLookup) {
+		return;
+	}
+
+	// Some waiters may have asked to refresh the data while we were looking it up
+	if (data.isEmpty() || i->second.cachePolicy == CachePolicy::RefreshCache) {
+		enqueue(key);
+		return;
+	}
+
+	Result result;
+	result.url = i->second.url;
+	result.data = std::move(data);
+	result.isFromCache = true;
+
+	finish(key, result);
+}
+
+void NetworkFetcher::storeToCache(const QString &key, const QByteArray &data)
+{
+	if (!AuthSession::Exists() || data.isEmpty()) {
+		return;
+	}
+
+	Auth().data().cache().put(
+				Data::UrlCacheKey(key),
+				Storage::Cache::Database::TaggedValue(QByteArray(data), Data::kImageCacheTag));
+}
+
+void NetworkFetcher::enqueue(const QString &key)
+{
+	_requests[key].state = State::Pending;
+	_queue.push_back(key);
+
+	startNext();
+}
+
+std::deque<QString>::iterator NetworkFetcher::nextInQueue()
+{
+	// Requests of the visible tab go first, then data requests of hidden tabs,
+	// and only then all other requests, mostly images
+	if (_visibleSource != Source::Other) {
+		for (auto i = _queue.begin(); i != _queue.end(); ++i) {
+			const auto request = _requests.find(*i);
+
+			if (request != _requests.end() && request->second.source == _visibleSource) {
+				return i;
+			}
+		}
+	}
+
+	for (auto i = _queue.begin(); i != _queue.end(); ++i) {
+		const auto request = _requests.find(*i);
+
+		if (request != _requests.end() && request->second.source != Source::Other) {
+			return i;
+		}
+	}
+
+	return _queue.begin();
+}
+
+bool NetworkFetcher::hasAliveWaiters(const Request &request) const
+{
+	for (const Waiter &waiter : request.waiters) {
+		if (waiter.context) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void NetworkFetcher::startNext()
+{
+	while (_runningCount < _maxRunningCount && !_queue.empty()) {
+		const auto next = nextInQueue();
+		const QString key = *next;
+
+		_queue.erase(next);
+
+		const auto i = _requests.find(key);
+
+		if (i == _requests.end() || i->second.state != State::Pending) {
+			continue;
+		}
+
+		// Nobody needs the data anymore, for example the tab with the images is closed
+		if (!hasAliveWaiters(i->second)) {
+			_requests.erase(i);
+			continue;
+		}
+
+		start(key, i->second);
+	}
+}
+
+void NetworkFetcher::start(const QString &key, Request &request)
+{
+	request.state = State::Running;
+	_runningCount++;
+
+	QNetworkReply *reply = _networkManager->get(createNetworkRequest(request.url));
+	ServiceBenchmark::watch(sourceName(request.source), reply);
+
+	connect(reply, &QNetworkReply::finished, this, [this, key, reply] {
+		Result result;
+		result.url = reply->url();
+		result.error = reply->error();
+		result.errorString = reply->errorString();
+		result.statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+		if (result.error == QNetworkReply::NoError) {
+			result.data = reply->readAll();
+		}
+
+		reply->deleteLater();
+		_runningCount--;
+
+		finish(key, result);
+		startNext();
+	});
+
+	QTimer::singleShot(BettergramService::networkTimeout(), Qt::VeryCoarseTimer, reply, [reply] {
+		reply->abort();
+	});
+
+	connect(reply, &QNetworkReply::sslErrors, this, [](QList<QSslError> errors) {
+		for(const QSslError &error : errors) {
+			LOG(("%1").arg(error.errorString()));
+		}
+	});
+}
+
+void NetworkFetcher::finish(const QString &key, const Result &result)
+{
+	const auto i = _requests.find(key);
+
+	if (i == _requests.end()) {
+		return;
+	}
+
+	// Callbacks may request the same url again, so we remove the request before calling them
+	const std::vector<Waiter> waiters = std::move(i->second.waiters);
+	const CachePolicy cachePolicy = i->second.cachePolicy;
+
+	_requests.erase(i);
+
+	if (cachePolicy != CachePolicy::NoCache
+			&& !result.isFromCache
+			&& result.error == QNetworkReply::NoError) {
+		storeToCache(key, result.data);
+	}
+
+	for (const Waiter &waiter : waiters) {
+		if (waiter.context && waiter.callback) {
+			waiter.callback(result);
+		}
+	}
+}
+
+} // namespace Bettergram
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QUrl>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <vector>
+
+class QNetworkAccessManager;
+
+namespace Bettergram {
+
+/**
+ * @brief The NetworkFetcher class performs HTTP GET requests of all Bettergram classes.
+ * It uses one network access manager, so connections to the same hosts are kept alive and reused.
+ * Requests to the same url are joined while they are in flight,
+ * requests of the visible Bettergram tab are started first
+ * and cacheable replies (images) are stored in the local cache database.
+ */
+class NetworkFetcher : public QObject {
+	Q_OBJECT
+
+public:
+	enum class Source {
+		Other,
+		Prices,
+		News,
+		Videos,
+		Resources
+	};
+
+	/// The order is important: joined requests use the greatest policy
+	enum class CachePolicy {
+		/// Always download the data and do not store it
+		NoCache,
+
+		/// Use the stored data if it exists, otherwise download and store it
+		PreferCache,
+
+		/// Download the data and replace the stored one
+		RefreshCache
+	};
+
+	struct Result {
+		QUrl url;
+		QByteArray data;
+		QNetworkReply::NetworkError error = QNetworkReply::NoError;
+		QString errorString;
+
+		/// HTTP status code or 0 if the reply does not contain it
+		int statusCode = 0;
+
+		/// We abort requests only by timeout
+		bool isTimedOut() const;
+
+		bool isFromCache = false;
+	};
+
+	using Callback = std::function<void(const Result &result)>;
+
+	static NetworkFetcher *instance();
+
+	/// The callback is not called if the context object is destroyed before the request is finished
+	void get(const QUrl &url,
+			 Source source,
+			 CachePolicy cachePolicy,
+			 QObject *context,
+			 Callback callback);
+
+	/// Send the request and ignore the reply.
+	/// These requests are never joined, because each of them is counted by the server.
+	void send(const QUrl &url);
+
+	Source visibleSource() const;
+	void setVisibleSource(Source visibleSource);
+
+private:
+	enum class State {
+		CacheLookup,
+		Pending,
+		Running
+	};
+
+	struct Waiter {
+		QPointer<QObject> context;
+		Callback callback;
+	};
+
+	struct Request {
+		QUrl url;
+		Source source = Source::Other;
+		CachePolicy cachePolicy = CachePolicy::NoCache;
+		State state = State::Pending;
+		std::vector<Waiter> waiters;
+	};
+
+	/// Qt opens no more than 6 connections per host,
+	/// so we keep the rest of requests in our queue where we can prioritize them
+	static const int _maxRunningCount;
+
+	QNetworkAccessManager *_networkManager = nullptr;
+	std::map<QString, Request> _requests;
+	std::deque<QString> _queue;
+	int _runningCount = 0;
+	Source _visibleSource = Source::Other;
+
+	static const char *sourceName(Source source);
+	static QNetworkRequest createNetworkRequest(const QUrl &url);
+
+	explicit NetworkFetcher(QObject *parent);
+
+	void lookupCache(const QString &key);
+	void cacheLookupFinished(const QString &key, QByteArray &&data);
+	void storeToCache(const QString &key, const QByteArray &data);
+
+	void enqueue(const QString &key);
+	void startNext();
+	void start(const QString &key, Request &request);
+	void finish(const QString &key, const Result &result);
+
+	std::deque<QString>::iterator nextInQueue();
+	bool hasAliveWaiters(const Request &request) const;
+};
+
+} // namespace Bettergram
@@ -155,4 +155,9 @@ bool RemoteImage::checkLink(const QUrl &link)
 	return link.toString().size() < 300;
 }
 
+bool RemoteImage::isCacheable() const
+{
+	return true;
+}
+
 } // namespace Bettergrams
@@ -47,6 +47,7 @@ protected:
 	void resetData() override;
 
 	bool checkLink(const QUrl &link) override;
+	bool isCacheable() const override;
 
 private:
 	/// If _scaledWidth or _scaledHeight is not 0 then we scale fetched image
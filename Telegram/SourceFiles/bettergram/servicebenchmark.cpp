@@ -0,0 +1,200 @@
+#include "servicebenchmark.h"
+
+#include <logs.h>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QSharedPointer>
+#include <QTimerEvent>
+#include <QtNetwork/QNetworkReply>
+
+namespace Bettergram {
+
+const int ServiceBenchmark::_stallCheckPeriod = 10;
+const int ServiceBenchmark::_reportPeriod = 10 * 1000;
+
+ServiceBenchmark::Parse::Parse(const char *name, int bytes) :
+	_name(name),
+	_bytes(bytes)
+{
+	if (isEnabled()) {
+		_timer.start();
+	}
+}
+
+ServiceBenchmark::Parse::~Parse()
+{
+	if (_timer.isValid()) {
+		instance()->parsed(_name, _bytes, _timer.nsecsElapsed() / 1000);
+	}
+}
+
+bool ServiceBenchmark::isEnabled()
+{
+	static const bool result = qEnvironmentVariableIsSet("BETTERGRAM_BENCHMARK");
+	return result;
+}
+
+ServiceBenchmark *ServiceBenchmark::instance()
+{
+	static ServiceBenchmark *result = new ServiceBenchmark(QCoreApplication::instance());
+	return result;
+}
+
+qint64 ServiceBenchmark::currentMemory()
+{
+#ifdef Q_OS_LINUX
+	// The second value in statm is the resident set size in pages
+	QFile statm(QStringLiteral("/proc/self/statm"));
+
+	if (statm.open(QIODevice::ReadOnly)) {
+		const QList<QByteArray> values = statm.readAll().split(' ');
+
+		if (values.size() > 1) {
+			return values.at(1).toLongLong() * 4096;
+		}
+	}
+#endif // Q_OS_LINUX
+	return 0;
+}
+
+ServiceBenchmark::ServiceBenchmark(QObject *parent) :
+	QObject(parent),
+	_startMemory(currentMemory())
+{
+	_stallTimer.start();
+	_stallTimerId = startTimer(_stallCheckPeriod, Qt::PreciseTimer);
+	_reportTimerId = startTimer(_reportPeriod, Qt::VeryCoarseTimer);
+
+	LOG(("Bettergram Benchmark: started, memory %1 KB").arg(_startMemory / 1024));
+}
+
+void ServiceBenchmark::watch(const char *name, QNetworkReply *reply)
+{
+	if (!isEnabled() || !reply) {
+		return;
+	}
+
+	ServiceBenchmark *benchmark = instance();
+	benchmark->requestStarted(name);
+
+	QElapsedTimer timer;
+	timer.start();
+
+	QSharedPointer<qint64> received(new qint64(0));
+	QSharedPointer<bool> done(new bool(false));
+
+	connect(reply, &QNetworkReply::downloadProgress, benchmark, [received](qint64 bytes, qint64) {
+		*received = bytes;
+	});
+
+	auto finish = [benchmark, name, timer, received, done, reply] {
+		if (*done) {
+			return;
+		}
+		*done = true;
+
+		const bool failed = (reply->error() != QNetworkReply::NoError);
+		benchmark->requestFinished(name, *received, timer.elapsed(), failed);
+	};
+
+	connect(reply, &QNetworkReply::finished, benchmark, finish);
+
+	// Replies deleted by the timeout handlers are never finished
+	connect(reply, &QObject::destroyed, benchmark, [benchmark, name, timer, received, done] {
+		if (!*done) {
+			*done = true;
+			benchmark->requestFinished(name, *received, timer.elapsed(), true);
+		}
+	});
+}
+
+void ServiceBenchmark::timerEvent(QTimerEvent *timerEvent)
+{
+	if (timerEvent->timerId() == _stallTimerId) {
+		const qint64 stall = _stallTimer.restart() - _stallCheckPeriod;
+
+		if (stall > _maxStallMs) {
+			_maxStallMs = stall;
+		}
+	} else if (timerEvent->timerId() == _reportTimerId) {
+		report();
+	}
+}
+
+void ServiceBenchmark::requestStarted(const char *name)
+{
+	_stats[name].requests++;
+	_inFlight++;
+
+	if (_inFlight > _maxInFlight) {
+		_maxInFlight = _inFlight;
+	}
+}
+
+void ServiceBenchmark::requestFinished(const char *name, qint64 bytes, qint64 timeMs, bool failed)
+{
+	Stats &stats = _stats[name];
+
+	_inFlight--;
+
+	if (failed) {
+		stats.failed++;
+	}
+
+	stats.bytes += bytes;
+	stats.replyTimeMs += timeMs;
+
+	if (timeMs > stats.maxReplyTimeMs) {
+		stats.maxReplyTimeMs = timeMs;
+	}
+}
+
+void ServiceBenchmark::parsed(const char *name, int bytes, qint64 timeUs)
+{
+	Stats &stats = _stats[name];
+
+	stats.parses++;
+	stats.parsedBytes += bytes;
+	stats.parseTimeUs += timeUs;
+
+	if (timeUs > stats.maxParseTimeUs) {
+		stats.maxParseTimeUs = timeUs;
+	}
+}
+
+void ServiceBenchmark::report()
+{
+	const qint64 memory = currentMemory();
+
+	LOG(("Bettergram Benchmark: in flight %1, max in flight %2, max GUI stall %3 ms, "
+		 "memory %4 KB (%5 KB since start)")
+		.arg(_inFlight)
+		.arg(_maxInFlight)
+		.arg(_maxStallMs)
+		.arg(memory / 1024)
+		.arg((memory - _startMemory) / 1024));
+
+	for (auto i = _stats.cbegin(); i != _stats.cend(); ++i) {
+		const Stats &stats = i.value();
+		const int finished = qMax(stats.requests, 1);
+		const int parses = qMax(stats.parses, 1);
+
+		LOG(("Bettergram Benchmark: %1 - requests %2, failed %3, received %4 KB, "
+			 "reply avg %5 ms max %6 ms, parses %7 of %8 KB, parse avg %9 us max %10 us")
+			.arg(QString::fromLatin1(i.key()))
+			.arg(stats.requests)
+			.arg(stats.failed)
+			.arg(stats.bytes / 1024)
+			.arg(stats.replyTimeMs / finished)
+			.arg(stats.maxReplyTimeMs)
+			.arg(stats.parses)
+			.arg(stats.parsedBytes / 1024)
+			.arg(stats.parseTimeUs / parses)
+			.arg(stats.maxParseTimeUs));
+	}
+
+	_maxStallMs = 0;
+}
+
+} // namespace Bettergram
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QMap>
+
+class QNetworkReply;
+
+namespace Bettergram {
+
+/**
+ * @brief The ServiceBenchmark class collects load statistics of the Bettergram service client.
+ * It is enabled by the BETTERGRAM_BENCHMARK environment variable, usually together with
+ * BETTERGRAM_API_URL and BETTERGRAM_PRICES_URL pointing to the local stand-in server
+ * from Telegram/build/bettergram_benchmark_server.py.
+ * While enabled it periodically writes to the log: request fan-out, reply sizes and latency,
+ * parse time on the GUI thread, the longest GUI thread stall and the process memory.
+ */
+class ServiceBenchmark : public QObject {
+	Q_OBJECT
+
+public:
+	/**
+	 * @brief The Parse class measures the time spent in its scope as a parse of the given data
+	 */
+	class Parse {
+	public:
+		Parse(const char *name, int bytes);
+		~Parse();
+
+	private:
+		const char *_name = nullptr;
+		int _bytes = 0;
+		QElapsedTimer _timer;
+	};
+
+	static bool isEnabled();
+
+	/// Counts the request as in-flight until the reply is finished or destroyed
+	static void watch(const char *name, QNetworkReply *reply);
+
+protected:
+	void timerEvent(QTimerEvent *timerEvent) override;
+
+private:
+	struct Stats {
+		int requests = 0;
+		int failed = 0;
+		qint64 bytes = 0;
+		qint64 replyTimeMs = 0;
+		qint64 maxReplyTimeMs = 0;
+		int parses = 0;
+		qint64 parsedBytes = 0;
+		qint64 parseTimeUs = 0;
+		qint64 maxParseTimeUs = 0;
+	};
+
+	/// We check GUI thread stalls every 10 ms
+	static const int _stallCheckPeriod;
+
+	/// We write the statistics to the log every 10 seconds
+	static const int _reportPeriod;
+
+	QMap<QByteArray, Stats> _stats;
+	int _inFlight = 0;
+	int _maxInFlight = 0;
+	qint64 _maxStallMs = 0;
+	qint64 _startMemory = 0;
+	QElapsedTimer _stallTimer;
+	int _stallTimerId = 0;
+	int _reportTimerId = 0;
+
+	static ServiceBenchmark *instance();
+	static qint64 currentMemory();
+
+	explicit ServiceBenchmark(QObject *parent);
+
+	void requestStarted(const char *name);
+	void requestFinished(const char *name, qint64 bytes, qint64 timeMs, bool failed);
+	void parsed(const char *name, int bytes, qint64 timeUs);
+	void report();
+};
+
+} // namespace Bettergram
@@ -24,7 +24,23 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "observer_peer.h"
 #include "apiwrap.h"
 
+#include <bettergram/networkfetcher.h>
+
 namespace ChatHelpers {
+namespace {
+
+Bettergram::NetworkFetcher::Source FetchSource(BettergramSelectorTab tab) {
+	using Source = Bettergram::NetworkFetcher::Source;
+	switch (tab) {
+	case BettergramSelectorTab::Prices: return Source::Prices;
+	case BettergramSelectorTab::News: return Source::News;
+	case BettergramSelectorTab::Videos: return Source::Videos;
+	case BettergramSelectorTab::Resources: return Source::Resources;
+	}
+	return Source::Other;
+}
+
+} // namespace
 
 BettergramTabbedSelector::Tab::Tab(BettergramSelectorTab type, object_ptr<TabbedSelector::Inner> widget)
 	: _type(type)
@@ -356,6 +372,8 @@ void BettergramTabbedSelector::showStarted() {
 
 void BettergramTabbedSelector::beforeHiding() {
 	if (!_scroll->isHidden()) {
+		Bettergram::NetworkFetcher::instance()->setVisibleSource(
+			Bettergram::NetworkFetcher::Source::Other);
 		currentTab()->widget()->beforeHiding();
 		if (_beforeHidingCallback) {
 			_beforeHidingCallback(_currentTabType);
@@ -366,6 +384,8 @@ void BettergramTabbedSelector::beforeHiding() {
 void BettergramTabbedSelector::afterShown() {
 	if (!_a_slide.animating()) {
 		showAll();
+		Bettergram::NetworkFetcher::instance()->setVisibleSource(
+			FetchSource(_currentTabType));
 		currentTab()->widget()->afterShown();
 		if (_afterShownCallback) {
 			_afterShownCallback(_currentTabType);
@@ -15,6 +15,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "boxes/stickers_box.h"
 #include "inline_bots/inline_bot_result.h"
 #include "chat_helpers/stickers.h"
+#include "chat_helpers/stickers_raster_cache.h"
 #include "storage/localstorage.h"
 #include "lang/lang_keys.h"
 #include "mainwindow.h"
@@ -34,6 +35,7 @@ namespace {
 constexpr auto kInlineItemsMaxPerRow = 5;
 constexpr auto kSearchRequestDelay = 400;
 constexpr auto kRecentDisplayLimit = 20;
+constexpr auto kPrefetchSetsCount = 2;
 
 bool SetInMyList(MTPDstickerSet::Flags flags) {
 	return (flags & MTPDstickerSet::Flag::f_installed_date)
@@ -750,6 +752,8 @@ void StickersListWidget::visibleTopBottomUpdated(
 	Inner::visibleTopBottomUpdated(visibleTop, visibleBottom);
 	if (_section == Section::Featured) {
 		readVisibleSets();
+	} else {
+		prefetchVisibleSets();
 	}
 	validateSelectedIcon(ValidateIconAnimations::Full);
 }
@@ -783,6 +787,52 @@ void StickersListWidget::readVisibleSets() {
 	}
 }
 
+void StickersListWidget::prefetchVisibleSets() {
+	const auto &sets = shownSets();
+	if (sets.empty()) {
+		return;
+	}
+	const auto from = sectionInfoByOffset(getVisibleTop()).section;
+	const auto till = std::min(
+		sectionInfoByOffset(getVisibleBottom()).section + kPrefetchSetsCount,
+		int(sets.size()) - 1);
+	for (auto i = from; i <= till; ++i) {
+		const auto &set = sets[i];
+		const auto count = set.externalLayout
+			? std::min(set.pack.size(), _columnCount)
+			: set.pack.size();
+		for (auto j = 0; j != count; ++j) {
+			const auto document = set.pack[j];
+			if (document && document->sticker()) {
+				prefetchSticker(document);
+			}
+		}
+	}
+}
+
+void StickersListWidget::prefetchSticker(not_null<DocumentData*> document) {
+	if (document->thumbnailEnoughForSticker()) {
+		document->checkStickerSmall();
+	} else {
+		document->owner().stickerRasters().prefetch(
+			document,
+			stickerSize(document));
+	}
+}
+
+QSize StickersListWidget::stickerSize(
+		not_null<DocumentData*> document) const {
+	const auto coef = std::min({
+		(_singleSize.width() - st::buttonRadius * 2)
+			/ float64(document->dimensions.width()),
+		(_singleSize.height() - st::buttonRadius * 2)
+			/ float64(document->dimensions.height()),
+		1. });
+	return QSize(
+		std::max(qRound(coef * document->dimensions.width()), 1),
+		std::max(qRound(coef * document->dimensions.height()), 1));
+}
+
 int StickersListWidget::featuredRowHeight() const {
 	return st::stickersTrendingHeader
 		+ _singleSize.height()
@@ -1360,25 +1410,32 @@ void StickersListWidget::paintSticker(Painter &p, Set &set, int y, int index, bo
 		App::roundRect(p, QRect(tl, _singleSize), st::emojiPanHover, StickerHoverCorners);
 	}
 
-	document->checkStickerSmall();
-
-	auto coef = qMin((_singleSize.width() - st::buttonRadius * 2) / float64(document->dimensions.width()), (_singleSize.height() - st::buttonRadius * 2) / float64(document->dimensions.height()));
-	if (coef > 1) coef = 1;
-	auto w = qMax(qRound(coef * document->dimensions.width()), 1);
-	auto h = qMax(qRound(coef * document->dimensions.height()), 1);
+	const auto size = stickerSize(document);
+	const auto w = size.width();
+	const auto h = size.height();
 	auto ppos = pos + QPoint((_singleSize.width() - w) / 2, (_singleSize.height() - h) / 2);
-	if (const auto image = document->getStickerSmall()) {
-		if (image->loaded()) {
-			p.drawPixmapLeft(
-				ppos,
-				width(),
-				image->pixSingle(
-					document->stickerSetOrigin(),
-					w,
-					h,
-					w,
-					h,
-					ImageRoundRadius::None));
+	if (!document->thumbnailEnoughForSticker()) {
+		const auto pixmap = document->owner().stickerRasters().frame(
+			document,
+			size);
+		if (!pixmap.isNull()) {
+			p.drawPixmapLeft(ppos, width(), pixmap);
+		}
+	} else {
+		document->checkStickerSmall();
+		if (const auto image = document->getStickerSmall()) {
+			if (image->loaded()) {
+				p.drawPixmapLeft(
+					ppos,
+					width(),
+					image->pixSingle(
+						document->stickerSetOrigin(),
+						w,
+						h,
+						w,
+						h,
+						ImageRoundRadius::None));
+			}
 		}
 	}
 
@@ -1807,7 +1864,7 @@ void StickersListWidget::preloadImages() {
 			const auto document = sets[i].pack[j];
 			if (!document || !document->sticker()) continue;
 
-			document->checkStickerSmall();
+			prefetchSticker(document);
 		}
 		if (k > _columnCount * (_columnCount + 1)) break;
 	}
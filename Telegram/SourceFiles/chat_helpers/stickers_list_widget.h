@@ -197,6 +197,9 @@ private:
 	const std::vector<Set> &shownSets() const;
 	int featuredRowHeight() const;
 	void readVisibleSets();
+	void prefetchVisibleSets();
+	void prefetchSticker(not_null<DocumentData*> document);
+	QSize stickerSize(not_null<DocumentData*> document) const;
 
 	void paintFeaturedStickers(Painter &p, QRect clip);
 	void paintStickers(Painter &p, QRect clip);
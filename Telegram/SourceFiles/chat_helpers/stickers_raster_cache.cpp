@@ -0,0 +1,240 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "chat_helpers/stickers_raster_cache.h"
+
+#include "data/data_session.h"
+#include "data/data_document.h"
+#include "storage/cache/storage_cache_database.h"
+#include "auth_session.h"
+
+namespace Stickers {
+namespace {
+
+constexpr auto kVersion = qint32(1);
+constexpr auto kHeaderSize = int(3 * sizeof(qint32));
+
+// Stickers are large and mostly transparent, the fastest zlib level
+// already compresses them a few times.
+constexpr auto kCompressionLevel = 1;
+
+int64 ComputeUsage(const QPixmap &pixmap) {
+	return int64(pixmap.width()) * pixmap.height() * 4;
+}
+
+} // namespace
+
+RasterCache::RasterCache(not_null<Data::Session*> owner)
+: _owner(owner) {
+	Core::MemoryBudget::Instance().registerClient(
+		this,
+		Core::MemoryKind::StickerRasters);
+}
+
+RasterCache::~RasterCache() {
+	auto &budget = Core::MemoryBudget::Instance();
+	budget.unregisterClient(this);
+	for (const auto &[key, entry] : _entries) {
+		budget.decrement(
+			Core::MemoryKind::StickerRasters,
+			ComputeUsage(entry.pixmap));
+	}
+}
+
+auto RasterCache::ComputeKey(not_null<DocumentData*> document, QSize size)
+-> Key {
+	return Data::StickerRasterCacheKey(
+		document->id,
+		size * cIntRetinaFactor());
+}
+
+QPixmap RasterCache::frame(not_null<DocumentData*> document, QSize size) {
+	const auto key = ComputeKey(document, size);
+	const auto i = _entries.find(key);
+	if (i != end(_entries)) {
+		i->second.used = crl::now();
+		_lastUsed.up(key);
+		return i->second.pixmap;
+	}
+	request(document, size);
+	return QPixmap();
+}
+
+void RasterCache::prefetch(not_null<DocumentData*> document, QSize size) {
+	if (!_entries.contains(ComputeKey(document, size))) {
+		request(document, size);
+	}
+}
+
+void RasterCache::request(not_null<DocumentData*> document, QSize size) {
+	const auto key = ComputeKey(document, size);
+	if (_requested.contains(key)) {
+		return;
+	}
+	_requested.emplace(key);
+
+	const auto weak = base::make_weak(this);
+	_owner->cache().get(key, [=](QByteArray &&serialized) {
+		if (serialized.isEmpty()) {
+			crl::on_main(weak, [=] {
+				weak->decode(document, key, size);
+			});
+			return;
+		}
+		crl::async([=, serialized = std::move(serialized)] {
+			auto image = Deserialize(serialized);
+			crl::on_main(weak, [=, image = std::move(image)]() mutable {
+				if (image.isNull()) {
+					weak->decode(document, key, size);
+				} else {
+					weak->ready(key, std::move(image));
+				}
+			});
+		});
+	});
+}
+
+void RasterCache::decode(
+		not_null<DocumentData*> document,
+		Key key,
+		QSize size) {
+	auto bytes = document->data();
+	if (bytes.isEmpty()) {
+		if (!document->loaded()) {
+			// We'll be asked again when it is loaded and repainted.
+			_requested.remove(key);
+			document->automaticLoad(document->stickerSetOrigin(), nullptr);
+			return;
+		}
+		const auto &location = document->location(true);
+		if (location.accessEnable()) {
+			auto file = QFile(location.name());
+			if (file.open(QIODevice::ReadOnly)) {
+				bytes = file.readAll();
+			}
+			location.accessDisable();
+		}
+		if (bytes.isEmpty()) {
+			return;
+		}
+	}
+	const auto pixels = size * cIntRetinaFactor();
+	const auto weak = base::make_weak(this);
+	crl::async([=] {
+		auto format = QByteArray();
+		auto image = App::readImage(bytes, &format, false);
+		auto serialized = QByteArray();
+		if (!image.isNull()) {
+			image = image.scaled(
+				pixels,
+				Qt::IgnoreAspectRatio,
+				Qt::SmoothTransformation
+			).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+			serialized = Serialize(image);
+		}
+		crl::on_main(weak, [
+			=,
+			image = std::move(image),
+			serialized = std::move(serialized)
+		]() mutable {
+			if (image.isNull()) {
+				LOG(("Stickers Error: could not decode sticker %1."
+					).arg(document->id));
+				return;
+			}
+			weak->_owner->cache().put(key, std::move(serialized));
+			weak->ready(key, std::move(image));
+		});
+	});
+}
+
+void RasterCache::ready(Key key, QImage &&image) {
+	_requested.remove(key);
+	auto pixmap = App::pixmapFromImageInPlace(std::move(image));
+	pixmap.setDevicePixelRatio(cRetinaFactor());
+	const auto usage = ComputeUsage(pixmap);
+	_entries.emplace(key, Entry{ std::move(pixmap), crl::now() });
+	_lastUsed.up(key);
+	Core::MemoryBudget::Instance().increment(
+		Core::MemoryKind::StickerRasters,
+		usage);
+	notifyReady();
+}
+
+void RasterCache::notifyReady() {
+	if (_notifyScheduled) {
+		return;
+	}
+	_notifyScheduled = true;
+	crl::on_main(this, [=] {
+		_notifyScheduled = false;
+		_owner->session().downloaderTaskFinished().notify();
+	});
+}
+
+int RasterCache::entriesCount() const {
+	return int(_entries.size());
+}
+
+crl::time RasterCache::lowestUsed() const {
+	const auto i = _entries.find(_lastUsed.lowest());
+	return (i != end(_entries)) ? i->second.used : crl::now();
+}
+
+void RasterCache::unloadLowest() {
+	const auto key = _lastUsed.take_lowest();
+	const auto i = _entries.find(key);
+	if (i == end(_entries)) {
+		return;
+	}
+	Core::MemoryBudget::Instance().decrement(
+		Core::MemoryKind::StickerRasters,
+		ComputeUsage(i->second.pixmap));
+	_entries.erase(i);
+}
+
+QByteArray RasterCache::Serialize(const QImage &image) {
+	Expects(image.format() == QImage::Format_ARGB32_Premultiplied);
+
+	const auto bits = QByteArray::fromRawData(
+		reinterpret_cast<const char*>(image.constBits()),
+		image.bytesPerLine() * image.height());
+	auto result = QByteArray();
+	{
+		auto stream = QDataStream(&result, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_1);
+		stream
+			<< kVersion
+			<< qint32(image.width())
+			<< qint32(image.height());
+	}
+	result.append(qCompress(bits, kCompressionLevel));
+	return result;
+}
+
+QImage RasterCache::Deserialize(const QByteArray &serialized) {
+	auto version = qint32();
+	auto width = qint32();
+	auto height = qint32();
+	auto stream = QDataStream(serialized);
+	stream.setVersion(QDataStream::Qt_5_1);
+	stream >> version >> width >> height;
+	if (stream.status() != QDataStream::Ok
+		|| version != kVersion
+		|| width <= 0
+		|| height <= 0) {
+		return QImage();
+	}
+	const auto bits = qUncompress(serialized.mid(kHeaderSize));
+	auto result = QImage(width, height, QImage::Format_ARGB32_Premultiplied);
+	if (bits.size() != result.bytesPerLine() * result.height()) {
+		return QImage();
+	}
+	memcpy(result.bits(), bits.constData(), bits.size());
+	return result;
+}
+
+} // namespace Stickers
@@ -0,0 +1,73 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/weak_ptr.h"
+#include "base/last_used_cache.h"
+#include "core/memory_budget.h"
+#include "storage/cache/storage_cache_types.h"
+
+namespace Data {
+class Session;
+} // namespace Data
+
+namespace Stickers {
+
+// Stickers decoded and scaled to the exact sizes they are painted with.
+//
+// WebP decoding and scaling are done in the crl::async() pool and the
+// premultiplied result is saved compressed to the local cache database,
+// so next time only a decompression is required. Until a bitmap is ready
+// a null pixmap is returned and the widgets are repainted when it is.
+class RasterCache final
+	: public base::has_weak_ptr
+	, public Core::MemoryBudget::Client {
+public:
+	explicit RasterCache(not_null<Data::Session*> owner);
+	RasterCache(const RasterCache &other) = delete;
+	RasterCache &operator=(const RasterCache &other) = delete;
+	~RasterCache();
+
+	// Size is in logical pixels.
+	[[nodiscard]] QPixmap frame(
+		not_null<DocumentData*> document,
+		QSize size);
+	void prefetch(not_null<DocumentData*> document, QSize size);
+
+	int entriesCount() const override;
+	crl::time lowestUsed() const override;
+	void unloadLowest() override;
+
+private:
+	using Key = Storage::Cache::Key;
+	struct Entry {
+		QPixmap pixmap;
+		crl::time used = 0;
+	};
+
+	[[nodiscard]] static Key ComputeKey(
+		not_null<DocumentData*> document,
+		QSize size);
+	[[nodiscard]] static QByteArray Serialize(const QImage &image);
+	[[nodiscard]] static QImage Deserialize(const QByteArray &serialized);
+
+	void request(not_null<DocumentData*> document, QSize size);
+	void decode(not_null<DocumentData*> document, Key key, QSize size);
+	void ready(Key key, QImage &&image);
+	void notifyReady();
+
+	const not_null<Data::Session*> _owner;
+	base::flat_map<Key, Entry> _entries;
+	base::last_used_cache<Key> _lastUsed;
+
+	// Keys that are being prepared or failed to be decoded.
+	base::flat_set<Key> _requested;
+	bool _notifyScheduled = false;
+
+};
+
+} // namespace Stickers
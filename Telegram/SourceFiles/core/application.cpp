@@ -17,6 +17,8 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "core/sandbox.h"
 #include "core/local_url_handlers.h"
 #include "core/launcher.h"
+#include "core/memory_budget.h"
+#include "core/trace.h"
 #include "storage/localstorage.h"
 #include "platform/platform_specific.h"
 #include "mainwindow.h"
@@ -93,6 +95,8 @@ Application::Application(not_null<Launcher*> launcher)
 }
 
 void Application::run() {
+	const auto trace = TraceSpan("Application::run");
+
 	Fonts::Start();
 
 	ThirdParty::start();
@@ -117,7 +121,11 @@ void Application::run() {
 	style::startManager();
 	anim::startManager();
 	Ui::InitTextOptions();
-	Ui::Emoji::Init();
+	Core::MemoryBudget::Instance().startWatching();
+	{
+		const auto trace = TraceSpan("Ui::Emoji::Init");
+		Ui::Emoji::Init();
+	}
 	Media::Player::start(_audio.get());
 
 	DEBUG_LOG(("Application Info: inited..."));
@@ -132,8 +140,11 @@ void Application::run() {
 	// Create mime database, so it won't be slow later.
 	QMimeDatabase().mimeTypeForName(qsl("text/plain"));
 
-	_window = std::make_unique<MainWindow>();
-	_window->init();
+	{
+		const auto trace = TraceSpan("MainWindow::init");
+		_window = std::make_unique<MainWindow>();
+		_window->init();
+	}
 
 	auto currentGeometry = _window->geometry();
 	_mediaView = std::make_unique<Media::View::OverlayWidget>();
@@ -151,7 +162,10 @@ void Application::run() {
 	startShortcuts();
 	App::initMedia();
 
-	Local::ReadMapState state = Local::readMap(QByteArray());
+	const auto state = [&] {
+		const auto trace = TraceSpan("Local::readMap");
+		return Local::readMap(QByteArray());
+	}();
 	if (state == Local::ReadMapPassNeeded) {
 		Global::SetLocalPasscode(true);
 		Global::RefLocalPasscodeChanged().notify();
@@ -591,7 +605,10 @@ void Application::resetAuthorizationKeys() {
 void Application::startLocalStorage() {
 	_dcOptions = std::make_unique<MTP::DcOptions>();
 	_dcOptions->constructFromBuiltIn();
-	Local::start();
+	{
+		const auto trace = TraceSpan("Local::start");
+		Local::start();
+	}
 	subscribe(_dcOptions->changed(), [this](const MTP::DcOptions::Ids &ids) {
 		Local::writeSettings();
 		if (auto instance = mtp()) {
@@ -12,6 +12,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "core/main_queue_processor.h"
 #include "core/update_checker.h"
 #include "core/sandbox.h"
+#include "core/trace.h"
 #include "base/concurrent_timer.h"
 
 namespace Core {
@@ -385,6 +386,7 @@ void Launcher::processArguments() {
 		{ "-startintray"    , KeyFormat::NoValues },
 		{ "-sendpath"       , KeyFormat::AllLeftValues },
 		{ "-workdir"        , KeyFormat::OneValue },
+		{ "-trace"          , KeyFormat::OneValue },
 		{ "--"              , KeyFormat::OneValue },
 	};
 	auto parseResult = QMap<QByteArray, QStringList>();
@@ -435,6 +437,11 @@ void Launcher::processArguments() {
 		}
 	}
 	gStartUrl = parseResult.value("--", {}).join(QString());
+
+	const auto tracePath = parseResult.value("-trace", {}).join(QString());
+	if (!tracePath.isEmpty()) {
+		StartTrace(tracePath);
+	}
 }
 
 int Launcher::executeApplication() {
@@ -7,14 +7,18 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #pragma once
 
 #include "base/last_used_cache.h"
+#include "core/memory_budget.h"
 
 namespace Core {
 
 template <typename Type>
-class MediaActiveCache {
+class MediaActiveCache final : public MemoryBudget::Client {
 public:
 	template <typename Unload>
-	MediaActiveCache(int64 limit, Unload &&unload);
+	MediaActiveCache(MemoryKind kind, Unload &&unload);
+	MediaActiveCache(const MediaActiveCache &other) = delete;
+	MediaActiveCache &operator=(const MediaActiveCache &other) = delete;
+	~MediaActiveCache();
 
 	void up(Type *entry);
 	void remove(Type *entry);
@@ -23,60 +27,76 @@ public:
 	void increment(int64 amount);
 	void decrement(int64 amount);
 
-private:
-	template <typename Unload>
-	void check(Unload &&unload);
+	int entriesCount() const override;
+	crl::time lowestUsed() const override;
+	void unloadLowest() override;
 
+private:
+	MemoryKind _kind = MemoryKind::ImageOriginals;
+	Fn<void(Type*)> _unload;
 	base::last_used_cache<Type*> _cache;
-	SingleQueuedInvokation _delayed;
-	int64 _usage = 0;
-	int64 _limit = 0;
+	std::unordered_map<Type*, crl::time> _used;
 
 };
 
 template <typename Type>
 template <typename Unload>
-MediaActiveCache<Type>::MediaActiveCache(int64 limit, Unload &&unload)
-: _delayed([=] { check(unload); })
-, _limit(limit) {
+MediaActiveCache<Type>::MediaActiveCache(MemoryKind kind, Unload &&unload)
+: _kind(kind)
+, _unload(std::forward<Unload>(unload)) {
+	MemoryBudget::Instance().registerClient(this, _kind);
+}
+
+template <typename Type>
+MediaActiveCache<Type>::~MediaActiveCache() {
+	MemoryBudget::Instance().unregisterClient(this);
 }
 
 template <typename Type>
 void MediaActiveCache<Type>::up(Type *entry) {
 	_cache.up(entry);
-	_delayed.call();
+	_used[entry] = crl::now();
 }
 
 template <typename Type>
 void MediaActiveCache<Type>::remove(Type *entry) {
 	_cache.remove(entry);
+	_used.erase(entry);
 }
 
 template <typename Type>
 void MediaActiveCache<Type>::clear() {
 	_cache.clear();
+	_used.clear();
 }
 
 template <typename Type>
 void MediaActiveCache<Type>::increment(int64 amount) {
-	_usage += amount;
+	MemoryBudget::Instance().increment(_kind, amount);
 }
 
 template <typename Type>
 void MediaActiveCache<Type>::decrement(int64 amount) {
-	_usage -= amount;
+	MemoryBudget::Instance().decrement(_kind, amount);
 }
 
 template <typename Type>
-template <typename Unload>
-void MediaActiveCache<Type>::check(Unload &&unload) {
-	while (_usage > _limit) {
-		if (const auto entry = _cache.take_lowest()) {
-			unload(entry);
-		} else {
-			break;
-		}
+int MediaActiveCache<Type>::entriesCount() const {
+	return _cache.size();
+}
+
+template <typename Type>
+crl::time MediaActiveCache<Type>::lowestUsed() const {
+	const auto i = _used.find(_cache.lowest());
+	return (i != end(_used)) ? i->second : crl::now();
+}
+
+template <typename Type>
+void MediaActiveCache<Type>::unloadLowest() {
+	if (const auto entry = _cache.take_lowest()) {
+		_used.erase(entry);
+		_unload(entry);
 	}
 }
 
-} // namespace Images
+} // namespace Core
@@ -0,0 +1,261 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "core/memory_budget.h"
+
+#include "base/timer.h"
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#elif defined Q_OS_MAC // Q_OS_WIN
+#include <mach/mach.h>
+#include <sys/sysctl.h>
+#else // Q_OS_WIN || Q_OS_MAC
+#include <unistd.h>
+#endif // Q_OS_WIN || Q_OS_MAC
+
+namespace Core {
+namespace {
+
+// We use 1/16 of the physical memory for the decoded media.
+constexpr auto kPhysicalMemoryPart = 16;
+constexpr auto kMinLimit = int64(192 * 1024 * 1024);
+constexpr auto kMaxLimit = int64(1024 * 1024 * 1024);
+
+// Pinned memory can't leave the unloadable caches less than that.
+constexpr auto kMinUnloadableLimit = kMinLimit / 2;
+
+// While less than 1/10 of the physical memory is available
+// we keep only a half of the limit.
+constexpr auto kLowAvailablePart = 10;
+constexpr auto kPressureLimitDivider = 2;
+constexpr auto kPressureCheckTimeout = crl::time(10000);
+
+int64 PhysicalMemory() {
+#ifdef Q_OS_WIN
+	auto status = MEMORYSTATUSEX();
+	status.dwLength = sizeof(status);
+	return GlobalMemoryStatusEx(&status) ? int64(status.ullTotalPhys) : 0;
+#elif defined Q_OS_MAC // Q_OS_WIN
+	auto result = int64(0);
+	auto size = sizeof(result);
+	return (sysctlbyname("hw.memsize", &result, &size, nullptr, 0) == 0)
+		? result
+		: 0;
+#else // Q_OS_WIN || Q_OS_MAC
+	const auto pages = sysconf(_SC_PHYS_PAGES);
+	const auto pageSize = sysconf(_SC_PAGE_SIZE);
+	return (pages > 0 && pageSize > 0) ? int64(pages) * pageSize : 0;
+#endif // Q_OS_WIN || Q_OS_MAC
+}
+
+// Returns -1 if the available memory is unknown.
+int64 AvailableMemory() {
+#ifdef Q_OS_WIN
+	auto status = MEMORYSTATUSEX();
+	status.dwLength = sizeof(status);
+	return GlobalMemoryStatusEx(&status) ? int64(status.ullAvailPhys) : -1;
+#elif defined Q_OS_MAC // Q_OS_WIN
+	auto statistics = vm_statistics64_data_t();
+	auto count = mach_msg_type_number_t(HOST_VM_INFO64_COUNT);
+	const auto result = host_statistics64(
+		mach_host_self(),
+		HOST_VM_INFO64,
+		reinterpret_cast<host_info64_t>(&statistics),
+		&count);
+	return (result == KERN_SUCCESS)
+		? (int64(statistics.free_count) + statistics.inactive_count)
+			* int64(vm_page_size)
+		: -1;
+#else // Q_OS_WIN || Q_OS_MAC
+	auto file = QFile(qsl("/proc/meminfo"));
+	if (!file.open(QIODevice::ReadOnly)) {
+		return -1;
+	}
+	const auto key = QByteArray("MemAvailable:");
+	for (const auto &line : file.readAll().split('\n')) {
+		if (line.startsWith(key)) {
+			const auto kilobytes = line.mid(key.size()).trimmed().split(' ');
+			return kilobytes.front().toLongLong() * 1024;
+		}
+	}
+	return -1;
+#endif // Q_OS_WIN || Q_OS_MAC
+}
+
+int64 ComputeLimit(int64 physical) {
+	return physical
+		? std::clamp(physical / kPhysicalMemoryPart, kMinLimit, kMaxLimit)
+		: kMinLimit;
+}
+
+bool Unloadable(MemoryKind kind) {
+	return (kind != MemoryKind::ClipFrames)
+		&& (kind != MemoryKind::EmojiSprites);
+}
+
+// How expensive it is to get the unloaded data back.
+int UnloadCost(MemoryKind kind) {
+	switch (kind) {
+	case MemoryKind::ScaledPixmaps: return 1;
+	case MemoryKind::StickerRasters: return 2;
+	case MemoryKind::Documents: return 3;
+	case MemoryKind::ImageOriginals: return 4;
+	}
+	return 4;
+}
+
+} // namespace
+
+MemoryBudget &MemoryBudget::Instance() {
+	// Never destroyed, static caches use it until the very exit.
+	static const auto result = new MemoryBudget();
+	return *result;
+}
+
+MemoryBudget::MemoryBudget()
+: _physical(PhysicalMemory())
+, _limit(ComputeLimit(_physical)) {
+}
+
+void MemoryBudget::startWatching() {
+	if (_pressureTimer) {
+		return;
+	}
+	LOG(("Memory Budget: limit %1 MB.").arg(_limit / (1024 * 1024)));
+
+	_pressureTimer = std::make_unique<base::Timer>([=] { checkPressure(); });
+	_pressureTimer->callEach(kPressureCheckTimeout);
+}
+
+void MemoryBudget::registerClient(
+		not_null<Client*> client,
+		MemoryKind kind) {
+	_clients.push_back({ client, kind });
+}
+
+void MemoryBudget::unregisterClient(not_null<Client*> client) {
+	_clients.erase(
+		ranges::remove(_clients, client, &ClientData::client),
+		end(_clients));
+}
+
+void MemoryBudget::increment(MemoryKind kind, int64 amount) {
+	_usage[static_cast<int>(kind)] += amount;
+	if (unloadableUsage() > unloadableLimit()) {
+		scheduleCheck();
+	}
+}
+
+void MemoryBudget::decrement(MemoryKind kind, int64 amount) {
+	_usage[static_cast<int>(kind)] -= amount;
+}
+
+int64 MemoryBudget::usage() const {
+	auto result = int64(0);
+	for (const auto &usage : _usage) {
+		result += usage.load();
+	}
+	return result;
+}
+
+int64 MemoryBudget::usage(MemoryKind kind) const {
+	return _usage[static_cast<int>(kind)].load();
+}
+
+int64 MemoryBudget::unloadableUsage() const {
+	auto result = int64(0);
+	for (auto i = 0; i != kKindsCount; ++i) {
+		if (Unloadable(static_cast<MemoryKind>(i))) {
+			result += _usage[i].load();
+		}
+	}
+	return result;
+}
+
+int64 MemoryBudget::pinnedUsage() const {
+	auto result = int64(0);
+	for (auto i = 0; i != kKindsCount; ++i) {
+		if (!Unloadable(static_cast<MemoryKind>(i))) {
+			result += _usage[i].load();
+		}
+	}
+	return result;
+}
+
+int64 MemoryBudget::unloadableLimit() const {
+	return std::max(limit() - pinnedUsage(), kMinUnloadableLimit);
+}
+
+int64 MemoryBudget::limit() const {
+	return _underPressure ? (_limit / kPressureLimitDivider) : _limit;
+}
+
+void MemoryBudget::scheduleCheck() {
+	if (_checkScheduled.exchange(true)) {
+		return;
+	}
+	crl::on_main([] {
+		auto &instance = Instance();
+		instance._checkScheduled = false;
+		instance.check();
+	});
+}
+
+void MemoryBudget::checkPressure() {
+	const auto available = AvailableMemory();
+	if (available < 0 || !_physical) {
+		return;
+	}
+	const auto underPressure = (available * kLowAvailablePart < _physical);
+	if (_underPressure == underPressure) {
+		return;
+	}
+	_underPressure = underPressure;
+	LOG(("Memory Budget: %1 memory pressure, usage %2 MB."
+		).arg(underPressure ? "entering" : "leaving"
+		).arg(usage() / (1024 * 1024)));
+	if (_underPressure) {
+		check();
+	}
+}
+
+MemoryBudget::Client *MemoryBudget::chooseToUnload() const {
+	const auto now = crl::now();
+	auto result = (Client*)nullptr;
+	auto resultScore = 0.;
+	for (const auto &data : _clients) {
+		const auto count = data.client->entriesCount();
+		if (!count) {
+			continue;
+		}
+		const auto size = usage(data.kind) / double(count);
+		const auto age = (now - data.client->lowestUsed()) + 1;
+		const auto score = size * age / UnloadCost(data.kind);
+		if (!result || score > resultScore) {
+			result = data.client;
+			resultScore = score;
+		}
+	}
+	return result;
+}
+
+void MemoryBudget::check() {
+	if (_checking) {
+		return;
+	}
+	_checking = true;
+	while (unloadableUsage() > unloadableLimit()) {
+		if (const auto client = chooseToUnload()) {
+			client->unloadLowest();
+		} else {
+			break;
+		}
+	}
+	_checking = false;
+}
+
+} // namespace Core
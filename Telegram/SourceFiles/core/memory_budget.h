@@ -0,0 +1,93 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+namespace base {
+class Timer;
+} // namespace base
+
+namespace Core {
+
+enum class MemoryKind {
+	ImageOriginals,
+	ScaledPixmaps,
+	Documents,
+	StickerRasters,
+	ClipFrames,
+	EmojiSprites,
+};
+
+// One memory limit for all the decoded media caches.
+//
+// The limit is computed from the physical memory size and is lowered
+// while the system is short of available memory. When the usage is over
+// the limit the entries are unloaded from the caches registered as clients,
+// each time from the one which least used entry is the cheapest to keep:
+// large, long unused and easy to decode again. Clip frames and emoji
+// sprites can't be unloaded, they are pinned: they take their part of the
+// limit from the other caches, but those always keep at least a part of it,
+// so that they don't thrash.
+class MemoryBudget final {
+public:
+	class Client {
+	public:
+		[[nodiscard]] virtual int entriesCount() const = 0;
+		[[nodiscard]] virtual crl::time lowestUsed() const = 0;
+		virtual void unloadLowest() = 0;
+
+	protected:
+		~Client() = default;
+
+	};
+
+	[[nodiscard]] static MemoryBudget &Instance();
+
+	void startWatching();
+
+	void registerClient(not_null<Client*> client, MemoryKind kind);
+	void unregisterClient(not_null<Client*> client);
+
+	// Thread safe.
+	void increment(MemoryKind kind, int64 amount);
+	void decrement(MemoryKind kind, int64 amount);
+
+	[[nodiscard]] int64 usage() const;
+	[[nodiscard]] int64 usage(MemoryKind kind) const;
+	[[nodiscard]] int64 unloadableUsage() const;
+	[[nodiscard]] int64 pinnedUsage() const;
+	[[nodiscard]] int64 limit() const;
+
+	// Called from the main thread.
+	void check();
+
+private:
+	static constexpr auto kKindsCount = 6;
+
+	struct ClientData {
+		not_null<Client*> client;
+		MemoryKind kind = MemoryKind::ImageOriginals;
+	};
+
+	MemoryBudget();
+
+	void checkPressure();
+	void scheduleCheck();
+	[[nodiscard]] int64 unloadableLimit() const;
+	[[nodiscard]] Client *chooseToUnload() const;
+
+	const int64 _physical = 0;
+	const int64 _limit = 0;
+	std::atomic<int64> _usage[kKindsCount] = {};
+	std::atomic<bool> _checkScheduled = { false };
+	std::vector<ClientData> _clients;
+	std::unique_ptr<base::Timer> _pressureTimer;
+	std::atomic<bool> _underPressure = { false };
+	bool _checking = false;
+
+};
+
+} // namespace Core
@@ -0,0 +1,128 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "core/trace.h"
+
+#include <QtCore/QThread>
+
+#include <chrono>
+#include <mutex>
+
+namespace Core {
+namespace {
+
+struct Event {
+	const char *name = nullptr;
+	char phase = 0;
+	int64 start = 0;
+	int64 duration = 0;
+	quint64 thread = 0;
+};
+
+std::atomic<bool> Enabled = false;
+QString Path;
+std::chrono::steady_clock::time_point Started;
+std::mutex Mutex;
+std::vector<Event> Events;
+
+int64 Now() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - Started).count();
+}
+
+void Record(const char *name, char phase, int64 start, int64 duration) {
+	const auto thread = quint64(
+		reinterpret_cast<quintptr>(QThread::currentThreadId()));
+	std::lock_guard<std::mutex> lock(Mutex);
+	if (Enabled) {
+		Events.push_back({ name, phase, start, duration, thread });
+	}
+}
+
+QByteArray Serialize(const std::vector<Event> &events) {
+	auto result = QByteArray("{\"traceEvents\":[\n");
+	auto first = true;
+	for (const auto &event : events) {
+		if (!first) {
+			result.append(",\n");
+		}
+		first = false;
+		result.append("{\"name\":\"").append(event.name);
+		result.append("\",\"cat\":\"startup\",\"ph\":\"").append(event.phase);
+		result.append("\",\"ts\":").append(QByteArray::number(event.start));
+		if (event.phase == 'X') {
+			result.append(",\"dur\":");
+			result.append(QByteArray::number(event.duration));
+		} else {
+			result.append(",\"s\":\"g\"");
+		}
+		result.append(",\"pid\":1,\"tid\":");
+		result.append(QByteArray::number(event.thread));
+		result.append('}');
+	}
+	result.append("\n],\"displayTimeUnit\":\"ms\"}\n");
+	return result;
+}
+
+} // namespace
+
+void StartTrace(const QString &path) {
+	Expects(!Enabled);
+
+	Path = path;
+	Started = std::chrono::steady_clock::now();
+	Events.reserve(256);
+	Enabled = true;
+	TraceInstant("start");
+}
+
+bool TraceEnabled() {
+	return Enabled;
+}
+
+void TraceInstant(const char *name) {
+	if (Enabled) {
+		Record(name, 'i', Now(), 0);
+	}
+}
+
+void FinishTrace() {
+	if (!Enabled) {
+		return;
+	}
+	TraceInstant("finish");
+
+	auto events = std::vector<Event>();
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		Enabled = false;
+		events = base::take(Events);
+	}
+	auto file = QFile(Path);
+	if (!file.open(QIODevice::WriteOnly)
+		|| file.write(Serialize(events)) < 0) {
+		LOG(("Trace Error: could not write the trace to '%1'.").arg(Path));
+	} else {
+		LOG(("Trace Info: %1 events written to '%2'."
+			).arg(events.size()
+			).arg(Path));
+	}
+}
+
+TraceSpan::TraceSpan(const char *name) {
+	if (Enabled) {
+		_name = name;
+		_start = Now();
+	}
+}
+
+TraceSpan::~TraceSpan() {
+	if (_name) {
+		Record(_name, 'X', _start, Now() - _start);
+	}
+}
+
+} // namespace Core
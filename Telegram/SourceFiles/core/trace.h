@@ -0,0 +1,35 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core {
+
+// Launch timeline in the Chrome trace format (chrome://tracing).
+//
+// Nothing is recorded unless the app is started with "-trace <path>".
+// Then spans and instant events are collected from any thread until the
+// first paint of the chats list, when the timeline is written to the path.
+void StartTrace(const QString &path);
+[[nodiscard]] bool TraceEnabled();
+void TraceInstant(const char *name);
+void FinishTrace();
+
+class TraceSpan final {
+public:
+	// Name should be a string literal, it is not copied.
+	explicit TraceSpan(const char *name);
+	TraceSpan(const TraceSpan &other) = delete;
+	TraceSpan &operator=(const TraceSpan &other) = delete;
+	~TraceSpan();
+
+private:
+	const char *_name = nullptr;
+	int64 _start = 0;
+
+};
+
+} // namespace Core
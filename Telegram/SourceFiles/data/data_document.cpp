@@ -32,13 +32,11 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 
 namespace {
 
-constexpr auto kMemoryForCache = 32 * 1024 * 1024;
-
 using FilePathResolve = DocumentData::FilePathResolve;
 
 Core::MediaActiveCache<DocumentData> &ActiveCache() {
 	static auto Instance = Core::MediaActiveCache<DocumentData>(
-		kMemoryForCache,
+		Core::MemoryKind::Documents,
 		[](DocumentData *document) { document->unload(); });
 	return Instance;
 }
@@ -425,16 +423,6 @@ Data::FileOrigin StickerData::setOrigin() const {
 	});
 }
 
-VoiceData::~VoiceData() {
-	if (!waveform.isEmpty()
-		&& waveform[0] == -1
-		&& waveform.size() > int32(sizeof(TaskId))) {
-		TaskId taskId = 0;
-		memcpy(&taskId, waveform.constData() + 1, sizeof(taskId));
-		Local::cancelTask(taskId);
-	}
-}
-
 DocumentData::DocumentData(not_null<Data::Session*> owner, DocumentId id)
 : id(id)
 , _owner(owner) {
@@ -608,6 +596,10 @@ Storage::Cache::Key DocumentData::goodThumbnailCacheKey() const {
 	return Data::DocumentThumbCacheKey(_dc, id);
 }
 
+Storage::Cache::Key DocumentData::waveformCacheKey() const {
+	return Data::DocumentWaveformCacheKey(_dc, id);
+}
+
 Image *DocumentData::goodThumbnail() const {
 	return _goodThumbnail.get();
 }
@@ -70,11 +70,10 @@ struct SongData : public DocumentAdditionalData {
 };
 
 struct VoiceData : public DocumentAdditionalData {
-	~VoiceData();
-
 	int duration = 0;
 	VoiceWaveform waveform;
 	char wavemax = 0;
+	base::binary_guard counting;
 };
 
 bool fileIsImage(const QString &name, const QString &mime);
@@ -140,6 +139,7 @@ public:
 	void checkStickerSmall();
 	[[nodiscard]] Image *getStickerSmall();
 	[[nodiscard]] Image *getStickerLarge();
+	[[nodiscard]] bool thumbnailEnoughForSticker() const;
 	[[nodiscard]] Data::FileOrigin stickerSetOrigin() const;
 	[[nodiscard]] Data::FileOrigin stickerOrGifOrigin() const;
 	[[nodiscard]] bool isStickerSetInstalled() const;
@@ -179,6 +179,7 @@ public:
 
 	[[nodiscard]] Image *goodThumbnail() const;
 	[[nodiscard]] Storage::Cache::Key goodThumbnailCacheKey() const;
+	[[nodiscard]] Storage::Cache::Key waveformCacheKey() const;
 	void setGoodThumbnailOnUpload(QImage &&image, QByteArray &&bytes);
 	void refreshGoodThumbnail();
 	void replaceGoodThumbnail(std::unique_ptr<Images::Source> &&source);
@@ -253,8 +254,6 @@ private:
 
 	void destroyLoader(mtpFileLoader *newValue = nullptr) const;
 
-	[[nodiscard]] bool thumbnailEnoughForSticker() const;
-
 	// Two types of location: from MTProto by dc+access or from web by url
 	int32 _dc = 0;
 	uint64 _access = 0;
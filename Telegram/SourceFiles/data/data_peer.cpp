@@ -99,7 +99,6 @@ PeerData::PeerData(not_null<Data::Session*> owner, PeerId id)
 : id(id)
 , _owner(owner)
 , _userpicEmpty(createEmptyUserpic()) {
-	nameText.setText(st::msgNameStyle, QString(), Ui::NameTextOptions());
 }
 
 Data::Session &PeerData::owner() const {
@@ -130,12 +129,13 @@ void PeerData::updateNameDelayed(
 	}
 	++nameVersion;
 	name = newName;
-	nameText.setText(st::msgNameStyle, name, Ui::NameTextOptions());
+	_nameText = Text();
 	refreshEmptyUserpic();
 
+	// Lists index the peer by the letters they've got from it last time.
 	Notify::PeerUpdate update(this);
 	update.flags |= UpdateFlag::NameChanged;
-	update.oldNameFirstLetters = nameFirstLetters();
+	update.oldNameFirstLetters = _nameFirstLetters;
 
 	if (isUser()) {
 		if (asUser()->username != newUsername) {
@@ -155,7 +155,7 @@ void PeerData::updateNameDelayed(
 			update.flags |= UpdateFlag::UsernameChanged;
 		}
 	}
-	fillNames();
+	_nameWordsValid = false;
 	Notify::PeerUpdated().notify(update, true);
 }
 
@@ -402,7 +402,22 @@ bool PeerData::setAbout(const QString &newAbout) {
 	return true;
 }
 
-void PeerData::fillNames() {
+const base::flat_set<QString> &PeerData::nameWords() const {
+	if (!_nameWordsValid) {
+		fillNames();
+	}
+	return _nameWords;
+}
+
+const base::flat_set<QChar> &PeerData::nameFirstLetters() const {
+	if (!_nameWordsValid) {
+		fillNames();
+	}
+	return _nameFirstLetters;
+}
+
+void PeerData::fillNames() const {
+	_nameWordsValid = true;
 	_nameWords.clear();
 	_nameFirstLetters.clear();
 	auto toIndexList = QStringList();
@@ -439,7 +454,7 @@ void PeerData::fillNames() {
 
 	const auto namesList = TextUtilities::PrepareSearchWords(toIndex);
 	for (const auto &name : namesList) {
-		_nameWords.insert(name);
+		_nameWords.insert(_owner->internedString(name));
 		_nameFirstLetters.insert(name[0]);
 	}
 }
@@ -569,12 +584,19 @@ Data::Feed *PeerData::feed() const {
 	return nullptr;
 }
 
+const Text &PeerData::nameText() const {
+	if (_nameText.isEmpty() && !name.isEmpty()) {
+		_nameText.setText(st::msgNameStyle, name, Ui::NameTextOptions());
+	}
+	return _nameText;
+}
+
 const Text &PeerData::dialogName() const {
 	return migrateTo()
 		? migrateTo()->dialogName()
-		: (isUser() && !asUser()->phoneText.isEmpty())
-			? asUser()->phoneText
-			: nameText;
+		: (isUser() && !asUser()->nameOrPhone.isEmpty())
+			? asUser()->phoneText()
+			: nameText();
 }
 
 const QString &PeerData::shortName() const {
@@ -187,6 +187,9 @@ public:
 		return (_lastFullUpdate != 0);
 	}
 
+	// Laid out when painted for the first time, most of the known peers
+	// are never shown by name.
+	[[nodiscard]] const Text &nameText() const;
 	[[nodiscard]] const Text &dialogName() const;
 	[[nodiscard]] const QString &shortName() const;
 	[[nodiscard]] QString userName() const;
@@ -195,12 +198,9 @@ public:
 		return int32(uint32(id & 0xFFFFFFFFULL));
 	}
 
-	[[nodiscard]] const base::flat_set<QString> &nameWords() const {
-		return _nameWords;
-	}
-	[[nodiscard]] const base::flat_set<QChar> &nameFirstLetters() const {
-		return _nameFirstLetters;
-	}
+	// Filled when asked for the first time after a name change.
+	[[nodiscard]] const base::flat_set<QString> &nameWords() const;
+	[[nodiscard]] const base::flat_set<QChar> &nameFirstLetters() const;
 
 	void setUserpic(
 		PhotoId photoId,
@@ -291,7 +291,6 @@ public:
 
 	const PeerId id;
 	QString name;
-	Text nameText;
 	LoadedStatus loadedStatus = NotLoaded;
 	MTPinputPeer input;
 
@@ -306,7 +305,7 @@ protected:
 	void clearUserpic();
 
 private:
-	void fillNames();
+	void fillNames() const;
 	std::unique_ptr<Ui::EmptyUserpic> createEmptyUserpic() const;
 	void refreshEmptyUserpic() const;
 
@@ -327,8 +326,10 @@ private:
 	Data::NotifySettings _notify;
 
 	ClickHandlerPtr _openLink;
-	base::flat_set<QString> _nameWords; // for filtering
-	base::flat_set<QChar> _nameFirstLetters;
+	mutable Text _nameText;
+	mutable base::flat_set<QString> _nameWords; // for filtering
+	mutable base::flat_set<QChar> _nameFirstLetters;
+	mutable bool _nameWordsValid = false;
 
 	crl::time _lastFullUpdate = 0;
 	MsgId _pinnedMessageId = 0;
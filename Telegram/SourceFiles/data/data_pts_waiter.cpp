@@ -89,7 +89,9 @@ bool PtsWaiter::updated(ChannelData *channel, int32 pts, int32 count, const MTPU
 	} else if (check(channel, pts, count)) {
 		return true;
 	}
-	_updateQueue.insert(ptsKey(SkippedUpdate, pts), update);
+
+	// Updates from a difference response may wait here for a long time.
+	_updateQueue.insert(ptsKey(SkippedUpdate, pts), MTP::Detach(update));
 	return false;
 }
 
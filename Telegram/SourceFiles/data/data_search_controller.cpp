@@ -10,8 +10,10 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "data/data_session.h"
 #include "data/data_messages.h"
 #include "data/data_channel.h"
+#include "data/data_search_index.h"
 #include "history/history.h"
 #include "history/history_item.h"
+#include "history/view/history_view_element.h"
 
 namespace Api {
 namespace {
@@ -198,6 +200,12 @@ void SearchController::setQuery(const Query &query) {
 		_current = _cache.emplace(
 			query,
 			std::make_unique<CacheEntry>(query)).first;
+		if (!query.query.isEmpty()) {
+			addLocalResults(query, &_current->second->peerData);
+			if (auto &migrated = _current->second->migratedData) {
+				addLocalResults(query, &*migrated);
+			}
+		}
 	}
 }
 
@@ -368,6 +376,61 @@ void SearchController::requestMore(
 	});
 }
 
+void SearchController::addLocalResults(
+		const Query &query,
+		Data *listData) {
+	const auto peer = listData->peer;
+	const auto history = peer->owner().historyLoaded(peer);
+	if (!history || history->isEmpty() || !history->loadedAtBottom()) {
+		return;
+	}
+
+	// Loaded messages have no gaps from the first one to the bottom,
+	// so the local results in that range are shown right away.
+	const auto from = history->loadedAtTop()
+		? 0
+		: history->blocks.front()->messages.front()->data()->id;
+	if (from && !IsServerMsgId(from)) {
+		return;
+	}
+	auto till = MsgId(0);
+	for (auto i = history->blocks.crbegin(); !till && i != history->blocks.crend(); ++i) {
+		const auto &messages = (*i)->messages;
+		for (auto j = messages.crbegin(); j != messages.crend(); ++j) {
+			if (const auto id = (*j)->data()->id; IsServerMsgId(id)) {
+				till = id;
+				break;
+			}
+		}
+	}
+	if (till < from) {
+		return;
+	}
+	auto ids = std::vector<MsgId>();
+	const auto items = peer->owner().searchIndex().search(
+		query.query,
+		peer,
+		0);
+	for (const auto item : items) {
+		if ((item->id >= from)
+			&& (item->id <= till)
+			&& ((query.type == Storage::SharedMediaType::kCount)
+				|| item->sharedMediaTypes().test(query.type))) {
+			ids.push_back(item->id);
+		}
+	}
+
+	ranges::sort(ids);
+	listData->list.addSlice(std::move(ids), { from, till }, std::nullopt);
+
+	// The server may find more, for example by file names,
+	// so the newest results are requested anyway and merged.
+	requestMore(
+		{ ServerMaxMsgId, ::Data::LoadDirection::Before },
+		query,
+		listData);
+}
+
 DelayedSearchController::DelayedSearchController() {
 	_timer.setCallback([this] { setQueryFast(_nextQuery); });
 }
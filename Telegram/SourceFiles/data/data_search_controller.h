@@ -122,6 +122,7 @@ private:
 		const SparseIdsSliceBuilder::AroundData &key,
 		const Query &query,
 		Data *listData);
+	void addLocalResults(const Query &query, Data *listData);
 
 	Cache _cache;
 	Cache::iterator _current = _cache.end();
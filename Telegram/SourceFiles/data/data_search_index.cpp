@@ -0,0 +1,127 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "data/data_search_index.h"
+
+#include "history/history.h"
+#include "history/history_item.h"
+
+namespace Data {
+namespace {
+
+// Long texts are indexed only by their first unique words.
+constexpr auto kMaxWordsInItem = 256;
+constexpr auto kMaxWordLength = 64;
+
+} // namespace
+
+void SearchIndex::add(not_null<HistoryItem*> item, const QString &text) {
+	removeWords(item);
+
+	auto words = TextUtilities::PrepareSearchWords(text);
+	words.removeDuplicates();
+	words.erase(
+		ranges::remove_if(words, [](const QString &word) {
+			return (word.size() > kMaxWordLength);
+		}),
+		words.end());
+	if (words.isEmpty()) {
+		return;
+	}
+	if (words.size() > kMaxWordsInItem) {
+		words.erase(words.begin() + kMaxWordsInItem, words.end());
+	}
+	for (const auto &word : words) {
+		_items[word].emplace(item);
+	}
+	_words.emplace(item, std::move(words));
+}
+
+void SearchIndex::remove(not_null<const HistoryItem*> item) {
+	removeWords(item);
+}
+
+void SearchIndex::removeWords(not_null<const HistoryItem*> item) {
+	const auto i = _words.find(item);
+	if (i == end(_words)) {
+		return;
+	}
+	for (const auto &word : i->second) {
+		const auto j = _items.find(word);
+		if (j != end(_items)) {
+			j->second.erase(const_cast<HistoryItem*>(item.get()));
+			if (j->second.empty()) {
+				_items.erase(j);
+			}
+		}
+	}
+	_words.erase(i);
+}
+
+bool SearchIndex::hasWord(
+		not_null<const HistoryItem*> item,
+		const QString &prefix) const {
+	const auto i = _words.find(item);
+	if (i == end(_words)) {
+		return false;
+	}
+	return ranges::find_if(i->second, [&](const QString &word) {
+		return word.startsWith(prefix);
+	}) != i->second.end();
+}
+
+std::vector<not_null<HistoryItem*>> SearchIndex::search(
+		const QString &query,
+		PeerData *peer,
+		int limit) const {
+	const auto words = TextUtilities::PrepareSearchWords(query);
+	if (words.isEmpty()) {
+		return {};
+	}
+
+	// The longest word should have the least candidates.
+	const auto &longest = *ranges::max_element(
+		words,
+		ranges::less(),
+		&QString::size);
+	auto candidates = std::vector<not_null<HistoryItem*>>();
+	for (auto i = _items.lower_bound(longest); i != end(_items); ++i) {
+		if (!i->first.startsWith(longest)) {
+			break;
+		}
+		for (const auto item : i->second) {
+			if (IsServerMsgId(item->id)
+				&& (!peer || item->history()->peer == peer)) {
+				candidates.push_back(item);
+			}
+		}
+	}
+
+	// An item is found once for each of its words with the prefix.
+	ranges::sort(candidates);
+	candidates.erase(
+		std::unique(candidates.begin(), candidates.end()),
+		candidates.end());
+
+	auto sorted = std::vector<not_null<HistoryItem*>>();
+	for (const auto item : candidates) {
+		const auto good = ranges::find_if(words, [&](const QString &word) {
+			return !hasWord(item, word);
+		}) == words.end();
+		if (good) {
+			sorted.push_back(item);
+		}
+	}
+	ranges::sort(sorted, ranges::greater(), [](not_null<HistoryItem*> item) {
+		return std::make_pair(item->date(), item->id);
+	});
+	if (limit > 0 && int(sorted.size()) > limit) {
+		sorted.erase(sorted.begin() + limit, sorted.end());
+	}
+	return sorted;
+}
+
+} // namespace Data
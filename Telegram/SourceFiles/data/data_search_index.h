@@ -0,0 +1,40 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+class HistoryItem;
+class PeerData;
+
+namespace Data {
+
+// Inverted index of the text of all the messages in memory, both loaded
+// from the server and from the local history cache, so that search
+// results can be shown before the server answers or without connection.
+class SearchIndex final {
+public:
+	void add(not_null<HistoryItem*> item, const QString &text);
+	void remove(not_null<const HistoryItem*> item);
+
+	// Server messages containing words starting with each of the query
+	// words, sorted from the newest one.
+	[[nodiscard]] std::vector<not_null<HistoryItem*>> search(
+		const QString &query,
+		PeerData *peer,
+		int limit) const;
+
+private:
+	void removeWords(not_null<const HistoryItem*> item);
+	[[nodiscard]] bool hasWord(
+		not_null<const HistoryItem*> item,
+		const QString &prefix) const;
+
+	std::map<QString, std::unordered_set<HistoryItem*>> _items;
+	std::unordered_map<const HistoryItem*, QStringList> _words;
+
+};
+
+} // namespace Data
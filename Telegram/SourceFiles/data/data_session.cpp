@@ -23,6 +23,8 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "inline_bots/inline_bot_layout_item.h"
 #include "storage/localstorage.h"
 #include "storage/storage_encrypted_file.h"
+#include "storage/storage_history_cache.h"
+#include "chat_helpers/stickers_raster_cache.h"
 #include "boxes/abstract_box.h"
 #include "passport/passport_form_controller.h"
 #include "window/themes/window_theme.h"
@@ -39,6 +41,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "data/data_game.h"
 #include "mainwidget.h"
 #include "data/data_poll.h"
+#include "data/data_search_index.h"
 #include "styles/style_boxes.h" // for st::backgroundSize
 
 namespace Data {
@@ -148,6 +151,9 @@ Session::Session(not_null<AuthSession*> session)
 , _bigFileCache(Core::App().databases().get(
 	Local::cacheBigFilePath(),
 	Local::cacheBigFileSettings()))
+, _historyCache(std::make_unique<Storage::HistoryCache>(this))
+, _searchIndex(std::make_unique<SearchIndex>())
+, _stickerRasters(std::make_unique<Stickers::RasterCache>(this))
 , _selfDestructTimer([=] { checkSelfDestructItems(); })
 , _a_sendActions(animation(this, &Session::step_typings))
 , _groups(this)
@@ -157,6 +163,7 @@ Session::Session(not_null<AuthSession*> session)
 
 	setupContactViewsViewer();
 	setupChannelLeavingViewer();
+	setupPeerFingerprintsViewer();
 }
 
 void Session::clear() {
@@ -171,24 +178,36 @@ void Session::clear() {
 	App::historyClearItems();
 }
 
+void Session::PeerDeleter::operator()(PeerData *peer) const {
+	// Arena memory starts at the most derived object.
+	const auto memory = dynamic_cast<void*>(peer);
+	peer->~PeerData();
+	base::chunked_arena::deallocate(memory);
+}
+
+template <typename Type>
+auto Session::createPeer(PeerId id) -> PeerPointer {
+	const auto memory = _peersArena.allocate(sizeof(Type));
+	return PeerPointer(new (memory) Type(this, id));
+}
+
 not_null<PeerData*> Session::peer(PeerId id) {
-	const auto i = _peers.find(id);
-	if (i != _peers.cend()) {
-		return i->second.get();
+	if (const auto i = _peers.find(id)) {
+		return i->get();
 	}
-	auto result = [&]() -> std::unique_ptr<PeerData> {
+	auto result = [&] {
 		if (peerIsUser(id)) {
-			return std::make_unique<UserData>(this, id);
+			return createPeer<UserData>(id);
 		} else if (peerIsChat(id)) {
-			return std::make_unique<ChatData>(this, id);
+			return createPeer<ChatData>(id);
 		} else if (peerIsChannel(id)) {
-			return std::make_unique<ChannelData>(this, id);
+			return createPeer<ChannelData>(id);
 		}
 		Unexpected("Peer id type.");
 	}();
 
 	result->input = MTPinputPeer(MTP_inputPeerEmpty());
-	return _peers.emplace(id, std::move(result)).first->second.get();
+	return _peers.emplace(id, std::move(result)).first->get();
 }
 
 not_null<UserData*> Session::user(UserId id) {
@@ -205,12 +224,12 @@ not_null<ChannelData*> Session::channel(ChannelId id) {
 
 PeerData *Session::peerLoaded(PeerId id) const {
 	const auto i = _peers.find(id);
-	if (i == end(_peers)) {
+	if (!i) {
 		return nullptr;
-	} else if (i->second->loadedStatus != PeerData::FullLoaded) {
+	} else if ((*i)->loadedStatus != PeerData::FullLoaded) {
 		return nullptr;
 	}
-	return i->second.get();
+	return i->get();
 }
 
 UserData *Session::userLoaded(UserId id) const {
@@ -623,7 +642,16 @@ not_null<PeerData*> Session::processChat(const MTPChat &data) {
 UserData *Session::processUsers(const MTPVector<MTPUser> &data) {
 	auto result = (UserData*)nullptr;
 	for (const auto &user : data.v) {
-		result = processUser(user);
+		const auto id = peerFromUser(user.match([](const auto &data) {
+			return data.vid.v;
+		}));
+		const auto fingerprint = MTP::Fingerprint(user);
+		if (peerUnchanged(id, fingerprint)) {
+			result = this->user(peerToUser(id));
+		} else {
+			result = processUser(user);
+			rememberPeerFingerprint(id, fingerprint);
+		}
 	}
 	return result;
 }
@@ -631,23 +659,59 @@ UserData *Session::processUsers(const MTPVector<MTPUser> &data) {
 PeerData *Session::processChats(const MTPVector<MTPChat> &data) {
 	auto result = (PeerData*)nullptr;
 	for (const auto &chat : data.v) {
-		result = processChat(chat);
+		const auto id = chat.match([](const MTPDchat &data) {
+			return peerFromChat(data.vid.v);
+		}, [](const MTPDchatForbidden &data) {
+			return peerFromChat(data.vid.v);
+		}, [](const MTPDchatEmpty &data) {
+			return peerFromChat(data.vid.v);
+		}, [](const auto &data) {
+			return peerFromChannel(data.vid.v);
+		});
+		const auto fingerprint = MTP::Fingerprint(chat);
+		if (peerUnchanged(id, fingerprint)) {
+			result = peer(id);
+		} else {
+			result = processChat(chat);
+			rememberPeerFingerprint(id, fingerprint);
+		}
 	}
 	return result;
 }
 
+bool Session::peerUnchanged(PeerId id, uint64 fingerprint) const {
+	const auto i = _peerFingerprints.find(id);
+	return (i != end(_peerFingerprints)) && (i->second == fingerprint);
+}
+
+void Session::rememberPeerFingerprint(PeerId id, uint64 fingerprint) {
+	// If the peer was changed by this object, the delayed peer update
+	// will erase the fingerprint, so only unchanged peers are skipped.
+	_peerFingerprints[id] = fingerprint;
+}
+
+void Session::setupPeerFingerprintsViewer() {
+	Notify::PeerUpdateViewer(
+		Notify::PeerUpdate::Flags::from_raw(~0U)
+	) | rpl::start_with_next([=](const Notify::PeerUpdate &update) {
+		_peerFingerprints.erase(update.peer->id);
+	}, _lifetime);
+}
+
 void Session::applyMaximumChatVersions(const MTPVector<MTPChat> &data) {
 	for (const auto &chat : data.v) {
 		chat.match([&](const MTPDchat &data) {
 			if (const auto chat = chatLoaded(data.vid.v)) {
 				if (data.vversion.v < chat->version()) {
 					chat->setVersion(data.vversion.v);
+					_peerFingerprints.erase(chat->id);
 				}
 			}
 		}, [&](const MTPDchannel &data) {
 			if (const auto channel = channelLoaded(data.vid.v)) {
 				if (data.vversion.v < channel->version()) {
 					channel->setVersion(data.vversion.v);
+					_peerFingerprints.erase(channel->id);
 				}
 			}
 		}, [](const auto &) {
@@ -655,6 +719,10 @@ void Session::applyMaximumChatVersions(const MTPVector<MTPChat> &data) {
 	}
 }
 
+QString Session::internedString(const QString &value) {
+	return *_internedStrings.insert(value);
+}
+
 PeerData *Session::peerByUsername(const QString &username) const {
 	const auto uname = username.trimmed();
 	for (const auto &[peerId, peer] : _peers) {
@@ -754,6 +822,18 @@ Storage::Cache::Database &Session::cacheBigFile() {
 	return *_bigFileCache;
 }
 
+Storage::HistoryCache &Session::historyCache() {
+	return *_historyCache;
+}
+
+SearchIndex &Session::searchIndex() {
+	return *_searchIndex;
+}
+
+Stickers::RasterCache &Session::stickerRasters() {
+	return *_stickerRasters;
+}
+
 void Session::startExport(PeerData *peer) {
 	startExport(peer ? peer->input : MTP_inputPeerEmpty());
 }
@@ -1088,6 +1168,7 @@ rpl::producer<not_null<HistoryItem*>> Session::animationPlayInlineRequest() cons
 void Session::notifyItemRemoved(not_null<const HistoryItem*> item) {
 	_itemRemoved.fire_copy(item);
 	groups().unregisterMessage(item);
+	_searchIndex->remove(item);
 }
 
 rpl::producer<not_null<const HistoryItem*>> Session::itemRemoved() const {
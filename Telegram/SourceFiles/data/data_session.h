@@ -13,6 +13,8 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "data/data_notify_settings.h"
 #include "history/history_location_manager.h"
 #include "base/timer.h"
+#include "base/chunked_arena.h"
+#include "base/id_map.h"
 
 class Image;
 class HistoryItem;
@@ -40,6 +42,14 @@ class PanelController;
 } // namespace View
 } // namespace Export
 
+namespace Storage {
+class HistoryCache;
+} // namespace Storage
+
+namespace Stickers {
+class RasterCache;
+} // namespace Stickers
+
 namespace Passport {
 struct SavedCredentials;
 } // namespace Passport
@@ -47,6 +57,7 @@ struct SavedCredentials;
 namespace Data {
 
 class Feed;
+class SearchIndex;
 enum class FeedUpdateFlag;
 struct FeedUpdate;
 
@@ -84,6 +95,9 @@ public:
 
 	[[nodiscard]] Storage::Cache::Database &cache();
 	[[nodiscard]] Storage::Cache::Database &cacheBigFile();
+	[[nodiscard]] Storage::HistoryCache &historyCache();
+	[[nodiscard]] SearchIndex &searchIndex();
+	[[nodiscard]] Stickers::RasterCache &stickerRasters();
 
 	[[nodiscard]] not_null<PeerData*> peer(PeerId id);
 	[[nodiscard]] not_null<PeerData*> peer(UserId id) = delete;
@@ -107,11 +121,16 @@ public:
 	not_null<PeerData*> processChat(const MTPChat &data);
 
 	// Returns last user, if there were any.
+	// Users and chats received unchanged since last time are skipped.
 	UserData *processUsers(const MTPVector<MTPUser> &data);
 	PeerData *processChats(const MTPVector<MTPChat> &data);
 
 	void applyMaximumChatVersions(const MTPVector<MTPChat> &data);
 
+	// Shares the data of equal strings, like first names and name words
+	// that are repeated in thousands of users.
+	[[nodiscard]] QString internedString(const QString &value);
+
 	void enumerateUsers(Fn<void(not_null<UserData*>)> action) const;
 	void enumerateGroups(Fn<void(not_null<PeerData*>)> action) const;
 	void enumerateChannels(Fn<void(not_null<ChannelData*>)> action) const;
@@ -553,10 +572,22 @@ public:
 	void clearLocalStorage();
 
 private:
+	struct PeerDeleter {
+		void operator()(PeerData *peer) const;
+	};
+	using PeerPointer = std::unique_ptr<PeerData, PeerDeleter>;
+
 	void suggestStartExport();
 
+	template <typename Type>
+	[[nodiscard]] PeerPointer createPeer(PeerId id);
+
 	void setupContactViewsViewer();
 	void setupChannelLeavingViewer();
+	void setupPeerFingerprintsViewer();
+
+	[[nodiscard]] bool peerUnchanged(PeerId id, uint64 fingerprint) const;
+	void rememberPeerFingerprint(PeerId id, uint64 fingerprint);
 
 	void checkSelfDestructItems();
 	int computeUnreadBadge(
@@ -677,6 +708,9 @@ private:
 
 	Storage::DatabasePointer _cache;
 	Storage::DatabasePointer _bigFileCache;
+	std::unique_ptr<Storage::HistoryCache> _historyCache;
+	std::unique_ptr<SearchIndex> _searchIndex;
+	std::unique_ptr<Stickers::RasterCache> _stickerRasters;
 
 	std::unique_ptr<Export::Controller> _export;
 	std::unique_ptr<Export::View::PanelController> _exportPanel;
@@ -776,6 +810,10 @@ private:
 	std::unordered_map<
 		UserId,
 		base::flat_set<not_null<ViewElement*>>> _contactViews;
+
+	// Fingerprints of the MTPUser and MTPChat objects last applied to the
+	// peers, erased when anything in the peer changes after that.
+	std::unordered_map<PeerId, uint64> _peerFingerprints;
 	base::flat_map<
 		not_null<::Media::Clip::Reader*>,
 		not_null<ViewElement*>> _autoplayAnimations;
@@ -808,7 +846,11 @@ private:
 	std::unordered_set<not_null<const PeerData*>> _mutedPeers;
 	base::Timer _unmuteByFinishedTimer;
 
-	std::unordered_map<PeerId, std::unique_ptr<PeerData>> _peers;
+	// Peers are never destroyed before the session, so they are packed
+	// together in arena chunks instead of separate heap blocks.
+	base::chunked_arena _peersArena;
+	base::id_map<PeerId, PeerPointer> _peers;
+	QSet<QString> _internedStrings;
 	std::unordered_map<PeerId, std::unique_ptr<History>> _histories;
 
 	MessageIdsList _mimeForwardIds;
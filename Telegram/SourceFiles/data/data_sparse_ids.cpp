@@ -198,17 +198,30 @@ bool SparseIdsSliceBuilder::applyUpdate(
 	if (!needMergeMessages && !update.count) {
 		return false;
 	}
-	auto skippedBefore = (update.range.from == 0)
-		? 0
-		: std::optional<int> {};
-	auto skippedAfter = (update.range.till == ServerMaxMsgId)
-		? 0
-		: std::optional<int> {};
+
+	auto ids = std::vector<MsgId>();
+	auto skippedBefore = std::optional<int>();
+	auto skippedAfter = std::optional<int>();
+	if (needMergeMessages && _key) {
+		// Take only the ids that can get inside our limits,
+		// the slice may be very large.
+		const auto &messages = *update.messages;
+		const auto position = messages.lower_bound_index(_key);
+		const auto from = std::max(position - _limitBefore, 0);
+		const auto till = std::min(
+			position + _limitAfter + 1,
+			messages.size());
+		ids = messages.slice(from, till);
+		if (update.range.from == 0) {
+			skippedBefore = from;
+		}
+		if (update.range.till == ServerMaxMsgId) {
+			skippedAfter = messages.size() - till;
+		}
+	}
 	mergeSliceData(
 		update.count,
-		needMergeMessages
-			? *update.messages
-			: base::flat_set<MsgId> {},
+		base::flat_set<MsgId>(ids.begin(), ids.end()),
 		skippedBefore,
 		skippedAfter);
 	return true;
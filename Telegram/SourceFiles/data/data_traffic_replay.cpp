@@ -0,0 +1,300 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "data/data_traffic_replay.h"
+
+#include "data/data_session.h"
+#include "mtproto/traffic_recorder.h"
+#include "history/history.h"
+#include "base/timer.h"
+#include "auth_session.h"
+
+#include <chrono>
+
+namespace Data {
+namespace {
+
+struct Stats {
+	std::vector<int64> latencies;
+	int skipped = 0;
+	uint64 objects = 0;
+	int64 busy = 0;
+};
+
+class Replay final {
+public:
+	Replay(std::vector<MTP::RecordedPacket> &&packets, float64 speed);
+
+	void start();
+
+private:
+	void applyNext();
+	void scheduleNext();
+	void finish();
+
+	std::vector<MTP::RecordedPacket> _packets;
+	float64 _speed = 0.;
+	std::size_t _next = 0;
+	crl::time _started = 0;
+	base::Timer _timer;
+	Stats _stats;
+
+};
+
+std::unique_ptr<Replay> GlobalReplay;
+int64 LoadingId = 0;
+
+int64 Now() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ApplyMessages(
+		const MTPVector<MTPUser> &users,
+		const MTPVector<MTPChat> &chats,
+		const MTPVector<MTPMessage> &messages) {
+	Auth().data().processUsers(users);
+	Auth().data().processChats(chats);
+	App::feedMsgs(messages, NewMessageExisting);
+}
+
+void ApplyUpdates(const QVector<MTPUpdate> &updates) {
+	auto messages = QVector<MTPMessage>();
+	for (const auto &update : updates) {
+		switch (update.type()) {
+		case mtpc_updateNewMessage:
+			messages.push_back(update.c_updateNewMessage().vmessage);
+			break;
+		case mtpc_updateNewChannelMessage:
+			messages.push_back(update.c_updateNewChannelMessage().vmessage);
+			break;
+		}
+	}
+	if (!messages.isEmpty()) {
+		App::feedMsgs(messages, NewMessageExisting);
+	}
+}
+
+void ApplyUpdates(
+		const MTPVector<MTPUser> &users,
+		const MTPVector<MTPChat> &chats,
+		const MTPVector<MTPMessage> &messages,
+		const MTPVector<MTPUpdate> &updates) {
+	ApplyMessages(users, chats, messages);
+	ApplyUpdates(updates.v);
+}
+
+// Returns false if the packet has nothing the replay could apply.
+bool Apply(const mtpBuffer &data) {
+	auto from = data.constData();
+	const auto end = from + data.size();
+	if (from == end) {
+		return false;
+	}
+	switch (mtpTypeId(*from)) {
+	case mtpc_updates:
+	case mtpc_updatesCombined: {
+		auto updates = MTPUpdates();
+		updates.read(from, end);
+		updates.match([](const MTPDupdates &data) {
+			Auth().data().processUsers(data.vusers);
+			Auth().data().processChats(data.vchats);
+			ApplyUpdates(data.vupdates.v);
+		}, [](const MTPDupdatesCombined &data) {
+			Auth().data().processUsers(data.vusers);
+			Auth().data().processChats(data.vchats);
+			ApplyUpdates(data.vupdates.v);
+		}, [](const auto &data) {
+		});
+	} return true;
+
+	case mtpc_updates_difference:
+	case mtpc_updates_differenceSlice: {
+		auto difference = MTPupdates_Difference();
+		difference.read(from, end);
+		difference.match([](const MTPDupdates_difference &data) {
+			ApplyUpdates(
+				data.vusers,
+				data.vchats,
+				data.vnew_messages,
+				data.vother_updates);
+		}, [](const MTPDupdates_differenceSlice &data) {
+			ApplyUpdates(
+				data.vusers,
+				data.vchats,
+				data.vnew_messages,
+				data.vother_updates);
+		}, [](const auto &data) {
+		});
+	} return true;
+
+	case mtpc_updates_channelDifference:
+	case mtpc_updates_channelDifferenceTooLong: {
+		auto difference = MTPupdates_ChannelDifference();
+		difference.read(from, end);
+		difference.match([](const MTPDupdates_channelDifference &data) {
+			ApplyUpdates(
+				data.vusers,
+				data.vchats,
+				data.vnew_messages,
+				data.vother_updates);
+		}, [](const MTPDupdates_channelDifferenceTooLong &data) {
+			ApplyMessages(data.vusers, data.vchats, data.vmessages);
+		}, [](const auto &data) {
+		});
+	} return true;
+
+	case mtpc_messages_messages:
+	case mtpc_messages_messagesSlice:
+	case mtpc_messages_channelMessages: {
+		auto messages = MTPmessages_Messages();
+		messages.read(from, end);
+		messages.match([](const MTPDmessages_messagesNotModified &data) {
+		}, [](const auto &data) {
+			ApplyMessages(data.vusers, data.vchats, data.vmessages);
+		});
+	} return true;
+
+	case mtpc_messages_dialogs:
+	case mtpc_messages_dialogsSlice: {
+		auto dialogs = MTPmessages_Dialogs();
+		dialogs.read(from, end);
+		dialogs.match([](const MTPDmessages_dialogsNotModified &data) {
+		}, [](const auto &data) {
+			ApplyMessages(data.vusers, data.vchats, data.vmessages);
+		});
+	} return true;
+	}
+	return false;
+}
+
+int64 Percentile(const std::vector<int64> &sorted, int percent) {
+	return sorted.empty()
+		? 0
+		: sorted[(sorted.size() - 1) * percent / 100];
+}
+
+Replay::Replay(std::vector<MTP::RecordedPacket> &&packets, float64 speed)
+: _packets(std::move(packets))
+, _speed(speed)
+, _timer([=] { applyNext(); }) {
+	_stats.latencies.reserve(_packets.size());
+}
+
+void Replay::start() {
+	LOG(("Traffic Replay: started, %1 packets, speed %2."
+		).arg(_packets.size()
+		).arg(_speed));
+	_started = crl::now();
+	scheduleNext();
+}
+
+void Replay::scheduleNext() {
+	if (_next == _packets.size()) {
+		finish();
+		return;
+	}
+	const auto delay = (_speed > 0.)
+		? (_started
+			+ crl::time(_packets[_next].time / _speed)
+			- crl::now())
+		: crl::time(0);
+	_timer.callOnce(std::max(delay, crl::time(0)));
+}
+
+void Replay::applyNext() {
+	if (!AuthSession::Exists()) {
+		LOG(("Traffic Replay: stopped, the session was closed."));
+		crl::on_main([] {
+			StopTrafficReplay();
+		});
+		return;
+	}
+	const auto &packet = _packets[_next++];
+	const auto objects = MTP::internal::CountAllocatedObjects();
+	const auto start = Now();
+	auto applied = false;
+	try {
+		applied = Apply(packet.data);
+	} catch (Exception &e) {
+		LOG(("Traffic Replay Error: could not parse a packet, %1"
+			).arg(e.what()));
+	}
+	const auto latency = Now() - start;
+	_stats.busy += latency;
+	_stats.objects += MTP::internal::CountAllocatedObjects() - objects;
+	if (applied) {
+		_stats.latencies.push_back(latency);
+	} else {
+		++_stats.skipped;
+	}
+	scheduleNext();
+}
+
+void Replay::finish() {
+	const auto wall = std::max(crl::now() - _started, crl::time(1));
+	auto &latencies = _stats.latencies;
+	ranges::sort(latencies);
+	const auto total = ranges::accumulate(latencies, int64(0));
+	const auto count = std::max(int(latencies.size()), 1);
+	LOG(("Traffic Replay: finished, "
+		"%1 packets applied, %2 skipped, in %3 ms; "
+		"main thread busy %4 ms (%5%); "
+		"latency avg %6 ms, p50 %7 ms, p99 %8 ms, max %9 ms; "
+		"TL objects allocated %10."
+		).arg(latencies.size()
+		).arg(_stats.skipped
+		).arg(wall
+		).arg(_stats.busy / 1000
+		).arg(_stats.busy / (10 * wall)
+		).arg(total / (1000. * count), 0, 'f', 2
+		).arg(Percentile(latencies, 50) / 1000., 0, 'f', 2
+		).arg(Percentile(latencies, 99) / 1000., 0, 'f', 2
+		).arg((latencies.empty() ? 0 : latencies.back()) / 1000., 0, 'f', 2
+		).arg(_stats.objects));
+
+	// Destroys this.
+	crl::on_main([] {
+		StopTrafficReplay();
+	});
+}
+
+} // namespace
+
+void StartTrafficReplay(const QString &path, float64 speed) {
+	if (!AuthSession::Exists()) {
+		return;
+	}
+	StopTrafficReplay();
+	const auto id = ++LoadingId;
+	crl::async([=] {
+		auto packets = MTP::ReadRecordedTraffic(path);
+		crl::on_main([=, packets = std::move(packets)]() mutable {
+			if (LoadingId != id || !AuthSession::Exists()) {
+				return;
+			} else if (packets.empty()) {
+				LOG(("Traffic Replay Error: nothing to replay in '%1'."
+					).arg(path));
+				return;
+			}
+			GlobalReplay = std::make_unique<Replay>(
+				std::move(packets),
+				speed);
+			GlobalReplay->start();
+		});
+	});
+}
+
+void StopTrafficReplay() {
+	++LoadingId;
+	GlobalReplay = nullptr;
+}
+
+bool TrafficReplayActive() {
+	return (GlobalReplay != nullptr);
+}
+
+} // namespace Data
@@ -0,0 +1,23 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Data {
+
+// Feeds the traffic recorded by MTP::StartRecordingTraffic() back to the
+// data layer of the current session and writes the timings to the log.
+//
+// Started by typing "replaymtp" (recorded speed) or "replaymtpfast" (as
+// fast as possible, yielding to the event loop after each packet) in
+// Settings. Only the users, chats and messages of the packets are applied,
+// pts and other session state is not touched, so recorded messages are
+// added as already existing ones. Use a test account for that.
+void StartTrafficReplay(const QString &path, float64 speed);
+void StopTrafficReplay();
+[[nodiscard]] bool TrafficReplayActive();
+
+} // namespace Data
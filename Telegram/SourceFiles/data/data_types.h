@@ -43,10 +43,13 @@ struct UploadState {
 
 Storage::Cache::Key DocumentCacheKey(int32 dcId, uint64 id);
 Storage::Cache::Key DocumentThumbCacheKey(int32 dcId, uint64 id);
+Storage::Cache::Key DocumentWaveformCacheKey(int32 dcId, uint64 id);
 Storage::Cache::Key StorageCacheKey(const StorageImageLocation &location);
 Storage::Cache::Key WebDocumentCacheKey(const WebFileLocation &location);
 Storage::Cache::Key UrlCacheKey(const QString &location);
 Storage::Cache::Key GeoPointCacheKey(const GeoPointLocation &location);
+Storage::Cache::Key StickerRasterCacheKey(uint64 documentId, QSize size);
+Storage::Cache::Key HistoryCacheKey(uint64 peerId);
 
 constexpr auto kImageCacheTag = uint8(0x01);
 constexpr auto kStickerCacheTag = uint8(0x02);
@@ -109,13 +109,13 @@ void UserData::setName(const QString &newFirstName, const QString &newLastName,
 
 	QString newFullName;
 	if (changeName && newFirstName.trimmed().isEmpty()) {
-		firstName = newLastName;
+		firstName = owner().internedString(newLastName);
 		lastName = QString();
 		newFullName = firstName;
 	} else {
 		if (changeName) {
-			firstName = newFirstName;
-			lastName = newLastName;
+			firstName = owner().internedString(newFirstName);
+			lastName = owner().internedString(newLastName);
 		}
 		newFullName = lastName.isEmpty() ? firstName : lng_full_name(lt_first_name, firstName, lt_last_name, lastName);
 	}
@@ -204,11 +204,18 @@ void UserData::setBotInfo(const MTPBotInfo &info) {
 void UserData::setNameOrPhone(const QString &newNameOrPhone) {
 	if (nameOrPhone != newNameOrPhone) {
 		nameOrPhone = newNameOrPhone;
-		phoneText.setText(
+		_phoneText = Text();
+	}
+}
+
+const Text &UserData::phoneText() const {
+	if (_phoneText.isEmpty() && !nameOrPhone.isEmpty()) {
+		_phoneText.setText(
 			st::msgNameStyle,
 			nameOrPhone,
 			Ui::NameTextOptions());
 	}
+	return _phoneText;
 }
 
 void UserData::madeAction(TimeId when) {
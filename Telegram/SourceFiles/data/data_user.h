@@ -162,7 +162,7 @@ public:
 		return _phone;
 	}
 	QString nameOrPhone;
-	Text phoneText;
+	[[nodiscard]] const Text &phoneText() const;
 	TimeId onlineTill = 0;
 
 	enum class ContactStatus : char {
@@ -216,6 +216,7 @@ private:
 
 	QString _unavailableReason;
 	QString _phone;
+	mutable Text _phoneText;
 	ContactStatus _contactStatus = ContactStatus::PhoneUnknown;
 	BlockStatus _blockStatus = BlockStatus::Unknown;
 	CallsStatus _callsStatus = CallsStatus::Unknown;
@@ -32,7 +32,7 @@ RowsByLetter IndexedList::addToEnd(Key key) {
 			}
 			result.emplace(ch, j->second->addToEnd(key));
 		}
-		performFilter();
+		refilter();
 	}
 	return result;
 }
@@ -60,14 +60,13 @@ void IndexedList::adjustByPos(const RowsByLetter &links) {
 	for (const auto [ch, row] : links) {
 		if (ch == QChar(0)) {
 			_list.adjustByPos(row);
-			performFilter();
 		} else {
 			if (auto it = _index.find(ch); it != _index.cend()) {
 				it->second->adjustByPos(row);
-				performFilter();
 			}
 		}
 	}
+	refilter();
 }
 
 void IndexedList::moveToTop(Key key) {
@@ -77,7 +76,7 @@ void IndexedList::moveToTop(Key key) {
 				it->second->moveToTop(key);
 			}
 		}
-		performFilter();
+		refilter();
 	}
 }
 
@@ -238,8 +237,28 @@ void IndexedList::setFilterTypes(EntryTypes types)
 	}
 }
 
+void IndexedList::startBatch() {
+	_batch = true;
+}
+
+void IndexedList::finishBatch() {
+	_batch = false;
+	if (_filterPending) {
+		performFilter();
+	}
+}
+
+void IndexedList::refilter() {
+	if (_batch) {
+		_filterPending = true;
+	} else {
+		performFilter();
+	}
+}
+
 void IndexedList::performFilter()
 {
+	_filterPending = false;
 	emit performFilterStarted();
 
 	if(_filterTypes == EntryType::All)
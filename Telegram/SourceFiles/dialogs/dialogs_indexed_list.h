@@ -86,6 +86,11 @@ public:
 
 	void performFilter();
 
+	// While a batch of changes is applied the rows are only sorted and
+	// the filtered list is rebuilt once, when the batch is finished.
+	void startBatch();
+	void finishBatch();
+
 	void countUnreadMessages(int *countInFavorite, int *countInGroup, int *countInOneOnOne, int *countInAnnouncement) const;
 	void markAsRead(Dialogs::EntryTypes type);
 
@@ -106,12 +111,15 @@ private:
 	const List& current() const;
 
 	void markAsRead(Row *row);
+	void refilter();
 
 	SortMode _sortMode;
 	List _list, _empty;
 	std::unique_ptr<List> _pFiltered;
 	base::flat_map<QChar, std::unique_ptr<List>> _index;
 	Dialogs::EntryTypes	_filterTypes = Dialogs::EntryType::All;
+	bool _batch = false;
+	bool _filterPending = false;
 
 };
 
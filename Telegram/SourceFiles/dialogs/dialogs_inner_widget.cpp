@@ -13,9 +13,11 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "history/history.h"
 #include "history/history_item.h"
 #include "core/shortcuts.h"
+#include "core/trace.h"
 #include "ui/widgets/buttons.h"
 #include "ui/widgets/popup_menu.h"
 #include "ui/text_options.h"
+#include "ui/paint_stats.h"
 #include "data/data_drafts.h"
 #include "data/data_feed.h"
 #include "data/data_session.h"
@@ -259,6 +261,14 @@ void DialogsInner::paintRegion(Painter &p, const QRegion &region, bool paintingO
 
 	if (!App::main()) return;
 
+	if (Core::TraceEnabled()) {
+		// The launch timeline ends with the first chats list paint.
+		crl::on_main([] { Core::FinishTrace(); });
+	}
+	const auto trace = Core::TraceSpan("DialogsInner::paintRegion");
+	Ui::PaintStats::CountFrame();
+	const auto measure = Ui::PaintStats::Measure("DialogsInner");
+
 	auto r = region.boundingRect();
 	if (!paintingOther) {
 		p.setClipRect(r);
@@ -1315,13 +1325,42 @@ void DialogsInner::createDialog(Dialogs::Key key) {
 		emit dialogMoved(from, to);
 	}
 
-	if (creating) {
+	if (_chatListBatchLevel > 0) {
+		// The scroll position is kept for each move, repaint once.
+		_chatListBatchRefresh |= creating;
+		return;
+	} else if (creating) {
 		refresh();
 	} else if (_state == State::Default && from != to) {
 		update(0, qMin(from, to), getFullWidth(), qAbs(from - to) + st::dialogsRowHeight);
 	}
 }
 
+void DialogsInner::startChatListBatch() {
+	if (!_chatListBatchLevel++) {
+		_dialogs->startBatch();
+		if (_dialogsImportant) {
+			_dialogsImportant->startBatch();
+		}
+	}
+}
+
+void DialogsInner::finishChatListBatch() {
+	Expects(_chatListBatchLevel > 0);
+
+	if (--_chatListBatchLevel) {
+		return;
+	}
+	_dialogs->finishBatch();
+	if (_dialogsImportant) {
+		_dialogsImportant->finishBatch();
+	}
+	if (base::take(_chatListBatchRefresh)) {
+		refresh();
+	}
+	update();
+}
+
 void DialogsInner::removeDialog(Dialogs::Key key) {
 	if (key == _menuRow.key && _menu) {
 		InvokeQueued(this, [=] { _menu = nullptr; });
@@ -1368,7 +1407,9 @@ void DialogsInner::removeDialog(Dialogs::Key key) {
 void DialogsInner::repaintDialogRow(
 		Dialogs::Mode list,
 		not_null<Dialogs::Row*> row) {
-	if (_state == State::Default) {
+	if (_chatListBatchLevel > 0) {
+		return;
+	} else if (_state == State::Default) {
 		if (Global::DialogsMode() == list) {
 			auto position = row->pos();
 			auto top = dialogsOffset();
@@ -1394,6 +1435,9 @@ void DialogsInner::repaintDialogRow(
 }
 
 void DialogsInner::repaintDialogRow(Dialogs::RowDescriptor row) {
+	if (_chatListBatchLevel > 0) {
+		return;
+	}
 	updateDialogRow(row);
 }
 
@@ -2056,6 +2100,24 @@ bool DialogsInner::searchReceived(
 	return lastDateFound != 0;
 }
 
+void DialogsInner::localSearchReceived(
+		const std::vector<not_null<HistoryItem*>> &items) {
+	if (_state != State::Filtered || !_searchResults.empty()) {
+		return;
+	}
+
+	// Server results replace these when they arrive.
+	const auto uniquePeers = uniqueSearchResults();
+	for (const auto item : items) {
+		if (!uniquePeers || !hasHistoryInResults(item->history())) {
+			_searchResults.push_back(
+				std::make_unique<Dialogs::FakeRow>(_searchInChat, item));
+		}
+	}
+	_searchedCount = int(_searchResults.size());
+	refresh();
+}
+
 void DialogsInner::peerSearchReceived(
 		const QString &query,
 		const QVector<MTPPeer> &my,
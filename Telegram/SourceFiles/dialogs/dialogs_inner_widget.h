@@ -40,6 +40,8 @@ public:
 		const QVector<MTPMessage> &result,
 		DialogsSearchRequestType type,
 		int fullCount);
+	void localSearchReceived(
+		const std::vector<not_null<HistoryItem*>> &items);
 	void peerSearchReceived(
 		const QString &query,
 		const QVector<MTPPeer> &my,
@@ -56,6 +58,12 @@ public:
 	void repaintDialogRow(Dialogs::Mode list, not_null<Dialogs::Row*> row);
 	void repaintDialogRow(Dialogs::RowDescriptor row);
 
+	// Inside a batch the chats are only sorted and the scroll position
+	// is kept, the filtered lists are rebuilt and the widget is resized
+	// and repainted once in the end.
+	void startChatListBatch();
+	void finishChatListBatch();
+
 	void dragLeft();
 
 	void clearFilter();
@@ -300,6 +308,9 @@ private:
 	std::unique_ptr<Dialogs::IndexedList> _contactsNoDialogs;
 	std::unique_ptr<Dialogs::IndexedList> _contacts;
 
+	int _chatListBatchLevel = 0;
+	bool _chatListBatchRefresh = false;
+
 	bool _mouseSelection = false;
 	std::optional<QPoint> _lastMousePosition;
 	Qt::MouseButton _pressButton = Qt::LeftButton;
@@ -33,6 +33,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "storage/storage_media_prepare.h"
 #include "storage/localstorage.h"
 #include "data/data_session.h"
+#include "data/data_search_index.h"
 #include "data/data_channel.h"
 #include "data/data_chat.h"
 #include "data/data_user.h"
@@ -339,6 +340,14 @@ void DialogsWidget::repaintDialogRow(Dialogs::RowDescriptor row) {
 	_inner->repaintDialogRow(row);
 }
 
+void DialogsWidget::startChatListBatch() {
+	_inner->startChatListBatch();
+}
+
+void DialogsWidget::finishChatListBatch() {
+	_inner->finishChatListBatch();
+}
+
 void DialogsWidget::dialogsToUp() {
 	if (Auth().supportMode()) {
 		return;
@@ -748,6 +757,7 @@ bool DialogsWidget::onSearchMessages(bool searchCache) {
 				rpcFail(&DialogsWidget::searchFailed, DialogsSearchFromStart));
 		}
 		_searchQueries.insert(_searchRequest, _searchQuery);
+		searchLocal();
 	}
 	if (searchForPeersRequired(q)) {
 		if (searchCache) {
@@ -804,6 +814,25 @@ void DialogsWidget::showMainMenu() {
 	App::wnd()->showMainMenu();
 }
 
+void DialogsWidget::searchLocal() {
+	if (_searchQuery.isEmpty() || _searchInChat.feed()) {
+		return;
+	}
+	auto &index = Auth().data().searchIndex();
+	const auto peer = _searchInChat.peer();
+	auto items = index.search(_searchQuery, peer, SearchPerPage);
+	if (const auto migrated = peer ? peer->migrateFrom() : nullptr) {
+		const auto more = index.search(_searchQuery, migrated, SearchPerPage);
+		items.insert(end(items), more.begin(), more.end());
+	}
+	if (_searchQueryFrom) {
+		items.erase(ranges::remove_if(items, [&](not_null<HistoryItem*> item) {
+			return (item->from() != _searchQueryFrom);
+		}), end(items));
+	}
+	_inner->localSearchReceived(items);
+}
+
 void DialogsWidget::searchMessages(
 		const QString &query,
 		Dialogs::Key inChat) {
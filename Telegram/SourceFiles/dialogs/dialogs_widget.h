@@ -63,6 +63,8 @@ public:
 	void removeDialog(Dialogs::Key key);
 	void repaintDialogRow(Dialogs::Mode list, not_null<Dialogs::Row*> row);
 	void repaintDialogRow(Dialogs::RowDescriptor row);
+	void startChatListBatch();
+	void finishChatListBatch();
 
 	void dialogsToUp();
 
@@ -144,6 +146,7 @@ private:
 		DialogsSearchRequestType type,
 		const MTPmessages_Messages &result,
 		mtpRequestId requestId);
+	void searchLocal();
 	void peerSearchReceived(
 		const MTPcontacts_Found &result,
 		mtpRequestId requestId);
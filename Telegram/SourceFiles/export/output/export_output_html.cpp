@@ -7,18 +7,21 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "export/output/export_output_html.h"
 
 #include "export/output/export_output_result.h"
+#include "export/output/export_output_workers.h"
 #include "export/data/export_data_types.h"
 #include "core/utils.h"
 
 #include <QtCore/QSize>
 #include <QtCore/QFile>
 #include <QtCore/QDateTime>
+#include <QtCore/QThread>
 
 namespace Export {
 namespace Output {
 namespace {
 
 constexpr auto kMessagesInFile = 1000;
+constexpr auto kMaxDialogWorkers = 4;
 constexpr auto kPersonalUserpicSize = 90;
 constexpr auto kEntryUserpicSize = 48;
 constexpr auto kServiceMessagePhotoSize = 60;
@@ -632,6 +635,18 @@ private:
 
 };
 
+struct HtmlWriter::ChatState {
+	Data::DialogInfo dialog;
+	int lane = 0;
+	std::unique_ptr<Wrap> file;
+	bool fileEmpty = true;
+	int messagesCount = 0;
+	int dateMessageId = 0;
+	std::unique_ptr<MessageInfo> lastMessageInfo;
+	std::vector<int> lastMessageIdsPerFile;
+	bool failed = false;
+};
+
 struct HtmlWriter::SavedSection {
 	int priority = 0;
 	QByteArray label;
@@ -2320,6 +2335,16 @@ Result HtmlWriter::writeDialogsStart(const Data::DialogsInfo &data) {
 	_dialogsRelativePath = "lists/chats.html";
 	_chats = fileWithRelativePath(_dialogsRelativePath);
 
+	// Chats are written to separate files, so they can be serialized
+	// while the next ones are downloaded.
+	const auto threads = std::clamp(
+		QThread::idealThreadCount() - 1,
+		0,
+		kMaxDialogWorkers);
+	if (threads > 0) {
+		_workers = std::make_unique<Workers>(threads);
+	}
+
 	auto block = _chats->pushHeader(
 		"Chats",
 		mainFileRelativePath());
@@ -2340,13 +2365,13 @@ Result HtmlWriter::writeDialogsStart(const Data::DialogsInfo &data) {
 Result HtmlWriter::writeDialogStart(const Data::DialogInfo &data) {
 	Expects(_chat == nullptr);
 
-	_chat = fileWithRelativePath(data.relativePath + messagesFile(0));
-	_chatFileEmpty = true;
-	_messagesCount = 0;
-	_dateMessageId = 0;
-	_lastMessageInfo = nullptr;
-	_lastMessageIdsPerFile.clear();
-	_dialog = data;
+	if (const auto result = takeWorkersError(); !result) {
+		return result;
+	}
+	_chat = std::make_unique<ChatState>();
+	_chat->dialog = data;
+	_chat->lane = _dialogIndex++;
+	_chat->file = fileWithRelativePath(data.relativePath + messagesFile(0));
 	return Result::Success();
 }
 
@@ -2354,30 +2379,41 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 	Expects(_chat != nullptr);
 	Expects(!data.list.empty());
 
+	if (!_workers) {
+		return writeChatSlice(*_chat, data);
+	}
+	return postToWorkers([=](ChatState &chat) {
+		return writeChatSlice(chat, data);
+	});
+}
+
+Result HtmlWriter::writeChatSlice(
+		ChatState &chat,
+		const Data::MessagesSlice &data) const {
 	const auto messageLinkWrapper = [&](int messageId, QByteArray text) {
-		return wrapMessageLink(messageId, text);
+		return wrapMessageLink(chat, messageId, text);
 	};
-	auto oldIndex = (_messagesCount > 0)
-		? ((_messagesCount - 1) / kMessagesInFile)
+	auto oldIndex = (chat.messagesCount > 0)
+		? ((chat.messagesCount - 1) / kMessagesInFile)
 		: 0;
-	auto previous = _lastMessageInfo.get();
+	auto previous = chat.lastMessageInfo.get();
 	auto saved = std::optional<MessageInfo>();
 	auto block = QByteArray();
 	for (const auto &message : data.list) {
 		if (Data::SkipMessageByDate(message, _settings)) {
 			continue;
 		}
-		const auto newIndex = (_messagesCount / kMessagesInFile);
+		const auto newIndex = (chat.messagesCount / kMessagesInFile);
 		if (oldIndex != newIndex) {
-			if (const auto result = _chat->writeBlock(block); !result) {
+			if (const auto result = chat.file->writeBlock(block); !result) {
 				return result;
-			} else if (const auto next = switchToNextChatFile(newIndex)) {
-				Assert(saved.has_value() || _lastMessageInfo != nullptr);
-				_lastMessageIdsPerFile.push_back(saved
+			} else if (const auto next = switchToNextChatFile(chat, newIndex)) {
+				Assert(saved.has_value() || chat.lastMessageInfo != nullptr);
+				chat.lastMessageIdsPerFile.push_back(saved
 					? saved->id
-					: _lastMessageInfo->id);
+					: chat.lastMessageInfo->id);
 				block = QByteArray();
-				_lastMessageInfo = nullptr;
+				chat.lastMessageInfo = nullptr;
 				previous = nullptr;
 				saved = std::nullopt;
 				oldIndex = newIndex;
@@ -2385,71 +2421,83 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 				return next;
 			}
 		}
-		if (_chatFileEmpty) {
-			if (const auto result = writeDialogOpening(oldIndex); !result) {
+		if (chat.fileEmpty) {
+			if (const auto result = writeChatOpening(chat, oldIndex); !result) {
 				return result;
 			}
-			_chatFileEmpty = false;
+			chat.fileEmpty = false;
 		}
 		const auto date = message.date;
 		if (DisplayDate(date, previous ? previous->date : 0)) {
-			block.append(_chat->pushServiceMessage(
-				--_dateMessageId,
-				_dialog,
+			block.append(chat.file->pushServiceMessage(
+				--chat.dateMessageId,
+				chat.dialog,
 				_settings.path,
 				FormatDateText(date)));
 		}
-		const auto [info, content] = _chat->pushMessage(
+		const auto [info, content] = chat.file->pushMessage(
 			message,
 			previous,
-			_dialog,
+			chat.dialog,
 			_settings.path,
 			data.peers,
 			_environment.internalLinksDomain,
 			messageLinkWrapper);
 		block.append(content);
 
-		++_messagesCount;
+		++chat.messagesCount;
 		saved = info;
 		previous = &*saved;
 	}
 	if (saved) {
-		_lastMessageInfo = std::make_unique<MessageInfo>(*saved);
+		chat.lastMessageInfo = std::make_unique<MessageInfo>(*saved);
 	}
-	return block.isEmpty() ? Result::Success() : _chat->writeBlock(block);
+	return block.isEmpty() ? Result::Success() : chat.file->writeBlock(block);
 }
 
-Result HtmlWriter::writeEmptySinglePeer() {
-	Expects(_chat != nullptr);
-
-	if (!_settings.onlySinglePeer() || _messagesCount != 0) {
+Result HtmlWriter::writeEmptySinglePeer(ChatState &chat) const {
+	if (!_settings.onlySinglePeer() || chat.messagesCount != 0) {
 		return Result::Success();
 	}
-	Assert(_chatFileEmpty);
-	if (const auto result = writeDialogOpening(0); !result) {
+	Assert(chat.fileEmpty);
+	if (const auto result = writeChatOpening(chat, 0); !result) {
 		return result;
 	}
-	return _chat->writeBlock(_chat->pushServiceMessage(
-		--_dateMessageId,
-		_dialog,
+	return chat.file->writeBlock(chat.file->pushServiceMessage(
+		--chat.dateMessageId,
+		chat.dialog,
 		_settings.path,
 		"No exported messages"));
 }
 
+Result HtmlWriter::closeChat(ChatState &chat) const {
+	if (const auto result = writeEmptySinglePeer(chat); !result) {
+		return result;
+	}
+	return base::take(chat.file)->close();
+}
+
 Result HtmlWriter::writeDialogEnd() {
 	Expects(_settings.onlySinglePeer() || _chats != nullptr);
 	Expects(_chat != nullptr);
 
-	if (const auto result = writeEmptySinglePeer(); !result) {
+	if (_workers) {
+		const auto result = postToWorkers([=](ChatState &chat) {
+			return closeChat(chat);
+		});
+		_closedChats.push_back(base::take(_chat));
 		return result;
 	}
-
-	if (const auto closed = base::take(_chat)->close(); !closed) {
+	const auto chat = base::take(_chat);
+	if (const auto closed = closeChat(*chat); !closed) {
 		return closed;
 	} else if (_settings.onlySinglePeer()) {
 		return Result::Success();
 	}
+	return writeChatsListEntry(*chat);
+}
 
+Result HtmlWriter::writeChatsListEntry(const ChatState &chat) {
 	using Type = Data::DialogInfo::Type;
 	const auto TypeString = [](Type type) {
 		switch (type) {
@@ -2503,26 +2551,26 @@ Result HtmlWriter::writeDialogEnd() {
 			+ (outgoing ? " outgoing messages" : " messages");
 	};
 	auto userpic = UserpicData{
-		(_dialog.type == Type::Self
+		(chat.dialog.type == Type::Self
 			? kSavedMessagesColorIndex
-			: Data::PeerColorIndex(Data::BarePeerId(_dialog.peerId))),
+			: Data::PeerColorIndex(Data::BarePeerId(chat.dialog.peerId))),
 		kEntryUserpicSize
 	};
-	userpic.firstName = NameString(_dialog);
-	userpic.lastName = LastNameString(_dialog);
+	userpic.firstName = NameString(chat.dialog);
+	userpic.lastName = LastNameString(chat.dialog);
 
-	const auto result = validateDialogsMode(_dialog.isLeftChannel);
+	const auto result = validateDialogsMode(chat.dialog.isLeftChannel);
 	if (!result) {
 		return result;
 	}
 
 	return _chats->writeBlock(_chats->pushListEntry(
 		userpic,
-		ComposeName(userpic, DeletedString(_dialog.type)),
-		CountString(_messagesCount, _dialog.onlyMyMessages),
-		TypeString(_dialog.type),
-		(_messagesCount > 0
-			? (_dialog.relativePath + "messages.html")
+		ComposeName(userpic, DeletedString(chat.dialog.type)),
+		CountString(chat.messagesCount, chat.dialog.onlyMyMessages),
+		TypeString(chat.dialog.type),
+		(chat.messagesCount > 0
+			? (chat.dialog.relativePath + "messages.html")
 			: QString())));
 }
 
@@ -2547,32 +2595,74 @@ Result HtmlWriter::validateDialogsMode(bool isLeftChannel) {
 }
 
 Result HtmlWriter::writeDialogsEnd() {
+	if (_workers) {
+		// All the chats are written, add them to the list in order.
+		_workers->wait();
+		_workers = nullptr;
+		if (const auto result = takeWorkersError(); !result) {
+			return result;
+		}
+		for (const auto &chat : base::take(_closedChats)) {
+			if (const auto result = writeChatsListEntry(*chat); !result) {
+				return result;
+			}
+		}
+	}
 	if (_chats) {
 		return base::take(_chats)->close();
 	}
 	return Result::Success();
 }
 
-Result HtmlWriter::writeDialogOpening(int index) {
-	const auto name = (_dialog.name.isEmpty()
-		&& _dialog.lastName.isEmpty())
+Result HtmlWriter::postToWorkers(FnMut<Result(ChatState&)> method) {
+	Expects(_workers != nullptr);
+	Expects(_chat != nullptr);
+
+	if (const auto result = takeWorkersError(); !result) {
+		return result;
+	}
+	const auto chat = _chat.get();
+	_workers->post(chat->lane, [=, method = std::move(method)]() mutable {
+		if (chat->failed) {
+			return;
+		} else if (const auto result = method(*chat); !result) {
+			chat->failed = true;
+			auto lock = std::unique_lock<std::mutex>(_workersErrorMutex);
+			if (!_workersError) {
+				_workersError = result;
+			}
+		}
+	});
+	return Result::Success();
+}
+
+Result HtmlWriter::takeWorkersError() {
+	auto lock = std::unique_lock<std::mutex>(_workersErrorMutex);
+	return _workersError
+		? *base::take(_workersError)
+		: Result::Success();
+}
+
+Result HtmlWriter::writeChatOpening(ChatState &chat, int index) const {
+	const auto name = (chat.dialog.name.isEmpty()
+		&& chat.dialog.lastName.isEmpty())
 		? QByteArray("Deleted Account")
-		: (_dialog.name + ' ' + _dialog.lastName);
-	auto block = _chat->pushHeader(
+		: (chat.dialog.name + ' ' + chat.dialog.lastName);
+	auto block = chat.file->pushHeader(
 		name,
 		_settings.onlySinglePeer() ? QString() : _dialogsRelativePath);
-	block.append(_chat->pushDiv("page_body chat_page"));
-	block.append(_chat->pushDiv("history"));
+	block.append(chat.file->pushDiv("page_body chat_page"));
+	block.append(chat.file->pushDiv("history"));
 	if (index > 0) {
 		const auto previousPath = messagesFile(index - 1);
-		block.append(_chat->pushTag("a", {
+		block.append(chat.file->pushTag("a", {
 			{ "class", "pagination block_link" },
 			{ "href", previousPath.toUtf8() }
 			}));
 		block.append("Previous messages");
-		block.append(_chat->popTag());
+		block.append(chat.file->popTag());
 	}
-	return _chat->writeBlock(block);
+	return chat.file->writeBlock(block);
 }
 
 void HtmlWriter::pushSection(
@@ -2619,12 +2709,15 @@ Result HtmlWriter::writeSections() {
 	return _summary->writeBlock(block);
 }
 
-QByteArray HtmlWriter::wrapMessageLink(int messageId, QByteArray text) {
-	const auto finishedCount = _lastMessageIdsPerFile.size();
-	const auto it = ranges::find_if(_lastMessageIdsPerFile, [&](int maxMessageId) {
+QByteArray HtmlWriter::wrapMessageLink(
+		const ChatState &chat,
+		int messageId,
+		QByteArray text) const {
+	const auto &lastIds = chat.lastMessageIdsPerFile;
+	const auto it = ranges::find_if(lastIds, [&](int maxMessageId) {
 		return messageId <= maxMessageId;
 	});
-	if (it == end(_lastMessageIdsPerFile)) {
+	if (it == end(lastIds)) {
 		return "<a href=\"#go_to_message"
 			+ Data::NumberToString(messageId)
 			+ "\" onclick=\"return GoToMessage("
@@ -2632,7 +2725,7 @@ QByteArray HtmlWriter::wrapMessageLink(int messageId, QByteArray text) {
 			+ ")\">"
 			+ text + "</a>";
 	} else {
-		const auto index = it - begin(_lastMessageIdsPerFile);
+		const auto index = it - begin(lastIds);
 		return "<a href=\"" + messagesFile(index).toUtf8()
 			+ "#go_to_message"
 			+ Data::NumberToString(messageId)
@@ -2642,23 +2735,23 @@ QByteArray HtmlWriter::wrapMessageLink(int messageId, QByteArray text) {
 	}
 }
 
-Result HtmlWriter::switchToNextChatFile(int index) {
-	Expects(_chat != nullptr);
-
+Result HtmlWriter::switchToNextChatFile(
+		ChatState &chat,
+		int index) const {
 	const auto nextPath = messagesFile(index);
-	auto next = _chat->pushTag("a", {
+	auto next = chat.file->pushTag("a", {
 		{ "class", "pagination block_link" },
 		{ "href", nextPath.toUtf8() }
 	});
 	next.append("Next messages");
-	next.append(_chat->popTag());
-	if (const auto result = _chat->writeBlock(next); !result) {
+	next.append(chat.file->popTag());
+	if (const auto result = chat.file->writeBlock(next); !result) {
 		return result;
-	} else if (const auto end = _chat->close(); !end) {
+	} else if (const auto end = chat.file->close(); !end) {
 		return end;
 	}
-	_chat = fileWithRelativePath(_dialog.relativePath + nextPath);
-	_chatFileEmpty = true;
+	chat.file = fileWithRelativePath(chat.dialog.relativePath + nextPath);
+	chat.fileEmpty = true;
 	return Result::Success();
 }
 
@@ -11,6 +11,9 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "export/export_settings.h"
 #include "export/data/export_data_types.h"
 
+#include <mutex>
+#include <optional>
+
 namespace Export {
 namespace Output {
 namespace details {
@@ -39,6 +42,8 @@ struct MediaData;
 
 } // namespace details
 
+class Workers;
+
 class HtmlWriter : public AbstractWriter {
 public:
 	HtmlWriter();
@@ -82,6 +87,7 @@ private:
 	using MediaData = details::MediaData;
 	class Wrap;
 	struct MessageInfo;
+	struct ChatState;
 	enum class DialogsMode {
 		None,
 		Chats,
@@ -105,9 +111,20 @@ private:
 	[[nodiscard]] Result writeWebSessions(const Data::SessionsList &data);
 
 	[[nodiscard]] Result validateDialogsMode(bool isLeftChannel);
-	[[nodiscard]] Result writeDialogOpening(int index);
-	[[nodiscard]] Result switchToNextChatFile(int index);
-	[[nodiscard]] Result writeEmptySinglePeer();
+	[[nodiscard]] Result writeChatsListEntry(const ChatState &chat);
+	[[nodiscard]] Result postToWorkers(FnMut<Result(ChatState&)> method);
+	[[nodiscard]] Result takeWorkersError();
+
+	// These may run on the workers, so they change only the chat state.
+	[[nodiscard]] Result writeChatSlice(
+		ChatState &chat,
+		const Data::MessagesSlice &data) const;
+	[[nodiscard]] Result writeChatOpening(ChatState &chat, int index) const;
+	[[nodiscard]] Result switchToNextChatFile(
+		ChatState &chat,
+		int index) const;
+	[[nodiscard]] Result writeEmptySinglePeer(ChatState &chat) const;
+	[[nodiscard]] Result closeChat(ChatState &chat) const;
 
 	void pushSection(
 		int priority,
@@ -128,8 +145,9 @@ private:
 	[[nodiscard]] QString userpicsFilePath() const;
 
 	[[nodiscard]] QByteArray wrapMessageLink(
+		const ChatState &chat,
 		int messageId,
-		QByteArray text);
+		QByteArray text) const;
 
 	Settings _settings;
 	Environment _environment;
@@ -149,16 +167,18 @@ private:
 	std::unique_ptr<Wrap> _userpics;
 
 	QString _dialogsRelativePath;
-	Data::DialogInfo _dialog;
 	DialogsMode _dialogsMode = DialogsMode::None;
 
-	int _messagesCount = 0;
-	std::unique_ptr<MessageInfo> _lastMessageInfo;
-	int _dateMessageId = 0;
 	std::unique_ptr<Wrap> _chats;
-	std::unique_ptr<Wrap> _chat;
-	std::vector<int> _lastMessageIdsPerFile;
-	bool _chatFileEmpty = false;
+	std::unique_ptr<ChatState> _chat;
+	std::vector<std::unique_ptr<ChatState>> _closedChats;
+	int _dialogIndex = 0;
+
+	std::mutex _workersErrorMutex;
+	std::optional<Result> _workersError;
+
+	// Destroyed first, so that no task uses the members after that.
+	std::unique_ptr<Workers> _workers;
 
 };
 
@@ -0,0 +1,121 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "export/output/export_output_workers.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace Export {
+namespace Output {
+namespace {
+
+constexpr auto kMaxWaitingTasks = std::size_t(16);
+
+} // namespace
+
+class Workers::Thread {
+public:
+	Thread();
+	~Thread();
+
+	void post(FnMut<void()> task);
+	void wait();
+
+private:
+	void run();
+
+	std::mutex _mutex;
+	std::condition_variable _changed;
+	std::deque<FnMut<void()>> _tasks;
+	bool _running = false;
+	bool _finishing = false;
+	std::thread _thread;
+
+};
+
+Workers::Thread::Thread() : _thread([=] { run(); }) {
+}
+
+Workers::Thread::~Thread() {
+	{
+		// Pending tasks of a cancelled export are dropped.
+		auto lock = std::unique_lock<std::mutex>(_mutex);
+		_tasks.clear();
+		_finishing = true;
+	}
+	_changed.notify_all();
+	_thread.join();
+}
+
+void Workers::Thread::post(FnMut<void()> task) {
+	{
+		auto lock = std::unique_lock<std::mutex>(_mutex);
+		_changed.wait(lock, [&] {
+			return (_tasks.size() < kMaxWaitingTasks);
+		});
+		_tasks.push_back(std::move(task));
+	}
+	_changed.notify_all();
+}
+
+void Workers::Thread::wait() {
+	auto lock = std::unique_lock<std::mutex>(_mutex);
+	_changed.wait(lock, [&] {
+		return _tasks.empty() && !_running;
+	});
+}
+
+void Workers::Thread::run() {
+	auto lock = std::unique_lock<std::mutex>(_mutex);
+	while (true) {
+		_changed.wait(lock, [&] {
+			return _finishing || !_tasks.empty();
+		});
+		if (_tasks.empty()) {
+			return;
+		}
+		auto task = std::move(_tasks.front());
+		_tasks.pop_front();
+		_running = true;
+		lock.unlock();
+		_changed.notify_all();
+
+		task();
+
+		lock.lock();
+		_running = false;
+		_changed.notify_all();
+	}
+}
+
+Workers::Workers(int threads) {
+	Expects(threads > 0);
+
+	_threads.reserve(threads);
+	for (auto i = 0; i != threads; ++i) {
+		_threads.push_back(std::make_unique<Thread>());
+	}
+}
+
+Workers::~Workers() = default;
+
+void Workers::post(int lane, FnMut<void()> task) {
+	Expects(lane >= 0);
+
+	_threads[lane % _threads.size()]->post(std::move(task));
+}
+
+void Workers::wait() {
+	for (const auto &thread : _threads) {
+		thread->wait();
+	}
+}
+
+} // namespace Output
+} // namespace Export
@@ -0,0 +1,45 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/basic_types.h"
+
+#include <memory>
+#include <vector>
+
+namespace Export {
+namespace Output {
+
+// A few threads for serializing independent chats at the same time.
+//
+// Tasks posted to one lane run one after another in the posting order,
+// lanes are spread over the threads. Own threads are used instead of
+// crl::async, because the export queue blocks in wait() and post() and
+// must not take a thread from the tasks it is waiting for.
+class Workers {
+public:
+	explicit Workers(int threads);
+	Workers(const Workers &other) = delete;
+	Workers &operator=(const Workers &other) = delete;
+	~Workers();
+
+	// Blocks while the thread of the lane has too many waiting tasks,
+	// so that the downloaded messages don't pile up in memory.
+	void post(int lane, FnMut<void()> task);
+
+	// Blocks until all the posted tasks are done.
+	void wait();
+
+private:
+	class Thread;
+
+	std::vector<std::unique_ptr<Thread>> _threads;
+
+};
+
+} // namespace Output
+} // namespace Export
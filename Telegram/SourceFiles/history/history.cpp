@@ -28,6 +28,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "storage/storage_facade.h"
 #include "storage/storage_shared_media.h"
 #include "storage/storage_feed_messages.h"
+#include "storage/storage_history_cache.h"
 #include "support/support_helper.h"
 #include "data/data_channel_admins.h"
 #include "data/data_feed.h"
@@ -2907,6 +2908,7 @@ QVector<MsgId> History::collectMessagesFromUserToDelete(
 
 void History::clear() {
 	clearBlocks(false);
+	owner().historyCache().remove(peer->id);
 }
 
 void History::unloadBlocks() {
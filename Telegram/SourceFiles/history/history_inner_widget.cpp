@@ -7,6 +7,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "history/history_inner_widget.h"
 
 #include <rpl/merge.h>
+#include <typeinfo>
 #include "styles/style_history.h"
 #include "core/file_utilities.h"
 #include "core/crash_reports.h"
@@ -25,6 +26,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "ui/image/image.h"
 #include "ui/toast/toast.h"
 #include "ui/text_options.h"
+#include "ui/paint_stats.h"
 #include "window/window_controller.h"
 #include "window/window_peer_menu.h"
 #include "boxes/confirm_box.h"
@@ -71,6 +73,16 @@ int BinarySearchBlocksOrItems(const T &list, int edge) {
 	return start;
 }
 
+// Message types are measured by their media classes.
+const char *PaintStatsName(not_null<HistoryView::Element*> view) {
+	if (!Ui::PaintStats::Enabled()) {
+		return nullptr;
+	} else if (const auto media = view->media()) {
+		return typeid(*media).name();
+	}
+	return view->data()->isService() ? "ServiceMessage" : "TextMessage";
+}
+
 } // namespace
 
 // flick scroll taken from http://qt-project.org/doc/qt-4.8/demos-embedded-anomaly-src-flickcharm-cpp.html
@@ -539,6 +551,9 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 		return;
 	}
 
+	Ui::PaintStats::CountFrame();
+	const auto measure = Ui::PaintStats::Measure("HistoryInner");
+
 	Painter p(this);
 	auto clip = e->rect();
 	auto ms = crl::now();
@@ -598,7 +613,11 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 					view,
 					selfromy - mtop,
 					seltoy - mtop);
-				view->draw(p, clip.translated(0, -y), selection, ms);
+				{
+					const auto measure = Ui::PaintStats::Measure(
+						PaintStatsName(view));
+					view->draw(p, clip.translated(0, -y), selection, ms);
+				}
 
 				if (item->hasViews()) {
 					App::main()->scheduleViewIncrement(item);
@@ -644,7 +663,15 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 						view,
 						selfromy - htop,
 						seltoy - htop);
-					view->draw(p, hclip.translated(0, -y), selection, ms);
+					{
+						const auto measure = Ui::PaintStats::Measure(
+							PaintStatsName(view));
+						view->draw(
+							p,
+							hclip.translated(0, -y),
+							selection,
+							ms);
+					}
 
 					if (item->hasViews()) {
 						App::main()->scheduleViewIncrement(item);
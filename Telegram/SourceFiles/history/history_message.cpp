@@ -27,6 +27,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "observer_peer.h"
 #include "storage/storage_shared_media.h"
 #include "data/data_session.h"
+#include "data/data_search_index.h"
 #include "data/data_game.h"
 #include "data/data_media_types.h"
 #include "data/data_channel.h"
@@ -1022,6 +1023,7 @@ void HistoryMessage::setText(const TextWithEntities &textWithEntities) {
 		}
 		_textWidth = -1;
 		_textHeight = 0;
+		history()->owner().searchIndex().add(this, textWithEntities.text);
 	}
 }
 
@@ -1030,6 +1032,7 @@ void HistoryMessage::setEmptyText() {
 		st::messageTextStyle,
 		{ QString(), EntitiesInText() },
 		Ui::ItemTextOptions(this));
+	history()->owner().searchIndex().remove(this);
 
 	_textWidth = -1;
 	_textHeight = 0;
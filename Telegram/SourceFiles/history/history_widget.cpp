@@ -60,6 +60,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "storage/localstorage.h"
 #include "storage/file_upload.h"
 #include "storage/storage_media_prepare.h"
+#include "storage/storage_history_cache.h"
 #include "media/audio/media_audio.h"
 #include "media/audio/media_audio_capture.h"
 #include "media/player/media_player_instance.h"
@@ -1772,7 +1773,10 @@ void HistoryWidget::clearAllLoadRequests() {
 	if (_firstLoadRequest) MTP::cancel(_firstLoadRequest);
 	if (_preloadRequest) MTP::cancel(_preloadRequest);
 	if (_preloadDownRequest) MTP::cancel(_preloadDownRequest);
+	if (_cachedHistoryRequest) MTP::cancel(_cachedHistoryRequest);
 	_preloadRequest = _preloadDownRequest = _firstLoadRequest = 0;
+	_cachedHistoryRequest = 0;
+	_cachedHistoryIds.clear();
 }
 
 void HistoryWidget::updateFieldSubmitSettings() {
@@ -2241,6 +2245,10 @@ bool HistoryWidget::messagesFailed(const RPCError &error, mtpRequestId requestId
 	} else if (_firstLoadRequest == requestId) {
 		_firstLoadRequest = 0;
 		controller()->showBackFromStack();
+	} else if (_cachedHistoryRequest == requestId) {
+		// Keep showing the cached messages.
+		_cachedHistoryRequest = 0;
+		_cachedHistoryIds.clear();
 	} else if (_delayedShowAtRequest == requestId) {
 		_delayedShowAtRequest = 0;
 	}
@@ -2250,12 +2258,14 @@ bool HistoryWidget::messagesFailed(const RPCError &error, mtpRequestId requestId
 void HistoryWidget::messagesReceived(PeerData *peer, const MTPmessages_Messages &messages, mtpRequestId requestId) {
 	if (!_history) {
 		_preloadRequest = _preloadDownRequest = _firstLoadRequest = _delayedShowAtRequest = 0;
+		_cachedHistoryRequest = 0;
 		return;
 	}
 
 	bool toMigrated = (peer == _peer->migrateFrom());
 	if (peer != _peer && !toMigrated) {
 		_preloadRequest = _preloadDownRequest = _firstLoadRequest = _delayedShowAtRequest = 0;
+		_cachedHistoryRequest = 0;
 		return;
 	}
 
@@ -2333,12 +2343,19 @@ void HistoryWidget::messagesReceived(PeerData *peer, const MTPmessages_Messages
 		}
 		addMessagesToFront(peer, *histList);
 		_firstLoadRequest = 0;
+		if (_firstLoadAtBottom && !toMigrated) {
+			_history->owner().historyCache().put(peer->id, messages);
+		}
 		if (_history->loadedAtTop() && _history->isEmpty() && count > 0) {
 			firstLoadMessages();
 			return;
 		}
 
 		historyLoaded();
+	} else if (_cachedHistoryRequest == requestId) {
+		_cachedHistoryRequest = 0;
+		reconcileCachedHistory(peer, *histList);
+		_history->owner().historyCache().put(peer->id, messages);
 	} else if (_delayedShowAtRequest == requestId) {
 		if (toMigrated) {
 			_history->unloadBlocks();
@@ -2462,6 +2479,7 @@ void HistoryWidget::firstLoadMessages() {
 	auto minId = 0;
 	auto historyHash = 0;
 
+	_firstLoadAtBottom = (from == _peer) && !offsetId && !offset;
 	_firstLoadRequest = MTP::send(
 		MTPmessages_GetHistory(
 			from->input,
@@ -2474,6 +2492,102 @@ void HistoryWidget::firstLoadMessages() {
 			MTP_int(historyHash)),
 		rpcDone(&HistoryWidget::messagesReceived, from),
 		rpcFail(&HistoryWidget::messagesFailed));
+
+	if (_firstLoadAtBottom && !_migrated && _history->isEmpty()) {
+		showCachedHistory();
+	}
+}
+
+void HistoryWidget::showCachedHistory() {
+	const auto history = _history;
+	const auto requestId = _firstLoadRequest;
+	_history->owner().historyCache().get(_peer->id, crl::guard(this, [=](
+			Storage::HistoryCache::Slice &&slice) {
+		if (_history != history
+			|| _firstLoadRequest != requestId
+			|| !_history->isEmpty()
+			|| slice.messages.isEmpty()) {
+			return;
+		}
+
+		// Show the cached messages as if the request was finished
+		// and check them when the real answer comes.
+		addMessagesToFront(_peer, slice.messages);
+		if (!slice.noSkipRange.from) {
+			// The whole history was cached, nothing to load above it.
+			addMessagesToFront(_peer, {});
+		}
+		_cachedHistoryRequest = base::take(_firstLoadRequest);
+		_cachedHistoryIds.clear();
+		for (const auto &message : slice.messages) {
+			_cachedHistoryIds.push_back(IdFromMessage(message));
+		}
+		ranges::sort(_cachedHistoryIds);
+		historyLoaded();
+	}));
+}
+
+void HistoryWidget::reconcileCachedHistory(
+		PeerData *peer,
+		const QVector<MTPMessage> &messages) {
+	const auto cached = base::take(_cachedHistoryIds);
+	if (cached.empty()) {
+		return;
+	} else if (messages.isEmpty()) {
+		// The history was cleared, all the cached messages are gone.
+		const auto channel = _history->channelId();
+		for (const auto id : cached) {
+			if (const auto item = App::histItemById(channel, id)) {
+				item->destroy();
+			}
+		}
+		return;
+	}
+
+	// The answer is sorted from the newest message.
+	const auto cachedMax = cached.back();
+	const auto serverMin = IdFromMessage(messages.back());
+	if (serverMin > cachedMax) {
+		// Too many new messages, they don't touch the cached ones.
+		_history->unloadBlocks();
+		_firstLoadRequest = -1; // hack - don't updateListSize yet
+		addMessagesToFront(peer, messages);
+		_firstLoadRequest = 0;
+		_historyInited = false;
+		historyLoaded();
+		return;
+	}
+
+	auto newer = QVector<MTPMessage>();
+	auto received = base::flat_set<MsgId>();
+	for (const auto &message : messages) {
+		const auto id = IdFromMessage(message);
+		received.emplace(id);
+		if (id > cachedMax) {
+			newer.push_back(message);
+		} else if (message.type() == mtpc_message) {
+			const auto &data = message.c_message();
+			if (data.has_edit_date()) {
+				const auto channel = _history->channelId();
+				if (const auto item = App::histItemById(channel, id)) {
+					item->applyEdition(data);
+				}
+			}
+		}
+	}
+
+	// Cached messages missing in the answer were deleted.
+	for (const auto id : cached) {
+		if (id >= serverMin && !received.contains(id)) {
+			const auto channel = _history->channelId();
+			if (const auto item = App::histItemById(channel, id)) {
+				item->destroy();
+			}
+		}
+	}
+	if (!newer.isEmpty()) {
+		addMessagesToBack(peer, newer);
+	}
 }
 
 void HistoryWidget::loadMessages() {
@@ -602,6 +602,10 @@ private:
 	bool messagesFailed(const RPCError &error, mtpRequestId requestId);
 	void addMessagesToFront(PeerData *peer, const QVector<MTPMessage> &messages);
 	void addMessagesToBack(PeerData *peer, const QVector<MTPMessage> &messages);
+	void showCachedHistory();
+	void reconcileCachedHistory(
+		PeerData *peer,
+		const QVector<MTPMessage> &messages);
 
 	struct BotCallbackInfo {
 		UserData *bot;
@@ -692,6 +696,11 @@ private:
 	MsgId _showAtMsgId = ShowAtUnreadMsgId;
 
 	mtpRequestId _firstLoadRequest = 0;
+	bool _firstLoadAtBottom = false;
+
+	// The first load request continued after the cached slice was shown.
+	mtpRequestId _cachedHistoryRequest = 0;
+	std::vector<MsgId> _cachedHistoryIds;
 	mtpRequestId _preloadRequest = 0;
 	mtpRequestId _preloadDownRequest = 0;
 
@@ -15,6 +15,8 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "ui/image/image.h"
 #include "ui/emoji_config.h"
 #include "data/data_document.h"
+#include "data/data_session.h"
+#include "chat_helpers/stickers_raster_cache.h"
 #include "styles/style_history.h"
 
 namespace {
@@ -92,10 +94,15 @@ void HistorySticker::draw(Painter &p, const QRect &r, TextSelection selection, c
 
 	if (width() < st::msgPadding.left() + st::msgPadding.right() + 1) return;
 
-	_data->checkStickerLarge();
-	bool loaded = _data->loaded();
 	bool selected = (selection == FullSelection);
 
+	// Colored selection overlay is prepared from the decoded image,
+	// usually the bitmap prepared in the background is painted.
+	if (selected) {
+		_data->checkStickerLarge();
+	}
+	bool loaded = _data->loaded();
+
 	auto outbg = _parent->hasOutLayout();
 	auto inWebPage = (_parent->media() != this);
 
@@ -111,12 +118,17 @@ void HistorySticker::draw(Painter &p, const QRect &r, TextSelection selection, c
 	}
 	if (rtl()) usex = width() - usex - usew;
 
+	const auto raster = selected
+		? QPixmap()
+		: _data->owner().stickerRasters().frame(_data, { _pixw, _pixh });
 	const auto &pixmap = [&]() -> const QPixmap & {
 		const auto o = item->fullId();
 		const auto w = _pixw;
 		const auto h = _pixh;
 		const auto &c = st::msgStickerOverlay;
-		if (const auto image = _data->getStickerLarge()) {
+		if (!raster.isNull()) {
+			return raster;
+		} else if (const auto image = sticker->image.get()) {
 			return selected
 				? image->pixColored(o, c, w, h)
 				: image->pix(o, w, h);
@@ -6,6 +6,8 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 */
 #pragma once
 
+#include "ui/paint_stats.h"
+
 namespace HistoryView {
 
 class Object {
@@ -18,6 +20,7 @@ public:
 		setOptimalSize(countOptimalSize());
 	}
 	int resizeGetHeight(int newWidth) {
+		Ui::PaintStats::CountLayout();
 		setCurrentSize(countCurrentSize(newWidth));
 		return _height;
 	}
@@ -43,6 +43,15 @@ constexpr auto kPreloadedScreensCountFull
 	= kPreloadedScreensCount + 1 + kPreloadedScreensCount;
 constexpr auto kMediaCountForSearch = 10;
 
+// Pixmaps prepared for painting are kept only for the items that are not
+// farther than this count of screens from the visible area.
+constexpr auto kHeavyPartScreensCount = 1;
+
+// Items are preloaded ahead of the scroll direction, as far as the list
+// will be scrolled in that time with the current speed.
+constexpr auto kPreloadAheadDuration = crl::time(500);
+constexpr auto kPreloadAheadScreensMax = 2;
+
 UniversalMsgId GetUniversalId(FullMsgId itemId) {
 	return (itemId.channel != 0)
 		? UniversalMsgId(itemId.msg)
@@ -106,6 +115,9 @@ public:
 	FoundItem findItemNearId(UniversalMsgId universalId) const;
 	FoundItem findItemByPoint(QPoint point) const;
 
+	template <typename Callback>
+	void enumerateItems(int from, int till, Callback callback) const;
+
 	void paint(
 		Painter &p,
 		const Context &context,
@@ -314,6 +326,18 @@ auto ListWidget::Section::findItemNearId(
 	return { item, findItemRect(item), exact };
 }
 
+template <typename Callback>
+void ListWidget::Section::enumerateItems(
+		int from,
+		int till,
+		Callback callback) const {
+	const auto fromIt = findItemAfterTop(from);
+	const auto tillIt = findItemAfterBottom(fromIt, till);
+	for (auto it = fromIt; it != tillIt; ++it) {
+		callback(it->second);
+	}
+}
+
 auto ListWidget::Section::findItemAfterTop(
 		int top) -> Items::iterator {
 	return ranges::lower_bound(
@@ -609,6 +633,7 @@ void ListWidget::restart() {
 	_overLayout = nullptr;
 	_sections.clear();
 	_layouts.clear();
+	_heavyLayouts.clear();
 
 	_universalAroundId = kDefaultAroundId;
 	_idsLimit = kMinimalIdsLimit;
@@ -637,6 +662,7 @@ void ListWidget::itemRemoved(not_null<const HistoryItem*> item) {
 		}
 
 		_layouts.erase(universalId);
+		_heavyLayouts.remove(universalId);
 		_dragSelected.remove(universalId);
 
 		auto i = _selected.find(universalId);
@@ -1012,12 +1038,70 @@ auto ListWidget::foundItemInSection(
 void ListWidget::visibleTopBottomUpdated(
 		int visibleTop,
 		int visibleBottom) {
+	const auto scrolled = visibleTop - _visibleTop;
 	_visibleTop = visibleTop;
 	_visibleBottom = visibleBottom;
 
+	preloadAhead(scrolled);
+	clearHeavyParts();
 	checkMoveToOtherViewer();
 }
 
+template <typename Callback>
+void ListWidget::enumerateItems(
+		int from,
+		int till,
+		Callback callback) const {
+	const auto fromSectionIt = findSectionAfterTop(from);
+	const auto tillSectionIt = findSectionAfterBottom(
+		fromSectionIt,
+		till);
+	for (auto it = fromSectionIt; it != tillSectionIt; ++it) {
+		const auto top = it->top();
+		it->enumerateItems(from - top, till - top, callback);
+	}
+}
+
+void ListWidget::preloadAhead(int scrolled) {
+	const auto now = crl::now();
+	const auto elapsed = now - base::take(_lastScrollTime, now);
+	const auto visibleHeight = (_visibleBottom - _visibleTop);
+	if (!scrolled || elapsed <= 0 || visibleHeight <= 0) {
+		return;
+	}
+	const auto distance = snap(
+		int(std::abs(scrolled) * kPreloadAheadDuration / elapsed),
+		visibleHeight / 2,
+		kPreloadAheadScreensMax * visibleHeight);
+	const auto from = (scrolled > 0)
+		? _visibleBottom
+		: (_visibleTop - distance);
+	enumerateItems(from, from + distance, [](not_null<BaseLayout*> layout) {
+		layout->preload();
+	});
+}
+
+void ListWidget::clearHeavyParts() {
+	const auto visibleHeight = (_visibleBottom - _visibleTop);
+	const auto keepTop = _visibleTop
+		- kHeavyPartScreensCount * visibleHeight;
+	const auto keepBottom = _visibleBottom
+		+ kHeavyPartScreensCount * visibleHeight;
+	for (auto i = _heavyLayouts.begin(); i != _heavyLayouts.end();) {
+		const auto found = findItemById(*i);
+		if (found
+			&& found->geometry.y() < keepBottom
+			&& found->geometry.y() + found->geometry.height() > keepTop) {
+			++i;
+			continue;
+		}
+		if (const auto layout = getExistingLayout(*i)) {
+			layout->clearHeavyPart();
+		}
+		i = _heavyLayouts.erase(i);
+	}
+}
+
 void ListWidget::checkMoveToOtherViewer() {
 	auto visibleHeight = (_visibleBottom - _visibleTop);
 	if (width() <= 0
@@ -1137,6 +1221,12 @@ void ListWidget::paintEvent(QPaintEvent *e) {
 		it->paint(p, context, clip.translated(0, -top), outerWidth);
 		p.translate(0, -top);
 	}
+	enumerateItems(
+		clip.y(),
+		clip.y() + clip.height(),
+		[&](not_null<BaseLayout*> layout) {
+			_heavyLayouts.emplace(GetUniversalId(layout));
+		});
 }
 
 void ListWidget::mousePressEvent(QMouseEvent *e) {
@@ -2081,6 +2171,7 @@ void ListWidget::mouseActionUpdate() {
 void ListWidget::clearStaleLayouts() {
 	for (auto i = _layouts.begin(); i != _layouts.end();) {
 		if (i->second.stale) {
+			_heavyLayouts.remove(i->first);
 			if (i->second.item.get() == _overLayout) {
 				_overLayout = nullptr;
 			}
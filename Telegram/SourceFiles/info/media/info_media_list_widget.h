@@ -220,6 +220,10 @@ private:
 
 	void markLayoutsStale();
 	void clearStaleLayouts();
+	void preloadAhead(int scrolled);
+	void clearHeavyParts();
+	template <typename Callback>
+	void enumerateItems(int from, int till, Callback callback) const;
 	std::vector<Section>::iterator findSectionByItem(
 		UniversalMsgId universalId);
 	std::vector<Section>::iterator findSectionAfterTop(int top);
@@ -279,8 +283,12 @@ private:
 	std::map<UniversalMsgId, CachedItem> _layouts;
 	std::vector<Section> _sections;
 
+	// Painted layouts that may hold prepared pixmaps.
+	base::flat_set<UniversalMsgId> _heavyLayouts;
+
 	int _visibleTop = 0;
 	int _visibleBottom = 0;
+	crl::time _lastScrollTime = 0;
 	ScrollTopState _scrollTopState;
 	rpl::event_stream<int> _scrollToRequests;
 
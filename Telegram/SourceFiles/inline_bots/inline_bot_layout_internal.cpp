@@ -457,7 +457,7 @@ void Sticker::prepareThumbnail() const {
 					document->stickerSetOrigin(),
 					thumbSize.width(),
 					thumbSize.height());
-				_thumbLoaded = true;
+				_thumbLoaded = !sticker->rendering();
 			}
 		}
 	} else {
@@ -470,7 +470,7 @@ void Sticker::prepareThumbnail() const {
 						origin,
 						thumbSize.width(),
 						thumbSize.height());
-					_thumbLoaded = true;
+					_thumbLoaded = !thumb->rendering();
 				}
 			} else {
 				thumb->load(origin);
@@ -2978,9 +2978,11 @@ void MainWidget::feedChannelDifference(
 	session().data().processChats(data.vchats);
 
 	_handlingChannelDifference = true;
+	_dialogs->startChatListBatch();
 	feedMessageIds(data.vother_updates);
 	App::feedMsgs(data.vnew_messages, NewMessageUnread);
 	feedUpdateVector(data.vother_updates, true);
+	_dialogs->finishChatListBatch();
 	_handlingChannelDifference = false;
 }
 
@@ -3125,9 +3127,12 @@ void MainWidget::feedDifference(
 	session().checkAutoLock();
 	session().data().processUsers(users);
 	session().data().processChats(chats);
+
+	_dialogs->startChatListBatch();
 	feedMessageIds(other);
 	App::feedMsgs(msgs, NewMessageUnread);
 	feedUpdateVector(other, true);
+	_dialogs->finishChatListBatch();
 }
 
 bool MainWidget::failDifference(const RPCError &error) {
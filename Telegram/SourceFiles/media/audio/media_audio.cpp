@@ -9,6 +9,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "media/audio/media_audio_ffmpeg_loader.h"
 #include "media/audio/media_child_ffmpeg_loader.h"
 #include "media/audio/media_audio_loaders.h"
+#include "media/audio/media_audio_pcm.h"
 #include "media/audio/media_audio_track.h"
 #include "media/streaming/media_streaming_utility.h"
 #include "data/data_document.h"
@@ -472,7 +473,7 @@ void Mixer::Track::clear() {
 	frequency = kDefaultFrequency;
 	for (int i = 0; i != kBuffersCount; ++i) {
 		samplesCount[i] = 0;
-		bufferSamples[i] = QByteArray();
+		Audio::PlaybackSamplesPool().release(std::move(bufferSamples[i]));
 	}
 
 	setExternalData(nullptr);
@@ -492,7 +493,7 @@ void Mixer::Track::started() {
 	frequency = kDefaultFrequency;
 	for (auto i = 0; i != kBuffersCount; ++i) {
 		samplesCount[i] = 0;
-		bufferSamples[i] = QByteArray();
+		Audio::PlaybackSamplesPool().release(std::move(bufferSamples[i]));
 	}
 }
 
@@ -527,10 +528,12 @@ int Mixer::Track::getNotQueuedBufferIndex() {
 				auto samplesInBuffer = samplesCount[i];
 				bufferedPosition += samplesInBuffer;
 				bufferedLength -= samplesInBuffer;
+				Audio::PlaybackSamplesPool().release(
+					std::move(bufferSamples[i]));
 				for (auto j = i + 1; j != kBuffersCount; ++j) {
 					samplesCount[j - 1] = samplesCount[j];
 					stream.buffers[j - 1] = stream.buffers[j];
-					bufferSamples[j - 1] = bufferSamples[j];
+					bufferSamples[j - 1] = std::move(bufferSamples[j]);
 				}
 				samplesCount[kBuffersCount - 1] = 0;
 				stream.buffers[kBuffersCount - 1] = buffer;
@@ -6,6 +6,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 */
 #include "media/audio/media_audio_ffmpeg_loader.h"
 
+#include "media/audio/media_audio_pcm.h"
 #include "base/bytes.h"
 
 namespace Media {
@@ -308,6 +309,31 @@ bool AbstractAudioFFMpegLoader::frameHasDesiredFormat() const {
 		&& (_frame->sample_rate == _swrDstRate);
 }
 
+bool AbstractAudioFFMpegLoader::frameConvertibleWithoutResample() const {
+	if (_frame->sample_rate != _swrDstRate
+		|| _swrDstSampleFormat != AV_SAMPLE_FMT_S16
+		|| _swrDstChannelLayout != AV_CH_LAYOUT_STEREO) {
+		return false;
+	} else if (_swrContext && swr_get_delay(_swrContext, _swrSrcRate) > 0) {
+		// Resampler still holds some samples, we can't skip it now.
+		return false;
+	}
+	const auto frameChannelLayout = ComputeChannelLayout(
+		_frame->channel_layout,
+		_frame->channels);
+	const auto mono = (frameChannelLayout == AV_CH_LAYOUT_MONO);
+	if (!mono && frameChannelLayout != AV_CH_LAYOUT_STEREO) {
+		return false;
+	}
+	switch (_frame->format) {
+	case AV_SAMPLE_FMT_FLT:
+	case AV_SAMPLE_FMT_FLTP:
+	case AV_SAMPLE_FMT_S16P: return true;
+	case AV_SAMPLE_FMT_S16: return mono;
+	}
+	return false;
+}
+
 bool AbstractAudioFFMpegLoader::initResampleForFrame() {
 	const auto frameChannelLayout = ComputeChannelLayout(
 		_frame->channel_layout,
@@ -438,6 +464,60 @@ void AbstractAudioFFMpegLoader::appendSamples(
 	samplesAdded += count;
 }
 
+void AbstractAudioFFMpegLoader::appendConvertedSamples(
+		QByteArray &result,
+		int64 &samplesAdded) {
+	const auto count = _frame->nb_samples;
+	const auto offset = result.size();
+	result.resize(offset + count * _outputSampleSize);
+
+	const auto to = reinterpret_cast<int16*>(result.data() + offset);
+	const auto data = _frame->extended_data;
+	const auto mono = (ComputeChannelLayout(
+		_frame->channel_layout,
+		_frame->channels) == AV_CH_LAYOUT_MONO);
+	const auto floats = [&](int plane) {
+		return reinterpret_cast<const float*>(data[plane]);
+	};
+	const auto shorts = [&](int plane) {
+		return reinterpret_cast<const int16*>(data[plane]);
+	};
+	switch (_frame->format) {
+	case AV_SAMPLE_FMT_FLT:
+		if (mono) {
+			Audio::ConvertFloatMonoToS16Stereo(to, floats(0), count);
+		} else {
+			Audio::ConvertFloatToS16(to, floats(0), count * 2);
+		}
+		break;
+	case AV_SAMPLE_FMT_FLTP:
+		if (mono) {
+			Audio::ConvertFloatMonoToS16Stereo(to, floats(0), count);
+		} else {
+			Audio::ConvertFloatPlanarToS16Stereo(
+				to,
+				floats(0),
+				floats(1),
+				count);
+		}
+		break;
+	case AV_SAMPLE_FMT_S16:
+	case AV_SAMPLE_FMT_S16P:
+		if (mono) {
+			Audio::ConvertS16MonoToS16Stereo(to, shorts(0), count);
+		} else {
+			Audio::ConvertS16PlanarToS16Stereo(
+				to,
+				shorts(0),
+				shorts(1),
+				count);
+		}
+		break;
+	default: Unexpected("Format in appendConvertedSamples.");
+	}
+	samplesAdded += count;
+}
+
 AudioPlayerLoader::ReadResult AbstractAudioFFMpegLoader::readFromReadyFrame(
 	QByteArray & result,
 	int64 & samplesAdded) {
@@ -448,6 +528,9 @@ AudioPlayerLoader::ReadResult AbstractAudioFFMpegLoader::readFromReadyFrame(
 			_frame->extended_data,
 			_frame->nb_samples);
 		return ReadResult::Ok;
+	} else if (frameConvertibleWithoutResample()) {
+		appendConvertedSamples(result, samplesAdded);
+		return ReadResult::Ok;
 	} else if (!initResampleForFrame()) {
 		return ReadResult::Error;
 	}
@@ -115,6 +115,7 @@ protected:
 private:
 	ReadResult readFromReadyFrame(QByteArray &result, int64 &samplesAdded);
 	bool frameHasDesiredFormat() const;
+	bool frameConvertibleWithoutResample() const;
 	bool initResampleForFrame();
 	bool initResampleUsingFormat();
 	bool ensureResampleSpaceAvailable(int samples);
@@ -124,6 +125,7 @@ private:
 		int64 &samplesAdded,
 		uint8_t **data,
 		int count) const;
+	void appendConvertedSamples(QByteArray &result, int64 &samplesAdded);
 
 	Streaming::FramePointer _frame;
 	int _outputFormat = AL_FORMAT_STEREO16;
@@ -8,6 +8,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 
 #include "media/audio/media_audio.h"
 #include "media/audio/media_audio_ffmpeg_loader.h"
+#include "media/audio/media_audio_pcm.h"
 #include "media/audio/media_child_ffmpeg_loader.h"
 
 namespace Media {
@@ -161,7 +162,7 @@ void Loaders::loadData(AudioMsgId audio, crl::time positionMs) {
 	auto waiting = false;
 	auto errAtStart = started;
 
-	QByteArray samples;
+	auto samples = Audio::PlaybackSamplesPool().take();
 	int64 samplesCount = 0;
 	if (l->holdsSavedDecodedSamples()) {
 		l->takeSavedDecodedSamples(&samples, &samplesCount);
@@ -247,10 +248,11 @@ void Loaders::loadData(AudioMsgId audio, crl::time positionMs) {
 			l->setForceToBuffer(false);
 		}
 
-		track->bufferSamples[bufferIndex] = samples;
+		const auto &buffered = track->bufferSamples[bufferIndex]
+			= std::move(samples);
 		track->samplesCount[bufferIndex] = samplesCount;
 		track->bufferedLength += samplesCount;
-		alBufferData(track->stream.buffers[bufferIndex], track->format, samples.constData(), samples.size(), track->frequency);
+		alBufferData(track->stream.buffers[bufferIndex], track->format, buffered.constData(), buffered.size(), track->frequency);
 
 		alSourceQueueBuffers(track->stream.source, 1, track->stream.buffers + bufferIndex);
 
@@ -0,0 +1,183 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "media/audio/media_audio_pcm.h"
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define TDESKTOP_AUDIO_PCM_SSE2
+#include <emmintrin.h>
+#endif // __SSE2__ || _M_X64 || _M_IX86_FP >= 2
+
+namespace Media {
+namespace Audio {
+namespace {
+
+constexpr auto kFloatToS16 = 32767.f;
+
+SamplesPool PlaybackSamplesPoolInstance;
+
+inline int16 FloatToS16(float value) {
+	const auto scaled = value * kFloatToS16;
+	return (scaled >= 32767.f)
+		? int16(32767)
+		: (scaled <= -32768.f)
+		? int16(-32768)
+		: int16(std::lrint(scaled));
+}
+
+#ifdef TDESKTOP_AUDIO_PCM_SSE2
+inline __m128i LoadFloatsAsInts(const float *from, __m128 multiplier) {
+	// Clamp before the conversion, cvtps gives INT_MIN for huge values.
+	// The following _mm_packs_epi32 saturates to the int16 range.
+	const auto scaled = _mm_mul_ps(_mm_loadu_ps(from), multiplier);
+	return _mm_cvtps_epi32(_mm_max_ps(
+		_mm_min_ps(scaled, _mm_set1_ps(32767.f)),
+		_mm_set1_ps(-32768.f)));
+}
+#endif // TDESKTOP_AUDIO_PCM_SSE2
+
+} // namespace
+
+void ConvertFloatToS16(int16 *to, const float *from, int count) {
+	auto i = 0;
+#ifdef TDESKTOP_AUDIO_PCM_SSE2
+	const auto multiplier = _mm_set1_ps(kFloatToS16);
+	for (; i + 8 <= count; i += 8) {
+		const auto low = LoadFloatsAsInts(from + i, multiplier);
+		const auto high = LoadFloatsAsInts(from + i + 4, multiplier);
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(to + i),
+			_mm_packs_epi32(low, high));
+	}
+#endif // TDESKTOP_AUDIO_PCM_SSE2
+	for (; i != count; ++i) {
+		to[i] = FloatToS16(from[i]);
+	}
+}
+
+void ConvertFloatMonoToS16Stereo(int16 *to, const float *from, int count) {
+	auto i = 0;
+#ifdef TDESKTOP_AUDIO_PCM_SSE2
+	const auto multiplier = _mm_set1_ps(kFloatToS16);
+	for (; i + 4 <= count; i += 4) {
+		const auto mono = LoadFloatsAsInts(from + i, multiplier);
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(to + 2 * i),
+			_mm_packs_epi32(
+				_mm_unpacklo_epi32(mono, mono),
+				_mm_unpackhi_epi32(mono, mono)));
+	}
+#endif // TDESKTOP_AUDIO_PCM_SSE2
+	for (; i != count; ++i) {
+		to[2 * i] = to[2 * i + 1] = FloatToS16(from[i]);
+	}
+}
+
+void ConvertFloatPlanarToS16Stereo(
+		int16 *to,
+		const float *left,
+		const float *right,
+		int count) {
+	auto i = 0;
+#ifdef TDESKTOP_AUDIO_PCM_SSE2
+	const auto multiplier = _mm_set1_ps(kFloatToS16);
+	for (; i + 4 <= count; i += 4) {
+		const auto l = LoadFloatsAsInts(left + i, multiplier);
+		const auto r = LoadFloatsAsInts(right + i, multiplier);
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(to + 2 * i),
+			_mm_packs_epi32(
+				_mm_unpacklo_epi32(l, r),
+				_mm_unpackhi_epi32(l, r)));
+	}
+#endif // TDESKTOP_AUDIO_PCM_SSE2
+	for (; i != count; ++i) {
+		to[2 * i] = FloatToS16(left[i]);
+		to[2 * i + 1] = FloatToS16(right[i]);
+	}
+}
+
+void ConvertS16MonoToS16Stereo(int16 *to, const int16 *from, int count) {
+	auto i = 0;
+#ifdef TDESKTOP_AUDIO_PCM_SSE2
+	for (; i + 8 <= count; i += 8) {
+		const auto mono = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(from + i));
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(to + 2 * i),
+			_mm_unpacklo_epi16(mono, mono));
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(to + 2 * i + 8),
+			_mm_unpackhi_epi16(mono, mono));
+	}
+#endif // TDESKTOP_AUDIO_PCM_SSE2
+	for (; i != count; ++i) {
+		to[2 * i] = to[2 * i + 1] = from[i];
+	}
+}
+
+void ConvertS16PlanarToS16Stereo(
+		int16 *to,
+		const int16 *left,
+		const int16 *right,
+		int count) {
+	auto i = 0;
+#ifdef TDESKTOP_AUDIO_PCM_SSE2
+	for (; i + 8 <= count; i += 8) {
+		const auto l = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(left + i));
+		const auto r = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(right + i));
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(to + 2 * i),
+			_mm_unpacklo_epi16(l, r));
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(to + 2 * i + 8),
+			_mm_unpackhi_epi16(l, r));
+	}
+#endif // TDESKTOP_AUDIO_PCM_SSE2
+	for (; i != count; ++i) {
+		to[2 * i] = left[i];
+		to[2 * i + 1] = right[i];
+	}
+}
+
+QByteArray SamplesPool::take() {
+	{
+		QMutexLocker lock(&_mutex);
+		if (!_pool.empty()) {
+			auto result = std::move(_pool.back());
+			_pool.pop_back();
+			return result;
+		}
+	}
+	auto result = QByteArray();
+	result.reserve(kBufferCapacity);
+	return result;
+}
+
+void SamplesPool::release(QByteArray &&samples) {
+	if (!samples.isDetached() || samples.capacity() < kBufferCapacity) {
+		samples = QByteArray();
+		return;
+	}
+
+	// With a reserved capacity resize() keeps the allocation.
+	samples.resize(0);
+
+	QMutexLocker lock(&_mutex);
+	if (_pool.size() < kMaxPooled) {
+		_pool.push_back(std::move(samples));
+	}
+	samples = QByteArray();
+}
+
+SamplesPool &PlaybackSamplesPool() {
+	return PlaybackSamplesPoolInstance;
+}
+
+} // namespace Audio
+} // namespace Media
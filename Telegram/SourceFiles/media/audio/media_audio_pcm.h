@@ -0,0 +1,50 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Media {
+namespace Audio {
+
+// Sample conversion kernels used when a decoded frame already has the
+// output sample rate, so swresample can be skipped. All of them write
+// interleaved signed 16 bit samples, saturating float input to range.
+void ConvertFloatToS16(int16 *to, const float *from, int count);
+void ConvertFloatMonoToS16Stereo(int16 *to, const float *from, int count);
+void ConvertFloatPlanarToS16Stereo(
+	int16 *to,
+	const float *left,
+	const float *right,
+	int count);
+void ConvertS16MonoToS16Stereo(int16 *to, const int16 *from, int count);
+void ConvertS16PlanarToS16Stereo(
+	int16 *to,
+	const int16 *left,
+	const int16 *right,
+	int count);
+
+// Reuses the byte arrays that hold decoded samples between the loaders
+// and the OpenAL buffers, so that steady playback does not reallocate.
+class SamplesPool {
+public:
+	static constexpr auto kBufferCapacity = 320 * 1024;
+
+	// Thread: Any.
+	QByteArray take();
+	void release(QByteArray &&samples);
+
+private:
+	static constexpr auto kMaxPooled = 8;
+
+	QMutex _mutex;
+	std::vector<QByteArray> _pool;
+
+};
+
+SamplesPool &PlaybackSamplesPool();
+
+} // namespace Audio
+} // namespace Media
@@ -10,6 +10,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "storage/file_download.h"
 #include "media/clip/media_clip_ffmpeg.h"
 #include "media/clip/media_clip_check_streaming.h"
+#include "core/memory_budget.h"
 #include "mainwidget.h"
 #include "mainwindow.h"
 
@@ -24,9 +25,46 @@ namespace Media {
 namespace Clip {
 namespace {
 
+constexpr auto kMaxThreadsCount = 8;
+
+// Files read to memory by all the readers together.
+constexpr auto kMaxInMemoryTotal = int64(64 * 1024 * 1024);
+
+// When the decoded frames of the playing animations take more memory
+// than those of four 720p ones the GIFs are decoded with a lower frame
+// rate, they play slower instead of catching up.
+constexpr auto kThrottleFramesUsage = int64(4) * 1280 * 720 * 4 * 6;
+constexpr auto kThrottledFrameDelay = crl::time(66);
+
 QVector<QThread*> threads;
 QVector<Manager*> managers;
 
+// Decoded frames of the readers that are not paused.
+std::atomic<int64> ActiveFramesUsage = { 0 };
+std::atomic<int64> TotalInMemory = { 0 };
+
+int ThreadsCount() {
+	static const auto result = std::clamp(
+		QThread::idealThreadCount() - 1,
+		1,
+		kMaxThreadsCount);
+	return result;
+}
+
+bool AcquireInMemory(int64 size) {
+	auto was = TotalInMemory.load();
+	do {
+		if (was + size > kMaxInMemoryTotal) {
+			return false;
+		}
+	} while (!TotalInMemory.compare_exchange_weak(was, was + size));
+	return true;
+}
+
+void ReleaseInMemory(int64 size) {
+	TotalInMemory -= size;
+}
+
 QImage PrepareFrameImage(const FrameRequest &request, const QImage &original, bool hasAlpha, QImage &cache) {
 	auto needResize = (original.width() != request.framew) || (original.height() != request.frameh);
 	auto needOuterFill = (request.outerw != request.framew) || (request.outerh != request.frameh);
@@ -98,7 +136,7 @@ Reader::Reader(not_null<DocumentData*> document, FullMsgId msgId, Callback &&cal
 }
 
 void Reader::init(const FileLocation &location, const QByteArray &data) {
-	if (threads.size() < ClipThreadsCount) {
+	if (threads.size() < ThreadsCount()) {
 		_threadIndex = threads.size();
 		threads.push_back(new QThread());
 		managers.push_back(new Manager(threads.back()));
@@ -439,6 +477,14 @@ public:
 
 	ProcessResult finishProcess(crl::time ms) {
 		auto frameMs = _seekPositionMs + ms - _animationStarted;
+		if (_throttled) {
+			// Read only the next frame, the skipped time is not caught up.
+			const auto lag = frameMs - _implementation->framePresentationTime();
+			if (lag > 0) {
+				_animationStarted += lag;
+				frameMs -= lag;
+			}
+		}
 		auto readResult = _implementation->readFramesTill(frameMs, ms);
 		if (readResult == internal::ReaderImplementation::ReadResult::EndOfFile) {
 			stop(Player::State::StoppedAtEnd);
@@ -476,7 +522,12 @@ public:
 	}
 
 	bool init() {
-		if (_data.isEmpty() && QFileInfo(_location->name()).size() <= Storage::kMaxAnimationInMemory) {
+		const auto size = _data.isEmpty()
+			? QFileInfo(_location->name()).size()
+			: 0;
+		if (size > 0
+			&& size <= Storage::kMaxAnimationInMemory
+			&& AcquireInMemory(size)) {
 			QFile f(_location->name());
 			if (f.open(QIODevice::ReadOnly)) {
 				_data = f.readAll();
@@ -484,6 +535,11 @@ public:
 					_data = QByteArray();
 				}
 			}
+			if (_data.isEmpty()) {
+				ReleaseInMemory(size);
+			} else {
+				_inMemoryAcquired = size;
+			}
 		}
 
 		_implementation = std::make_unique<internal::FFMpegReaderImplementation>(_location.get(), &_data, _audioMsgId);
@@ -548,6 +604,34 @@ public:
 	~ReaderPrivate() {
 		stop(Player::State::Stopped);
 		_data.clear();
+		if (_inMemoryAcquired) {
+			ReleaseInMemory(_inMemoryAcquired);
+		}
+		if (_framesUsage) {
+			Core::MemoryBudget::Instance().decrement(
+				Core::MemoryKind::ClipFrames,
+				_framesUsage);
+		}
+		ActiveFramesUsage -= _activeFramesUsage;
+	}
+
+	// Three frames are decoded here and three are shown by the Reader.
+	void countFramesUsage() {
+		const auto usage = int64(_width) * _height * 4 * 6;
+		Core::MemoryBudget::Instance().increment(
+			Core::MemoryKind::ClipFrames,
+			usage - _framesUsage);
+		_framesUsage = usage;
+	}
+
+	// Paused readers don't decode frames, so they are not counted.
+	void countActiveFramesUsage() {
+		const auto active = _started
+			&& !_autoPausedGif
+			&& !_videoPausedAtMs;
+		const auto usage = active ? _framesUsage : 0;
+		ActiveFramesUsage += usage - _activeFramesUsage;
+		_activeFramesUsage = usage;
 	}
 
 private:
@@ -558,6 +642,9 @@ private:
 	crl::time _seekPositionMs = 0;
 
 	QByteArray _data;
+	int64 _inMemoryAcquired = 0;
+	int64 _framesUsage = 0;
+	int64 _activeFramesUsage = 0;
 	std::unique_ptr<FileLocation> _location;
 	bool _accessed = false;
 
@@ -590,6 +677,7 @@ private:
 	crl::time _nextFramePositionMs = 0;
 
 	bool _autoPausedGif = false;
+	bool _throttled = false;
 	bool _started = false;
 	crl::time _videoPausedAtMs = 0;
 
@@ -612,7 +700,7 @@ Manager::Manager(QThread *thread) : _processingInThread(0), _needReProcess(false
 
 void Manager::append(Reader *reader, const FileLocation &location, const QByteArray &data) {
 	reader->_private = new ReaderPrivate(reader, location, data);
-	_loadLevel.fetchAndAddRelaxed(AverageGifSize);
+	changeLoadLevel(AverageGifSize);
 	update(reader);
 }
 
@@ -639,6 +727,10 @@ void Manager::stop(Reader *reader) {
 	emit processDelayed();
 }
 
+void Manager::changeLoadLevel(int delta) {
+	_loadLevel.fetchAndAddRelaxed(delta);
+}
+
 bool Manager::carries(Reader *reader) const {
 	QMutexLocker lock(&_readerPointersMutex);
 	return _readerPointers.contains(reader);
@@ -680,21 +772,21 @@ bool Manager::handleProcessResult(ReaderPrivate *reader, ProcessResult result, c
 	}
 
 	if (result == ProcessResult::Started) {
-		_loadLevel.fetchAndAddRelaxed(reader->_width * reader->_height - AverageGifSize);
+		changeLoadLevel(reader->_width * reader->_height - AverageGifSize);
+		reader->countFramesUsage();
 		it.key()->_durationMs = reader->_durationMs;
 		it.key()->_hasAudio = reader->_hasAudio;
 	}
-	// See if we need to pause GIF because it is not displayed right now.
+	// See if we need to pause GIF because it is not displayed right now,
+	// it is resumed by Reader::current() when it is painted again.
 	if (!reader->_autoPausedGif && reader->_mode == Reader::Mode::Gif && result == ProcessResult::Repaint) {
-		int32 ishowing, iprevious;
-		auto showing = it.key()->frameToShow(&ishowing), previous = it.key()->frameToWriteNext(false, &iprevious);
-		Assert(previous != nullptr && showing != nullptr && ishowing >= 0 && iprevious >= 0);
+		int32 ishowing;
+		auto showing = it.key()->frameToShow(&ishowing);
+		Assert(showing != nullptr && ishowing >= 0);
 		if (reader->_frames[ishowing].when > 0 && showing->displayed.loadAcquire() <= 0) { // current frame was not shown
-			if (reader->_frames[ishowing].when + WaitBeforeGifPause < ms || (reader->_frames[iprevious].when && previous->displayed.loadAcquire() <= 0)) {
-				reader->_autoPausedGif = true;
-				it.key()->_autoPausedGif.storeRelease(1);
-				result = ProcessResult::Paused;
-			}
+			reader->_autoPausedGif = true;
+			it.key()->_autoPausedGif.storeRelease(1);
+			result = ProcessResult::Paused;
 		}
 	}
 	if (result == ProcessResult::Started || result == ProcessResult::CopyFrame) {
@@ -722,7 +814,7 @@ bool Manager::handleProcessResult(ReaderPrivate *reader, ProcessResult result, c
 
 Manager::ResultHandleState Manager::handleResult(ReaderPrivate *reader, ProcessResult result, crl::time ms) {
 	if (!handleProcessResult(reader, result, ms)) {
-		_loadLevel.fetchAndAddRelaxed(-1 * (reader->_width > 0 ? reader->_width * reader->_height : AverageGifSize));
+		changeLoadLevel(-1 * (reader->_width > 0 ? reader->_width * reader->_height : AverageGifSize));
 		delete reader;
 		return ResultHandleRemove;
 	}
@@ -807,6 +899,11 @@ void Manager::process() {
 				i.value() = ms + 86400 * 1000ULL;
 			} else if (reader->_nextFrameWhen && reader->_started) {
 				i.value() = reader->_nextFrameWhen;
+				reader->_throttled = (reader->_mode == Reader::Mode::Gif)
+					&& (ActiveFramesUsage.load() > kThrottleFramesUsage);
+				if (reader->_throttled) {
+					accumulate_max(i.value(), ms + kThrottledFrameDelay);
+				}
 			} else {
 				i.value() = (ms + 86400 * 1000ULL);
 			}
@@ -814,12 +911,13 @@ void Manager::process() {
 			QMutexLocker lock(&_readerPointersMutex);
 			auto it = constUnsafeFindReaderPointer(reader);
 			if (it == _readerPointers.cend()) {
-				_loadLevel.fetchAndAddRelaxed(-1 * (reader->_width > 0 ? reader->_width * reader->_height : AverageGifSize));
+				changeLoadLevel(-1 * (reader->_width > 0 ? reader->_width * reader->_height : AverageGifSize));
 				delete reader;
 				i = _readers.erase(i);
 				continue;
 			}
 		}
+		reader->countActiveFramesUsage();
 		if (!reader->_autoPausedGif && i.value() < minms) {
 			minms = i.value();
 		}
@@ -846,13 +944,20 @@ void Manager::clear() {
 	{
 		QMutexLocker lock(&_readerPointersMutex);
 		for (auto it = _readerPointers.begin(), e = _readerPointers.end(); it != e; ++it) {
+			const auto reader = it.key()->_private;
+			if (reader && !_readers.contains(reader)) {
+				// Appended, but not processed yet.
+				changeLoadLevel(-AverageGifSize);
+			}
 			it.key()->_private = nullptr;
 		}
 		_readerPointers.clear();
 	}
 
 	for (Readers::iterator i = _readers.begin(), e = _readers.end(); i != e; ++i) {
-		delete i.key();
+		const auto reader = i.key();
+		changeLoadLevel(-1 * (reader->_width > 0 ? reader->_width * reader->_height : AverageGifSize));
+		delete reader;
 	}
 	_readers.clear();
 }
@@ -209,6 +209,7 @@ public slots:
 private:
 
 	void clear();
+	void changeLoadLevel(int delta);
 
 	QAtomicInt _loadLevel;
 	using ReaderPointers = QMap<Reader*, QAtomicInt>;
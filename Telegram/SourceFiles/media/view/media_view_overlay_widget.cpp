@@ -1783,10 +1783,13 @@ void OverlayWidget::displayDocument(DocumentData *doc, HistoryItem *item) {
 			if (const auto image = _doc->getStickerLarge()) {
 				_current = image->pix(fileOrigin());
 			} else if (_doc->hasThumbnail()) {
-				_current = _doc->thumbnail()->pixBlurred(
+				// The viewer keeps this frame, so it can't be a placeholder.
+				_current = _doc->thumbnail()->pixNoCache(
 					fileOrigin(),
-					_doc->dimensions.width(),
-					_doc->dimensions.height());
+					_doc->dimensions.width() * cIntRetinaFactor(),
+					_doc->dimensions.height() * cIntRetinaFactor(),
+					Images::Option::Smooth | Images::Option::Blurred);
+				_current.setDevicePixelRatio(cRetinaFactor());
 			}
 		} else {
 			_doc->automaticLoad(fileOrigin(), item);
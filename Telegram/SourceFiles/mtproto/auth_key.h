@@ -10,6 +10,8 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include <memory>
 #include "base/bytes.h"
 
+struct SHA256state_st;
+
 namespace MTP {
 
 class AuthKey {
@@ -96,6 +98,9 @@ using AuthKeysList = std::vector<AuthKeyPtr>;
 void aesIgeEncryptRaw(const void *src, void *dst, uint32 len, const void *key, const void *iv);
 void aesIgeDecryptRaw(const void *src, void *dst, uint32 len, const void *key, const void *iv);
 
+// Decrypts and passes the decrypted data to SHA256_Update(context).
+void aesIgeDecryptSha256Raw(const void *src, void *dst, uint32 len, const void *key, const void *iv, SHA256state_st *context);
+
 inline void aesIgeEncrypt_oldmtp(const void *src, void *dst, uint32 len, const AuthKeyPtr &authKey, const MTPint128 &msgKey) {
 	MTPint256 aesKey, aesIV;
 	authKey->prepareAES_oldmtp(msgKey, aesKey, aesIV, true);
@@ -131,6 +136,13 @@ inline void aesIgeDecrypt(const void *src, void *dst, uint32 len, const AuthKeyP
 	return aesIgeDecryptRaw(src, dst, len, static_cast<const void*>(&aesKey), static_cast<const void*>(&aesIV));
 }
 
+inline void aesIgeDecryptSha256(const void *src, void *dst, uint32 len, const AuthKeyPtr &authKey, const MTPint128 &msgKey, SHA256state_st *context) {
+	MTPint256 aesKey, aesIV;
+	authKey->prepareAES(msgKey, aesKey, aesIV, false);
+
+	return aesIgeDecryptSha256Raw(src, dst, len, static_cast<const void*>(&aesKey), static_cast<const void*>(&aesIV), context);
+}
+
 inline void aesDecryptLocal(const void *src, void *dst, uint32 len, const AuthKeyPtr &authKey, const void *key128) {
 	MTPint256 aesKey, aesIV;
 	authKey->prepareAES_oldmtp(*(const MTPint128*)key128, aesKey, aesIV, false);
@@ -1431,7 +1431,12 @@ void ConnectionPrivate::handleReceived() {
 #ifdef TDESKTOP_MTPROTO_OLD
 		aesIgeDecrypt_oldmtp(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, key, msgKey);
 #else // TDESKTOP_MTPROTO_OLD
-		aesIgeDecrypt(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, key, msgKey);
+		// The msg_key is checked by a hash of the decrypted data,
+		// it is computed while the data is still in the processor cache.
+		SHA256_CTX msgKeyLargeContext;
+		SHA256_Init(&msgKeyLargeContext);
+		SHA256_Update(&msgKeyLargeContext, key->partForMsgKey(false), 32);
+		aesIgeDecryptSha256(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, key, msgKey, &msgKeyLargeContext);
 #endif // TDESKTOP_MTPROTO_OLD
 
 		auto decryptedInts = reinterpret_cast<const mtpPrime*>(decryptedBuffer.constData());
@@ -1475,11 +1480,6 @@ void ConnectionPrivate::handleReceived() {
 		auto badMessageLength = (paddingSize < kMinPaddingSize || paddingSize > kMaxPaddingSize);
 
 		std::array<uchar, 32> sha256Buffer = { { 0 } };
-
-		SHA256_CTX msgKeyLargeContext;
-		SHA256_Init(&msgKeyLargeContext);
-		SHA256_Update(&msgKeyLargeContext, key->partForMsgKey(false), 32);
-		SHA256_Update(&msgKeyLargeContext, decryptedInts, encryptedBytesCount);
 		SHA256_Final(sha256Buffer.data(), &msgKeyLargeContext);
 
 		constexpr auto kMsgKeyShift = 8U;
@@ -1569,16 +1569,8 @@ void ConnectionPrivate::handleReceived() {
 			emit sendAnythingAsync(kAckSendWaiting);
 		}
 
-		bool emitSignal = false;
-		{
-			QReadLocker locker(sessionData->haveReceivedMutex());
-			emitSignal = !sessionData->haveReceivedResponses().isEmpty() || !sessionData->haveReceivedUpdates().isEmpty();
-			if (emitSignal) {
-				DEBUG_LOG(("MTP Info: emitting needToReceive() - need to parse in another thread, %1 responses, %2 updates.").arg(sessionData->haveReceivedResponses().size()).arg(sessionData->haveReceivedUpdates().size()));
-			}
-		}
-
-		if (emitSignal) {
+		if (sessionData->scheduleReceive()) {
+			DEBUG_LOG(("MTP Info: emitting needToReceive() - need to parse in another thread, %1 messages.").arg(sessionData->receivedCount()));
 			emit needToReceive();
 		}
 
@@ -2065,8 +2057,7 @@ ConnectionPrivate::HandleResult ConnectionPrivate::handleOneReceived(const mtpPr
 		auto requestId = wasSent(reqMsgId.v);
 		if (requestId && requestId != mtpRequestId(0xFFFFFFFF)) {
 			// Save rpc_result for processing in the main thread.
-			QWriteLocker locker(sessionData->haveReceivedMutex());
-			sessionData->haveReceivedResponses().insert(requestId, response);
+			sessionData->addReceivedResponse(requestId, std::move(response));
 		} else {
 			DEBUG_LOG(("RPC Info: requestId not found for msgId %1").arg(reqMsgId.v));
 		}
@@ -2107,8 +2098,7 @@ ConnectionPrivate::HandleResult ConnectionPrivate::handleOneReceived(const mtpPr
 		if (from > start) memcpy(update.data(), start, (from - start) * sizeof(mtpPrime));
 
 		// Notify main process about new session - need to get difference.
-		QWriteLocker locker(sessionData->haveReceivedMutex());
-		sessionData->haveReceivedUpdates().push_back(SerializedMessage(update));
+		sessionData->addReceivedUpdate(std::move(update));
 	} return HandleResult::Success;
 
 	case mtpc_ping: {
@@ -2164,8 +2154,7 @@ ConnectionPrivate::HandleResult ConnectionPrivate::handleOneReceived(const mtpPr
 		if (end > from) memcpy(update.data(), from, (end - from) * sizeof(mtpPrime));
 
 		// Notify main process about the new updates.
-		QWriteLocker locker(sessionData->haveReceivedMutex());
-		sessionData->haveReceivedUpdates().push_back(SerializedMessage(update));
+		sessionData->addReceivedUpdate(std::move(update));
 
 		if (cons != mtpc_updatesTooLong
 			&& cons != mtpc_updateShortMessage
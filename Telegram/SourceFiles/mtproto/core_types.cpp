@@ -11,6 +11,9 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 namespace MTP {
 namespace {
 
+thread_local base::chunked_arena *ResponseArena = nullptr;
+thread_local uint64 AllocatedObjects = 0;
+
 uint32 CountPaddingAmountInInts(uint32 requestSize, bool extended) {
 #ifdef TDESKTOP_MTPROTO_OLD
 	return ((8 + requestSize) & 0x03)
@@ -37,6 +40,46 @@ uint32 CountPaddingAmountInInts(uint32 requestSize, bool extended) {
 
 } // namespace
 
+namespace internal {
+
+void *TypeData::operator new(std::size_t size) {
+	++AllocatedObjects;
+	return base::chunked_arena::allocate_current(size);
+}
+
+void TypeData::operator delete(void *pointer) {
+	base::chunked_arena::deallocate(pointer);
+}
+
+ResponseArenaScope::ResponseArenaScope(base::chunked_arena *arena)
+: _previous(std::exchange(ResponseArena, arena)) {
+}
+
+ResponseArenaScope::~ResponseArenaScope() {
+	ResponseArena = _previous;
+}
+
+base::chunked_arena *ResponseArenaScope::Take() {
+	return base::take(ResponseArena);
+}
+
+uint64 CountAllocatedObjects() {
+	return AllocatedObjects;
+}
+
+uint64 CountFingerprint(const mtpBuffer &serialized) {
+	constexpr auto kMultiplier = 0x9E3779B97F4A7C15ULL;
+	auto result = uint64(serialized.size()) * kMultiplier;
+	for (const auto prime : serialized) {
+		result ^= uint32(prime);
+		result *= kMultiplier;
+		result ^= (result >> 29);
+	}
+	return result;
+}
+
+} // namespace internal
+
 SecureRequest::SecureRequest(const details::SecureRequestCreateTag &tag)
 : _data(std::make_shared<SecureRequestData>(tag)) {
 }
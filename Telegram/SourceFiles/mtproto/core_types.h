@@ -17,6 +17,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "base/bytes.h"
 #include "base/algorithm.h"
 #include "base/assertion.h"
+#include "base/chunked_arena.h"
 
 using mtpPrime = int32;
 using mtpRequestId = int32;
@@ -101,6 +102,10 @@ public:
 	virtual ~TypeData() {
 	}
 
+	// Allocated in the current base::chunked_arena, if there is one.
+	static void *operator new(std::size_t size);
+	static void operator delete(void *pointer);
+
 private:
 	void incrementCounter() const {
 		_counter.ref();
@@ -173,6 +178,42 @@ private:
 
 };
 
+// The arena for the response that is handled on this thread while the
+// scope is alive, nullptr reads it on the heap.
+//
+// That makes parsing of large responses with thousands of messages and
+// users a lot cheaper. Only the response itself is read in the arena, by
+// ReadResponse(), the values created by its handler go to the heap. The
+// values of the response hold the chunks they live in, so they may be
+// kept, but MTP::Detach() should be used for the ones that are stored
+// for long, otherwise they keep the whole chunk alive.
+class ResponseArenaScope {
+public:
+	explicit ResponseArenaScope(base::chunked_arena *arena);
+	ResponseArenaScope(const ResponseArenaScope &other) = delete;
+	ResponseArenaScope &operator=(const ResponseArenaScope &other) = delete;
+	~ResponseArenaScope();
+
+	// Returns the arena only once, for the response itself.
+	[[nodiscard]] static base::chunked_arena *Take();
+
+private:
+	base::chunked_arena *_previous = nullptr;
+
+};
+
+template <typename Type>
+void ReadResponse(
+		Type &response,
+		const mtpPrime *&from,
+		const mtpPrime *end) {
+	const auto scope = base::chunked_arena_scope(ResponseArenaScope::Take());
+	response.read(from, end);
+}
+
+// Count of data objects created on this thread, for benchmarks.
+[[nodiscard]] uint64 CountAllocatedObjects();
+
 } // namespace internal
 } // namespace MTP
 
@@ -787,6 +828,41 @@ inline bool operator!=(const MTPvector<T> &a, const MTPvector<T> &b) {
 	return a.c_vector().v != b.c_vector().v;
 }
 
+namespace MTP {
+
+// Makes a copy that doesn't share data with the original value.
+template <typename Type>
+Type Detach(const Type &value) {
+	const auto heap = base::chunked_arena_scope(nullptr);
+
+	auto buffer = mtpBuffer();
+	buffer.reserve(value.innerLength() / sizeof(mtpPrime));
+	value.write(buffer);
+
+	auto result = Type();
+	auto from = buffer.constData();
+	result.read(from, from + buffer.size(), value.type());
+	return result;
+}
+
+namespace internal {
+
+uint64 CountFingerprint(const mtpBuffer &serialized);
+
+} // namespace internal
+
+// Hash of the serialized value, for checking if a received object has
+// changed without comparing all of its fields.
+template <typename Type>
+uint64 Fingerprint(const Type &value) {
+	thread_local auto buffer = mtpBuffer();
+	buffer.resize(0);
+	value.write(buffer);
+	return internal::CountFingerprint(buffer);
+}
+
+} // namespace MTP
+
 // Human-readable text serialization
 
 struct MTPStringLogger {
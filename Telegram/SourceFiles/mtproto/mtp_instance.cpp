@@ -14,6 +14,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "mtproto/connection.h"
 #include "mtproto/sender.h"
 #include "mtproto/rsa_public_key.h"
+#include "mtproto/traffic_recorder.h"
 #include "storage/localstorage.h"
 #include "calls/calls_instance.h"
 #include "auth_session.h"
@@ -33,6 +34,23 @@ namespace {
 constexpr auto kConfigBecomesOldIn = 2 * 60 * crl::time(1000);
 constexpr auto kConfigBecomesOldForBlockedIn = 8 * crl::time(1000);
 
+// Large responses that are converted to the local data right away.
+bool ParseInArena(mtpTypeId type) {
+	switch (type) {
+	case mtpc_updates_difference:
+	case mtpc_updates_differenceSlice:
+	case mtpc_updates_channelDifference:
+	case mtpc_updates_channelDifferenceTooLong:
+	case mtpc_messages_messages:
+	case mtpc_messages_messagesSlice:
+	case mtpc_messages_channelMessages:
+	case mtpc_messages_dialogs:
+	case mtpc_messages_dialogsSlice:
+		return true;
+	}
+	return false;
+}
+
 } // namespace
 
 class Instance::Private : private Sender {
@@ -1035,6 +1053,9 @@ void Instance::Private::execCallback(
 		mtpRequestId requestId,
 		const mtpPrime *from,
 		const mtpPrime *end) {
+	if (RecordingTraffic()) {
+		RecordTraffic(requestId, from, end);
+	}
 	RPCResponseHandler h;
 	{
 		QMutexLocker locker(&_parserMapLock);
@@ -1069,6 +1090,12 @@ void Instance::Private::execCallback(
 				handleError(error);
 			} else {
 				if (h.onDone) {
+					auto arena = std::optional<base::chunked_arena>();
+					if (ParseInArena(mtpTypeId(*from))) {
+						arena.emplace();
+					}
+					const auto scope = internal::ResponseArenaScope(
+						arena ? &*arena : nullptr);
 					(*h.onDone)(requestId, from, end);
 				}
 				unregisterRequest(requestId);
@@ -1091,6 +1118,9 @@ bool Instance::Private::hasCallbacks(mtpRequestId requestId) {
 }
 
 void Instance::Private::globalCallback(const mtpPrime *from, const mtpPrime *end) {
+	if (RecordingTraffic()) {
+		RecordTraffic(0, from, end);
+	}
 	if (_globalHandler.onDone) {
 		(*_globalHandler.onDone)(0, from, end); // some updates were received
 	}
@@ -134,7 +134,7 @@ public:
 	}
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		auto response = TResponse();
-		response.read(from, end);
+		MTP::internal::ReadResponse(response, from, end);
 		(*_onDone)(std::move(response));
 	}
 
@@ -152,7 +152,7 @@ public:
 	}
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		auto response = TResponse();
-		response.read(from, end);
+		MTP::internal::ReadResponse(response, from, end);
 		(*_onDone)(std::move(response), requestId);
 	}
 
@@ -380,7 +380,7 @@ public:
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		if (_owner) {
 			auto response = TResponse();
-			response.read(from, end);
+			MTP::internal::ReadResponse(response, from, end);
 			(static_cast<TReceiver*>(_owner)->*_onDone)(std::move(response));
 		}
 	}
@@ -400,7 +400,7 @@ public:
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		if (_owner) {
 			auto response = TResponse();
-			response.read(from, end);
+			MTP::internal::ReadResponse(response, from, end);
 			(static_cast<TReceiver*>(_owner)->*_onDone)(std::move(response), requestId);
 		}
 	}
@@ -486,7 +486,7 @@ public:
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		if (_owner) {
 			auto response = TResponse();
-			response.read(from, end);
+			MTP::internal::ReadResponse(response, from, end);
 			(static_cast<TReceiver*>(_owner)->*_onDone)(_b, std::move(response));
 		}
 	}
@@ -507,7 +507,7 @@ public:
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		if (_owner) {
 			auto response = TResponse();
-			response.read(from, end);
+			MTP::internal::ReadResponse(response, from, end);
 			(static_cast<TReceiver*>(_owner)->*_onDone)(_b, std::move(response), requestId);
 		}
 	}
@@ -877,7 +877,7 @@ public:
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		if (this->_handler) {
 			auto response = TResponse();
-			response.read(from, end);
+			MTP::internal::ReadResponse(response, from, end);
 			this->_handler(std::move(response));
 		}
 	}
@@ -891,7 +891,7 @@ public:
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		if (this->_handler) {
 			auto response = TResponse();
-			response.read(from, end);
+			MTP::internal::ReadResponse(response, from, end);
 			this->_handler(std::move(response), requestId);
 		}
 	}
@@ -59,7 +59,7 @@ class Sender {
 
 				if (handler) {
 					auto result = Response();
-					result.read(from, end);
+					internal::ReadResponse(result, from, end);
 					Policy::handle(std::move(handler), requestId, std::move(result));
 				}
 			}
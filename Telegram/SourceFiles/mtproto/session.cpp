@@ -29,6 +29,11 @@ constexpr auto kResendThreshold = 1;
 // Container lives 10 minutes in haveSent map.
 constexpr auto kContainerLives = 600;
 
+// Log the received messages processing if a large batch is processed
+// or if some message waited for too long in the queue.
+constexpr auto kLogReceivedCount = 256;
+constexpr auto kLogReceivedLatency = crl::time(100);
+
 QString LogIds(const QVector<uint64> &ids) {
 	if (!ids.size()) return "[]";
 	auto idsStr = QString("[%1").arg(*ids.cbegin());
@@ -88,29 +93,55 @@ void SessionData::notifyConnectionInited(const ConnectionOptions &options) {
 	}
 }
 
+void SessionData::addReceivedResponse(
+		mtpRequestId requestId,
+		SerializedMessage &&response) {
+	_receivedResponses.push({ requestId, std::move(response), crl::now() });
+	++_receivedCount;
+}
+
+void SessionData::addReceivedUpdate(SerializedMessage &&update) {
+	_receivedUpdates.push({ 0, std::move(update), crl::now() });
+	++_receivedCount;
+}
+
+bool SessionData::scheduleReceive() {
+	return (_receivedCount > 0) && !_receiveScheduled.exchange(true);
+}
+
+int SessionData::receivedCount() const {
+	return _receivedCount;
+}
+
+void SessionData::startReceive() {
+	// Messages added before that will be taken without a new notification.
+	_receiveScheduled.exchange(false);
+}
+
+std::optional<ReceivedMessage> SessionData::takeReceived() {
+	auto result = _receivedResponses.pop();
+	if (!result) {
+		result = _receivedUpdates.pop();
+	}
+	if (result) {
+		--_receivedCount;
+	}
+	return result;
+}
+
 void SessionData::clear(Instance *instance) {
 	auto clearCallbacks = std::vector<RPCCallbackClear>();
 	{
-		QReadLocker locker1(haveSentMutex()), locker2(toResendMutex()), locker3(haveReceivedMutex()), locker4(wereAckedMutex());
-		auto receivedResponsesEnd = _receivedResponses.cend();
+		QReadLocker locker1(haveSentMutex()), locker2(toResendMutex()), locker3(wereAckedMutex());
 		clearCallbacks.reserve(_haveSent.size() + _wereAcked.size());
 		for (auto i = _haveSent.cbegin(), e = _haveSent.cend(); i != e; ++i) {
-			auto requestId = i.value()->requestId;
-			if (!_receivedResponses.contains(requestId)) {
-				clearCallbacks.push_back(requestId);
-			}
+			clearCallbacks.push_back(i.value()->requestId);
 		}
 		for (auto i = _toResend.cbegin(), e = _toResend.cend(); i != e; ++i) {
-			auto requestId = i.value();
-			if (!_receivedResponses.contains(requestId)) {
-				clearCallbacks.push_back(requestId);
-			}
+			clearCallbacks.push_back(i.value());
 		}
 		for (auto i = _wereAcked.cbegin(), e = _wereAcked.cend(); i != e; ++i) {
-			auto requestId = i.value();
-			if (!_receivedResponses.contains(requestId)) {
-				clearCallbacks.push_back(requestId);
-			}
+			clearCallbacks.push_back(i.value());
 		}
 	}
 	{
@@ -129,7 +160,30 @@ void SessionData::clear(Instance *instance) {
 		QWriteLocker locker(receivedIdsMutex());
 		_receivedIds.clear();
 	}
-	instance->clearCallbacksDelayed(std::move(clearCallbacks));
+	if (clearCallbacks.empty()) {
+		return;
+	}
+
+	// The responses that are already queued still need their callbacks.
+	// The queue can be read only in the main thread, so check it there.
+	crl::on_main(owner(), [=, list = std::move(clearCallbacks)]() mutable {
+		skipQueuedResponses(list);
+		instance->clearCallbacksDelayed(std::move(list));
+	});
+}
+
+void SessionData::skipQueuedResponses(
+		std::vector<RPCCallbackClear> &list) const {
+	auto queued = base::flat_set<mtpRequestId>();
+	_receivedResponses.for_each([&](const ReceivedMessage &message) {
+		queued.emplace(message.requestId);
+	});
+	if (queued.empty()) {
+		return;
+	}
+	list.erase(ranges::remove_if(list, [&](const RPCCallbackClear &clear) {
+		return queued.contains(clear.requestId);
+	}), end(list));
 }
 
 Session::Session(not_null<Instance*> instance, ShiftedDcId shiftedDcId) : QObject()
@@ -595,38 +649,28 @@ void Session::tryToReceive() {
 		_needToReceive = true;
 		return;
 	}
-	while (true) {
-		auto requestId = mtpRequestId(0);
-		auto isUpdate = false;
-		auto message = SerializedMessage();
-		{
-			QWriteLocker locker(data.haveReceivedMutex());
-			auto &responses = data.haveReceivedResponses();
-			auto response = responses.begin();
-			if (response == responses.cend()) {
-				auto &updates = data.haveReceivedUpdates();
-				auto update = updates.begin();
-				if (update == updates.cend()) {
-					return;
-				} else {
-					message = std::move(*update);
-					isUpdate = true;
-					updates.pop_front();
-				}
-			} else {
-				requestId = response.key();
-				message = std::move(response.value());
-				responses.erase(response);
-			}
-		}
-		if (isUpdate) {
+	data.startReceive();
+	auto count = 0;
+	auto latency = crl::time(0);
+	while (auto received = data.takeReceived()) {
+		++count;
+		accumulate_max(latency, crl::now() - received->received);
+		const auto &message = received->message;
+		if (!received->requestId) {
 			if (dcWithShift == BareDcId(dcWithShift)) { // call globalCallback only in main session
 				_instance->globalCallback(message.constData(), message.constData() + message.size());
 			}
 		} else {
-			_instance->execCallback(requestId, message.constData(), message.constData() + message.size());
+			_instance->execCallback(received->requestId, message.constData(), message.constData() + message.size());
 		}
 	}
+	if (count >= kLogReceivedCount || latency >= kLogReceivedLatency) {
+		DEBUG_LOG(("MTP Info: processed %1 received messages in dc %2, "
+			"the oldest waited for %3 ms."
+			).arg(count
+			).arg(dcWithShift
+			).arg(latency));
+	}
 }
 
 Session::~Session() {
@@ -7,6 +7,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #pragma once
 
 #include "base/timer.h"
+#include "base/mpsc_queue.h"
 #include "mtproto/rpc_sender.h"
 
 namespace MTP {
@@ -105,6 +106,12 @@ inline bool ResponseNeedsAck(const SerializedMessage &response) {
 	return (seqNo & 0x01) ? true : false;
 }
 
+struct ReceivedMessage {
+	mtpRequestId requestId = 0; // Zero for updates.
+	SerializedMessage message;
+	crl::time received = 0;
+};
+
 struct ConnectionOptions {
 	ConnectionOptions() = default;
 	ConnectionOptions(
@@ -206,9 +213,6 @@ public:
 	not_null<QReadWriteLock*> receivedIdsMutex() const {
 		return &_receivedIdsLock;
 	}
-	not_null<QReadWriteLock*> haveReceivedMutex() const {
-		return &_haveReceivedLock;
-	}
 	not_null<QReadWriteLock*> stateRequestMutex() const {
 		return &_stateRequestLock;
 	}
@@ -243,18 +247,21 @@ public:
 	const RequestIdsMap &wereAckedMap() const {
 		return _wereAcked;
 	}
-	QMap<mtpRequestId, SerializedMessage> &haveReceivedResponses() {
-		return _receivedResponses;
-	}
-	const QMap<mtpRequestId, SerializedMessage> &haveReceivedResponses() const {
-		return _receivedResponses;
-	}
-	QList<SerializedMessage> &haveReceivedUpdates() {
-		return _receivedUpdates;
-	}
-	const QList<SerializedMessage> &haveReceivedUpdates() const {
-		return _receivedUpdates;
-	}
+
+	// Called from the connection thread.
+	void addReceivedResponse(
+		mtpRequestId requestId,
+		SerializedMessage &&response);
+	void addReceivedUpdate(SerializedMessage &&update);
+
+	// Returns true once for all the messages received while the session
+	// didn't start processing them, the session should be notified then.
+	[[nodiscard]] bool scheduleReceive();
+	[[nodiscard]] int receivedCount() const;
+
+	// Called from the main thread.
+	void startReceive();
+	[[nodiscard]] std::optional<ReceivedMessage> takeReceived();
 	QMap<mtpMsgId, bool> &stateRequestMap() {
 		return _stateRequest;
 	}
@@ -279,6 +286,8 @@ public:
 	void clear(Instance *instance);
 
 private:
+	void skipQueuedResponses(std::vector<RPCCallbackClear> &list) const;
+
 	uint64 _session = 0;
 	uint64 _salt = 0;
 
@@ -298,8 +307,13 @@ private:
 	RequestIdsMap _wereAcked; // map of msg_id -> request_id, this msg_ids already were acked or do not need ack
 	QMap<mtpMsgId, bool> _stateRequest; // set of msg_id's, whose state should be requested
 
-	QMap<mtpRequestId, SerializedMessage> _receivedResponses; // map of request_id -> response that should be processed in the main thread
-	QList<SerializedMessage> _receivedUpdates; // list of updates that should be processed in the main thread
+	// Responses and updates that should be processed in the main thread,
+	// the responses are processed first.
+	base::mpsc_queue<ReceivedMessage> _receivedResponses;
+	base::mpsc_queue<ReceivedMessage> _receivedUpdates;
+
+	std::atomic<int> _receivedCount = 0;
+	std::atomic<bool> _receiveScheduled = false;
 
 	// mutexes
 	mutable QReadWriteLock _lock;
@@ -308,7 +322,6 @@ private:
 	mutable QReadWriteLock _toResendLock;
 	mutable QReadWriteLock _receivedIdsLock;
 	mutable QReadWriteLock _wereAckedLock;
-	mutable QReadWriteLock _haveReceivedLock;
 	mutable QReadWriteLock _stateRequestLock;
 
 };
@@ -0,0 +1,119 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "mtproto/traffic_recorder.h"
+
+#include <atomic>
+
+namespace MTP {
+namespace {
+
+constexpr auto kMagic = qint32(0x5254444D); // "MDTR"
+constexpr auto kVersion = qint32(1);
+
+struct Recorder {
+	QFile file;
+	QDataStream stream;
+	crl::time started = 0;
+};
+
+std::atomic<bool> RecordingValue = false;
+QMutex RecorderMutex;
+std::unique_ptr<Recorder> GlobalRecorder;
+
+} // namespace
+
+bool RecordingTraffic() {
+	return RecordingValue.load(std::memory_order_relaxed);
+}
+
+void StartRecordingTraffic(const QString &path) {
+	QMutexLocker lock(&RecorderMutex);
+	auto recorder = std::make_unique<Recorder>();
+	recorder->file.setFileName(path);
+	if (!recorder->file.open(QIODevice::WriteOnly)) {
+		LOG(("MTP Error: could not open '%1' for recording.").arg(path));
+		return;
+	}
+	recorder->stream.setDevice(&recorder->file);
+	recorder->stream.setVersion(QDataStream::Qt_5_1);
+	recorder->stream << kMagic << kVersion;
+	recorder->started = crl::now();
+	GlobalRecorder = std::move(recorder);
+	RecordingValue = true;
+	LOG(("MTP Info: recording traffic to '%1'.").arg(path));
+}
+
+void StopRecordingTraffic() {
+	QMutexLocker lock(&RecorderMutex);
+	RecordingValue = false;
+	if (const auto recorder = base::take(GlobalRecorder)) {
+		recorder->file.close();
+		LOG(("MTP Info: stopped recording traffic."));
+	}
+}
+
+void RecordTraffic(
+		mtpRequestId requestId,
+		const mtpPrime *from,
+		const mtpPrime *end) {
+	QMutexLocker lock(&RecorderMutex);
+	if (!GlobalRecorder) {
+		return;
+	}
+	const auto bytes = QByteArray::fromRawData(
+		reinterpret_cast<const char*>(from),
+		(end - from) * sizeof(mtpPrime));
+	auto &stream = GlobalRecorder->stream;
+	stream
+		<< qint64(crl::now() - GlobalRecorder->started)
+		<< qint32(requestId)
+		<< bytes;
+	if (stream.status() != QDataStream::Ok) {
+		LOG(("MTP Error: could not write recorded traffic."));
+		lock.unlock();
+		StopRecordingTraffic();
+	}
+}
+
+std::vector<RecordedPacket> ReadRecordedTraffic(const QString &path) {
+	auto file = QFile(path);
+	if (!file.open(QIODevice::ReadOnly)) {
+		LOG(("MTP Error: could not open '%1' for replaying.").arg(path));
+		return {};
+	}
+	auto stream = QDataStream(&file);
+	stream.setVersion(QDataStream::Qt_5_1);
+	auto magic = qint32();
+	auto version = qint32();
+	stream >> magic >> version;
+	if (stream.status() != QDataStream::Ok
+		|| magic != kMagic
+		|| version != kVersion) {
+		LOG(("MTP Error: bad recorded traffic file '%1'.").arg(path));
+		return {};
+	}
+	auto result = std::vector<RecordedPacket>();
+	while (!stream.atEnd()) {
+		auto time = qint64();
+		auto requestId = qint32();
+		auto bytes = QByteArray();
+		stream >> time >> requestId >> bytes;
+		if (stream.status() != QDataStream::Ok
+			|| bytes.size() % sizeof(mtpPrime)) {
+			LOG(("MTP Error: recorded traffic file '%1' is truncated."
+				).arg(path));
+			break;
+		}
+		auto packet = RecordedPacket{ time, requestId };
+		packet.data.resize(bytes.size() / sizeof(mtpPrime));
+		memcpy(packet.data.data(), bytes.constData(), bytes.size());
+		result.push_back(std::move(packet));
+	}
+	return result;
+}
+
+} // namespace MTP
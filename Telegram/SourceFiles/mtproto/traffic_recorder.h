@@ -0,0 +1,34 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+namespace MTP {
+
+// Opt-in dump of the decrypted responses and updates, so that a real
+// session could be replayed later for benchmarking the data layer.
+//
+// Enabled by typing "recordmtp" in Settings. The packets are written as
+// they are passed to the parsers, updates have a zero request id.
+struct RecordedPacket {
+	crl::time time = 0;
+	mtpRequestId requestId = 0;
+	mtpBuffer data;
+};
+
+[[nodiscard]] bool RecordingTraffic();
+void StartRecordingTraffic(const QString &path);
+void StopRecordingTraffic();
+void RecordTraffic(
+	mtpRequestId requestId,
+	const mtpPrime *from,
+	const mtpPrime *end);
+
+// Returns an empty vector if the file could not be read.
+[[nodiscard]] std::vector<RecordedPacket> ReadRecordedTraffic(
+	const QString &path);
+
+} // namespace MTP
@@ -387,6 +387,17 @@ TextState Photo::getState(
 	return {};
 }
 
+void Photo::clearHeavyPart() {
+	_pix = QPixmap();
+	_goodLoaded = false;
+}
+
+void Photo::preload() const {
+	if (!_data->loaded()) {
+		_data->thumbnail()->automaticLoad(parent()->fullId(), parent());
+	}
+}
+
 Video::Video(
 	not_null<HistoryItem*> parent,
 	not_null<DocumentData*> video)
@@ -417,6 +428,10 @@ void Video::paint(Painter &p, const QRect &clip, TextSelection selection, const
 		&& _data->thumbnail()->loaded();
 
 	_data->automaticLoad(parent()->fullId(), parent());
+	if (!thumbLoaded) {
+		// The thumbnail may have been unloaded with the heavy part.
+		_data->loadThumbnail(parent()->fullId());
+	}
 	bool loaded = _data->loaded(), displayLoading = _data->displayLoading();
 	if (displayLoading) {
 		ensureRadial();
@@ -546,6 +561,15 @@ TextState Video::getState(
 	return {};
 }
 
+void Video::clearHeavyPart() {
+	_pix = QPixmap();
+}
+
+void Video::preload() const {
+	_data->loadThumbnail(parent()->fullId());
+	_data->automaticLoad(parent()->fullId(), parent());
+}
+
 void Video::updateStatusText() {
 	bool showPause = false;
 	int statusSize = 0;
@@ -1236,6 +1260,15 @@ TextState Document::getState(
 	return {};
 }
 
+void Document::clearHeavyPart() {
+	_thumb = QPixmap();
+	_thumbLoaded = false;
+}
+
+void Document::preload() const {
+	_data->automaticLoad(parent()->fullId(), parent());
+}
+
 const style::RoundCheckbox &Document::checkboxStyle() const {
 	return st::overviewSmallCheck;
 }
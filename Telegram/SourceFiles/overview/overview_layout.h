@@ -87,6 +87,16 @@ public:
 
 	void invalidateCache() override;
 
+	// Releases the pixmaps prepared for painting, they are prepared
+	// again next time the item is painted.
+	virtual void clearHeavyPart() {
+	}
+
+	// Starts loading what paint() will need, so that it is ready when
+	// the item is scrolled into view.
+	virtual void preload() const {
+	}
+
 	~ItemBase();
 
 protected:
@@ -206,6 +216,9 @@ public:
 		QPoint point,
 		StateRequest request) const override;
 
+	void clearHeavyPart() override;
+	void preload() const override;
+
 private:
 	void setPixFrom(not_null<Image*> image);
 
@@ -230,6 +243,9 @@ public:
 		QPoint point,
 		StateRequest request) const override;
 
+	void clearHeavyPart() override;
+	void preload() const override;
+
 protected:
 	float64 dataProgress() const override;
 	bool dataFinished() const override;
@@ -301,6 +317,9 @@ public:
 		return _data;
 	}
 
+	void clearHeavyPart() override;
+	void preload() const override;
+
 protected:
 	float64 dataProgress() const override;
 	bool dataFinished() const override;
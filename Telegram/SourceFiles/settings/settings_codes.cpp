@@ -17,10 +17,15 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "core/application.h"
 #include "mtproto/mtp_instance.h"
 #include "mtproto/dc_options.h"
+#include "mtproto/traffic_recorder.h"
+#include "data/data_traffic_replay.h"
+#include "window/notifications_manager.h"
+#include "auth_session.h"
 #include "core/file_utilities.h"
 #include "core/update_checker.h"
 #include "window/themes/window_theme.h"
 #include "window/themes/window_theme_editor.h"
+#include "ui/paint_stats.h"
 #include "media/audio/media_audio_track.h"
 
 namespace Settings {
@@ -64,6 +69,47 @@ auto GenerateCodes() {
 		}
 		Ui::show(Box<InformBox>(DebugLogging::FileLoader() ? qsl("Enabled file download logging") : qsl("Disabled file download logging")));
 	});
+	codes.emplace(qsl("paintstats"), [] {
+		Ui::PaintStats::SetEnabled(!Ui::PaintStats::Enabled());
+		Ui::Toast::Show(Ui::PaintStats::Enabled()
+			? qsl("Paint stats enabled")
+			: qsl("Paint stats disabled"));
+	});
+	codes.emplace(qsl("recordmtp"), [] {
+		if (MTP::RecordingTraffic()) {
+			MTP::StopRecordingTraffic();
+			Ui::Toast::Show(qsl("Traffic recording stopped"));
+			return;
+		}
+		const auto path = cWorkingDir() + qsl("traffic.tdesktop-mtp");
+		MTP::StartRecordingTraffic(path);
+		Ui::Toast::Show(MTP::RecordingTraffic()
+			? qsl("Recording traffic to ") + path
+			: qsl("Could not start recording traffic"));
+	});
+	codes.emplace(qsl("notifybench"), [] {
+		if (AuthSession::Exists()) {
+			Auth().notifications().benchmark(1000);
+		}
+	});
+	const auto replay = [](float64 speed) {
+		if (Data::TrafficReplayActive()) {
+			Data::StopTrafficReplay();
+			Ui::Toast::Show(qsl("Traffic replay stopped"));
+			return;
+		}
+		FileDialog::GetOpenPath(Core::App().getFileDialogParent(), "Open recorded traffic", "Recorded traffic (*.tdesktop-mtp)", [=](const FileDialog::OpenResult &result) {
+			if (!result.paths.isEmpty()) {
+				Data::StartTrafficReplay(result.paths.front(), speed);
+			}
+		});
+	};
+	codes.emplace(qsl("replaymtp"), [=] {
+		replay(1.);
+	});
+	codes.emplace(qsl("replaymtpfast"), [=] {
+		replay(0.);
+	});
 	codes.emplace(qsl("crashplease"), [] {
 		Unexpected("Crashed in Settings!");
 	});
@@ -3281,73 +3281,95 @@ Storage::Cache::Database::Settings cacheBigFileSettings() {
 	return result;
 }
 
-class CountWaveformTask : public Task {
-public:
-	CountWaveformTask(DocumentData *doc)
-		: _doc(doc)
-		, _loc(doc->location(true))
-		, _data(doc->data())
-		, _wavemax(0) {
-		if (_data.isEmpty() && !_loc.accessEnable()) {
-			_doc = nullptr;
-		}
-	}
-	void process() override {
-		if (!_doc) return;
-
-		_waveform = audioCountWaveform(_loc, _data);
-		_wavemax = _waveform.empty()
-			? char(0)
-			: *ranges::max_element(_waveform);
-	}
-	void finish() override {
-		if (const auto voice = _doc ? _doc->voice() : nullptr) {
-			if (!_waveform.isEmpty()) {
-				voice->waveform = _waveform;
-				voice->wavemax = _wavemax;
-			}
-			if (voice->waveform.isEmpty()) {
-				voice->waveform.resize(1);
-				voice->waveform[0] = -2;
-				voice->wavemax = 0;
-			} else if (voice->waveform[0] < 0) {
-				voice->waveform[0] = -2;
-				voice->wavemax = 0;
-			}
-			Auth().data().requestDocumentViewRepaint(_doc);
+namespace {
+
+void WaveformCounted(
+		base::binary_guard &&guard,
+		not_null<DocumentData*> document,
+		VoiceWaveform &&waveform,
+		bool saveToCache) {
+	crl::on_main(std::move(guard), [
+		=,
+		waveform = std::move(waveform)
+	]() mutable {
+		const auto voice = document->voice();
+		if (!voice) {
+			return;
 		}
-	}
-	~CountWaveformTask() {
-		if (_data.isEmpty() && _doc) {
-			_loc.accessDisable();
+		if (!waveform.isEmpty()) {
+			if (saveToCache) {
+				document->owner().cache().put(
+					document->waveformCacheKey(),
+					Storage::Cache::Database::TaggedValue(
+						documentWaveformEncode5bit(waveform),
+						Data::kVoiceMessageCacheTag));
+			}
+			voice->wavemax = *ranges::max_element(waveform);
+			voice->waveform = std::move(waveform);
+		} else {
+			voice->waveform.resize(1);
+			voice->waveform[0] = -2;
+			voice->wavemax = 0;
 		}
-	}
-
-protected:
-	DocumentData *_doc;
-	FileLocation _loc;
-	QByteArray _data;
-	VoiceWaveform _waveform;
-	char _wavemax;
+		voice->counting = nullptr;
+		document->owner().requestDocumentViewRepaint(document);
+	});
+}
 
-};
+} // namespace
 
 void countVoiceWaveform(DocumentData *document) {
-	if (const auto voice = document->voice()) {
-		if (_localLoader) {
-			voice->waveform.resize(1 + sizeof(TaskId));
-			voice->waveform[0] = -1; // counting
-			TaskId taskId = _localLoader->addTask(
-				std::make_unique<CountWaveformTask>(document));
-			memcpy(voice->waveform.data() + 1, &taskId, sizeof(taskId));
-		}
-	}
-}
-
-void cancelTask(TaskId id) {
-	if (_localLoader) {
-		_localLoader->cancelTask(id);
+	const auto voice = document->voice();
+	if (!voice || !_localLoader) {
+		return;
 	}
+	voice->waveform.resize(1);
+	voice->waveform[0] = -1; // counting
+
+	auto [left, right] = base::make_binary_guard();
+	voice->counting = std::move(left);
+
+	auto location = document->location(true);
+	const auto data = document->data();
+
+	// Each waveform is counted on its own in the crl::async() pool,
+	// so a chat full of voice notes doesn't wait in a single queue.
+	// Counted waveforms are kept in the cache until the next launch.
+	document->owner().cache().get(document->waveformCacheKey(), [
+		=,
+		guard = std::move(right),
+		location = std::move(location)
+	](QByteArray &&value) mutable {
+		auto cached = value.isEmpty()
+			? VoiceWaveform()
+			: documentWaveformDecode(value);
+		if (!cached.isEmpty()) {
+			WaveformCounted(
+				std::move(guard),
+				document,
+				std::move(cached),
+				false);
+			return;
+		}
+		crl::async([
+			=,
+			guard = std::move(guard),
+			location = std::move(location)
+		]() mutable {
+			auto waveform = VoiceWaveform();
+			if (!data.isEmpty()) {
+				waveform = audioCountWaveform(location, data);
+			} else if (location.accessEnable()) {
+				waveform = audioCountWaveform(location, data);
+				location.accessDisable();
+			}
+			WaveformCounted(
+				std::move(guard),
+				document,
+				std::move(waveform),
+				true);
+		});
+	});
 }
 
 void _writeStickerSet(QDataStream &stream, const Stickers::Set &set) {
@@ -4049,7 +4071,10 @@ void readSavedGifs() {
 	}
 }
 
-void writeBackground(const Data::WallPaper &paper, const QImage &image) {
+void writeBackground(
+		const Data::WallPaper &paper,
+		const QImage &image,
+		std::optional<QColor> averageColor) {
 	if (!_working() || !_backgroundCanWrite) {
 		return;
 	}
@@ -4099,12 +4124,14 @@ void writeBackground(const Data::WallPaper &paper, const QImage &image) {
 	const auto serialized = paper.serialize();
 	quint32 size = sizeof(qint32)
 		+ Serialize::bytearraySize(serialized)
-		+ Serialize::bytearraySize(imageData);
+		+ Serialize::bytearraySize(imageData)
+		+ sizeof(quint32);
 	EncryptedDescriptor data(size);
 	data.stream
 		<< qint32(kWallPaperSerializeTagId)
 		<< serialized
-		<< imageData;
+		<< imageData
+		<< quint32(averageColor ? averageColor->rgb() : 0);
 
 	FileWriteDescriptor file(backgroundKey);
 	file.writeEncrypted(data);
@@ -4158,6 +4185,16 @@ bool readBackground() {
 	QByteArray imageData;
 	bg.stream >> imageData;
 	const auto isOldEmptyImage = (bg.stream.status() != QDataStream::Ok);
+
+	// Older backgrounds were saved without the average color.
+	quint32 averageColorValue = 0;
+	if (!isOldEmptyImage) {
+		bg.stream >> averageColorValue;
+	}
+	const auto averageColor = (bg.stream.status() == QDataStream::Ok
+		&& averageColorValue)
+		? std::make_optional(QColor::fromRgb(averageColorValue))
+		: std::nullopt;
 	if (isOldEmptyImage
 		|| Data::IsLegacy1DefaultWallPaper(*paper)
 		|| Data::IsDefaultWallPaper(*paper)) {
@@ -4166,7 +4203,10 @@ bool readBackground() {
 			Window::Theme::Background()->set(Data::DefaultWallPaper());
 			Window::Theme::Background()->setTile(false);
 		} else {
-			Window::Theme::Background()->set(*paper);
+			Window::Theme::Background()->set(
+				*paper,
+				QImage(),
+				averageColor);
 		}
 		_backgroundCanWrite = true;
 		return true;
@@ -4221,7 +4261,10 @@ bool readBackground() {
 	}
 	if (!image.isNull() || paper->backgroundColor()) {
 		_backgroundCanWrite = false;
-		Window::Theme::Background()->set(*paper, std::move(image));
+		Window::Theme::Background()->set(
+			*paper,
+			std::move(image),
+			averageColor);
 		_backgroundCanWrite = true;
 		return true;
 	}
@@ -124,8 +124,6 @@ Storage::Cache::Database::Settings cacheBigFileSettings();
 
 void countVoiceWaveform(DocumentData *document);
 
-void cancelTask(TaskId id);
-
 void writeInstalledStickers();
 void writeFeaturedStickers();
 void writeRecentStickers();
@@ -145,7 +143,10 @@ void writeSavedGifs();
 void readSavedGifs();
 int32 countSavedGifsHash();
 
-void writeBackground(const Data::WallPaper &paper, const QImage &image);
+void writeBackground(
+	const Data::WallPaper &paper,
+	const QImage &image,
+	std::optional<QColor> averageColor = std::nullopt);
 bool readBackground();
 
 void writeTheme(const Window::Theme::Saved &saved);
@@ -7,6 +7,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "storage/storage_encryption.h"
 
 #include "base/openssl_help.h"
+#include "base/openssl_aes.h"
 
 namespace Storage {
 
@@ -18,31 +19,21 @@ CtrState::CtrState(bytes::const_span key, bytes::const_span iv) {
 	bytes::copy(_iv, iv);
 }
 
-template <typename Method>
-void CtrState::process(bytes::span data, int64 offset, Method method) {
+void CtrState::process(bytes::span data, int64 offset) {
 	Expects((data.size() % kBlockSize) == 0);
 	Expects((offset % kBlockSize) == 0);
 
-	AES_KEY aes;
-	AES_set_encrypt_key(
-		reinterpret_cast<const uchar*>(_key.data()),
-		_key.size() * CHAR_BIT,
-		&aes);
-
 	unsigned char ecountBuf[kBlockSize] = { 0 };
 	unsigned int offsetInBlock = 0;
 	const auto blockIndex = offset / kBlockSize;
 	auto iv = incrementedIv(blockIndex);
 
-	CRYPTO_ctr128_encrypt(
-		reinterpret_cast<const uchar*>(data.data()),
-		reinterpret_cast<uchar*>(data.data()),
-		data.size(),
-		&aes,
+	openssl::AesCtrEncrypt(
+		data,
+		_key,
 		reinterpret_cast<unsigned char*>(iv.data()),
 		ecountBuf,
-		&offsetInBlock,
-		(block128_f)method);
+		&offsetInBlock);
 }
 
 auto CtrState::incrementedIv(int64 blockIndex)
@@ -65,11 +56,11 @@ auto CtrState::incrementedIv(int64 blockIndex)
 }
 
 void CtrState::encrypt(bytes::span data, int64 offset) {
-	return process(data, offset, AES_encrypt);
+	return process(data, offset);
 }
 
 void CtrState::decrypt(bytes::span data, int64 offset) {
-	return process(data, offset, AES_encrypt);
+	return process(data, offset);
 }
 
 EncryptionKey::EncryptionKey(bytes::vector &&data)
@@ -24,8 +24,7 @@ public:
 	void decrypt(bytes::span data, int64 offset);
 
 private:
-	template <typename Method>
-	void process(bytes::span data, int64 offset, Method method);
+	void process(bytes::span data, int64 offset);
 
 	bytes::array<kIvSize> incrementedIv(int64 blockIndex);
 
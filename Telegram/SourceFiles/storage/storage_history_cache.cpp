@@ -0,0 +1,179 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "storage/storage_history_cache.h"
+
+#include "data/data_session.h"
+#include "storage/cache/storage_cache_database.h"
+
+namespace Storage {
+namespace {
+
+constexpr auto kVersion = mtpPrime(3);
+
+// Only the last messages are stored, the rest are loaded when scrolling.
+constexpr auto kMaxMessages = 100;
+
+PeerId PeerFromUser(const MTPUser &user) {
+	switch (user.type()) {
+	case mtpc_user: return peerFromUser(user.c_user().vid);
+	case mtpc_userEmpty: return peerFromUser(user.c_userEmpty().vid);
+	}
+	return 0;
+}
+
+PeerId PeerFromChat(const MTPChat &chat) {
+	switch (chat.type()) {
+	case mtpc_chat: return peerFromChat(chat.c_chat().vid);
+	case mtpc_chatEmpty: return peerFromChat(chat.c_chatEmpty().vid);
+	case mtpc_chatForbidden:
+		return peerFromChat(chat.c_chatForbidden().vid);
+	case mtpc_channel: return peerFromChannel(chat.c_channel().vid);
+	case mtpc_channelForbidden:
+		return peerFromChannel(chat.c_channelForbidden().vid);
+	}
+	return 0;
+}
+
+} // namespace
+
+HistoryCache::HistoryCache(not_null<Data::Session*> owner)
+: _owner(owner) {
+}
+
+void HistoryCache::put(PeerId peerId, const MTPmessages_Messages &data) {
+	const auto save = [&](
+			int count,
+			const MTPVector<MTPMessage> &messages,
+			const MTPVector<MTPUser> &users,
+			const MTPVector<MTPChat> &chats) {
+		if (messages.v.isEmpty()) {
+			remove(peerId);
+			return;
+		}
+		const auto stored = messages.v.mid(0, kMaxMessages);
+
+		// Messages are sorted from the newest one.
+		const auto noSkipRange = MsgRange(
+			(count <= stored.size()) ? 0 : IdFromMessage(stored.back()),
+			IdFromMessage(stored.front()));
+		_owner->cache().put(
+			Data::HistoryCacheKey(peerId),
+			Serialize(noSkipRange, stored, users.v, chats.v));
+	};
+	switch (data.type()) {
+	case mtpc_messages_messages: {
+		const auto &d = data.c_messages_messages();
+		save(d.vmessages.v.size(), d.vmessages, d.vusers, d.vchats);
+	} break;
+	case mtpc_messages_messagesSlice: {
+		const auto &d = data.c_messages_messagesSlice();
+		save(d.vcount.v, d.vmessages, d.vusers, d.vchats);
+	} break;
+	case mtpc_messages_channelMessages: {
+		const auto &d = data.c_messages_channelMessages();
+		save(d.vcount.v, d.vmessages, d.vusers, d.vchats);
+	} break;
+	}
+}
+
+void HistoryCache::remove(PeerId peerId) {
+	_owner->cache().remove(Data::HistoryCacheKey(peerId));
+}
+
+void HistoryCache::get(PeerId peerId, FnMut<void(Slice&&)> done) {
+	const auto weak = base::make_weak(this);
+	_owner->cache().get(Data::HistoryCacheKey(peerId), [
+		=,
+		done = std::move(done)
+	](QByteArray &&serialized) mutable {
+		auto parsed = serialized.isEmpty()
+			? std::nullopt
+			: Parse(serialized);
+		if (!serialized.isEmpty() && !parsed) {
+			LOG(("History Cache Error: bad slice for peer %1.").arg(peerId));
+		}
+		crl::on_main(weak, [
+			=,
+			parsed = std::move(parsed),
+			done = std::move(done)
+		]() mutable {
+			if (parsed) {
+				weak->apply(std::move(*parsed), std::move(done));
+			} else {
+				done(Slice());
+			}
+		});
+	});
+}
+
+void HistoryCache::apply(Parsed &&parsed, FnMut<void(Slice&&)> done) {
+	auto users = QVector<MTPUser>();
+	for (const auto &user : parsed.users) {
+		if (!_owner->peerLoaded(PeerFromUser(user))) {
+			users.push_back(user);
+		}
+	}
+	auto chats = QVector<MTPChat>();
+	for (const auto &chat : parsed.chats) {
+		if (!_owner->peerLoaded(PeerFromChat(chat))) {
+			chats.push_back(chat);
+		}
+	}
+	_owner->processUsers(MTP_vector<MTPUser>(std::move(users)));
+	_owner->processChats(MTP_vector<MTPChat>(std::move(chats)));
+	done(std::move(parsed.slice));
+}
+
+QByteArray HistoryCache::Serialize(
+		MsgRange noSkipRange,
+		const QVector<MTPMessage> &messages,
+		const QVector<MTPUser> &users,
+		const QVector<MTPChat> &chats) {
+	Expects(!messages.isEmpty());
+
+	auto buffer = mtpBuffer();
+	buffer.push_back(kVersion);
+	buffer.push_back(noSkipRange.from);
+	buffer.push_back(noSkipRange.till);
+	MTP_vector<MTPMessage>(messages).write(buffer);
+	MTP_vector<MTPUser>(users).write(buffer);
+	MTP_vector<MTPChat>(chats).write(buffer);
+	return QByteArray(
+		reinterpret_cast<const char*>(buffer.constData()),
+		buffer.size() * sizeof(mtpPrime));
+}
+
+auto HistoryCache::Parse(const QByteArray &serialized)
+-> std::optional<Parsed> {
+	if (serialized.size() % sizeof(mtpPrime)) {
+		return std::nullopt;
+	}
+	auto from = reinterpret_cast<const mtpPrime*>(serialized.constData());
+	const auto end = from + serialized.size() / sizeof(mtpPrime);
+	if (end - from < 3 || *from != kVersion) {
+		return std::nullopt;
+	}
+	auto result = Parsed();
+	result.slice.noSkipRange = MsgRange(from[1], from[2]);
+	from += 3;
+	try {
+		auto messages = MTPvector<MTPMessage>();
+		auto users = MTPvector<MTPUser>();
+		auto chats = MTPvector<MTPChat>();
+		messages.read(from, end);
+		users.read(from, end);
+		chats.read(from, end);
+		result.slice.messages = std::move(messages.v);
+		result.users = std::move(users.v);
+		result.chats = std::move(chats.v);
+	} catch (Exception &) {
+		return std::nullopt;
+	}
+	return (from == end) ? std::make_optional(std::move(result)) : std::nullopt;
+}
+
+} // namespace Storage
@@ -0,0 +1,61 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/weak_ptr.h"
+
+namespace Data {
+class Session;
+} // namespace Data
+
+namespace Storage {
+
+// Keeps the last loaded slice at the bottom of each history in the
+// encrypted local cache database, so that a chat opened after a restart
+// or without connection is shown right away and is checked with the
+// server in the background.
+class HistoryCache final : public base::has_weak_ptr {
+public:
+	struct Slice {
+		QVector<MTPMessage> messages;
+
+		// From zero if the slice is the whole history.
+		MsgRange noSkipRange;
+	};
+
+	explicit HistoryCache(not_null<Data::Session*> owner);
+
+	void put(PeerId peerId, const MTPmessages_Messages &data);
+	void remove(PeerId peerId);
+
+	// The users and chats of the slice are applied before the callback,
+	// but only those which are not loaded yet, the cached ones may be old.
+	// The callback is called on the main thread with an empty slice
+	// if nothing was cached.
+	void get(PeerId peerId, FnMut<void(Slice&&)> done);
+
+private:
+	struct Parsed {
+		Slice slice;
+		QVector<MTPUser> users;
+		QVector<MTPChat> chats;
+	};
+
+	static QByteArray Serialize(
+		MsgRange noSkipRange,
+		const QVector<MTPMessage> &messages,
+		const QVector<MTPUser> &users,
+		const QVector<MTPChat> &chats);
+	static std::optional<Parsed> Parse(const QByteArray &serialized);
+
+	void apply(Parsed &&parsed, FnMut<void(Slice&&)> done);
+
+	const not_null<Data::Session*> _owner;
+
+};
+
+} // namespace Storage
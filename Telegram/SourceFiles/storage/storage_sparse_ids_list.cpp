@@ -9,24 +9,24 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 namespace Storage {
 
 SparseIdsList::Slice::Slice(
-	base::flat_set<MsgId> &&messages,
+	base::chunked_flat_set<MsgId> &&messages,
 	MsgRange range)
 : messages(std::move(messages))
 , range(range) {
 }
 
 template <typename Range>
-void SparseIdsList::Slice::merge(
-		const Range &moreMessages,
+int SparseIdsList::Slice::merge(
+		Range &&moreMessages,
 		MsgRange moreNoSkipRange) {
 	Expects(moreNoSkipRange.from <= range.till);
 	Expects(range.from <= moreNoSkipRange.till);
 
-	messages.merge(std::begin(moreMessages), std::end(moreMessages));
 	range = {
 		qMin(range.from, moreNoSkipRange.from),
 		qMax(range.till, moreNoSkipRange.till)
 	};
+	return messages.merge(std::forward<Range>(moreMessages));
 }
 
 template <typename Range>
@@ -37,15 +37,22 @@ SparseIdsList::AddResult SparseIdsList::uniteAndAdd(
 		const Range &messages,
 		MsgRange noSkipRange) {
 	const auto uniteFromIndex = uniteFrom - _slices.begin();
-	const auto was = int(uniteFrom->messages.size());
+	auto added = 0;
 	_slices.modify(uniteFrom, [&](Slice &slice) {
-		slice.merge(messages, noSkipRange);
+		added = slice.merge(messages, noSkipRange);
 	});
 	const auto firstToErase = uniteFrom + 1;
 	if (firstToErase != uniteTill) {
 		for (auto it = firstToErase; it != uniteTill; ++it) {
+			// Slices don't overlap, so usually the chunks of the following
+			// slices are just moved to the end of the united one.
+			auto more = base::chunked_flat_set<MsgId>();
+			const auto moreRange = it->range;
+			_slices.modify(it, [&](Slice &slice) {
+				more = std::move(slice.messages);
+			});
 			_slices.modify(uniteFrom, [&](Slice &slice) {
-				slice.merge(it->messages, it->range);
+				slice.merge(std::move(more), moreRange);
 			});
 		}
 		_slices.erase(firstToErase, uniteTill);
@@ -54,7 +61,7 @@ SparseIdsList::AddResult SparseIdsList::uniteAndAdd(
 	update.messages = &uniteFrom->messages;
 	update.range = uniteFrom->range;
 	const auto count = int(uniteFrom->messages.size());
-	return { count, count - was };
+	return { count, added };
 }
 
 template <typename Range>
@@ -78,9 +85,8 @@ SparseIdsList::AddResult SparseIdsList::addRangeItemsAndCountNew(
 		return uniteAndAdd(update, uniteFrom, uniteTill, messages, noSkipRange);
 	}
 
-	auto sliceMessages = base::flat_set<MsgId> {
-		std::begin(messages),
-		std::end(messages) };
+	auto sliceMessages = base::chunked_flat_set<MsgId>();
+	sliceMessages.merge(messages);
 	auto slice = _slices.emplace(
 		std::move(sliceMessages),
 		noSkipRange
@@ -158,7 +164,9 @@ void SparseIdsList::removeOne(MsgId messageId) {
 
 void SparseIdsList::removeAll() {
 	_slices.clear();
-	_slices.emplace(base::flat_set<MsgId>{}, MsgRange { 0, ServerMaxMsgId });
+	_slices.emplace(
+		base::chunked_flat_set<MsgId>(),
+		MsgRange { 0, ServerMaxMsgId });
 	_count = 0;
 }
 
@@ -207,12 +215,14 @@ SparseIdsListResult SparseIdsList::queryFromSlice(
 		const SparseIdsListQuery &query,
 		const Slice &slice) const {
 	auto result = SparseIdsListResult {};
-	auto position = ranges::lower_bound(slice.messages, query.aroundId);
-	auto haveBefore = int(position - slice.messages.begin());
-	auto haveEqualOrAfter = int(slice.messages.end() - position);
+	auto position = slice.messages.lower_bound_index(query.aroundId);
+	auto haveBefore = position;
+	auto haveEqualOrAfter = slice.messages.size() - position;
 	auto before = qMin(haveBefore, query.limitBefore);
 	auto equalOrAfter = qMin(haveEqualOrAfter, query.limitAfter + 1);
-	auto ids = std::vector<MsgId>(position - before, position + equalOrAfter);
+	auto ids = slice.messages.slice(
+		position - before,
+		position + equalOrAfter);
 	result.messageIds.merge(ids.begin(), ids.end());
 	if (slice.range.from == 0) {
 		result.skippedBefore = haveBefore - before;
@@ -6,6 +6,8 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 */
 #pragma once
 
+#include "base/chunked_flat_set.h"
+
 namespace Storage {
 
 struct SparseIdsListQuery {
@@ -32,7 +34,7 @@ struct SparseIdsListResult {
 };
 
 struct SparseIdsSliceUpdate {
-	const base::flat_set<MsgId> *messages = nullptr;
+	const base::chunked_flat_set<MsgId> *messages = nullptr;
 	MsgRange range;
 	std::optional<int> count;
 };
@@ -53,12 +55,12 @@ public:
 
 private:
 	struct Slice {
-		Slice(base::flat_set<MsgId> &&messages, MsgRange range);
+		Slice(base::chunked_flat_set<MsgId> &&messages, MsgRange range);
 
 		template <typename Range>
-		void merge(const Range &moreMessages, MsgRange moreNoSkipRange);
+		int merge(Range &&moreMessages, MsgRange moreNoSkipRange);
 
-		base::flat_set<MsgId> messages;
+		base::chunked_flat_set<MsgId> messages;
 		MsgRange range;
 
 		inline bool operator<(const Slice &other) const {
@@ -14,6 +14,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "base/openssl_help.h"
 #include "base/parse_helper.h"
 #include "auth_session.h"
+#include "core/memory_budget.h"
 
 namespace Ui {
 namespace Emoji {
@@ -41,6 +42,7 @@ const auto kSets = {
 class Instance {
 public:
 	explicit Instance(int size);
+	~Instance();
 
 	bool cached() const;
 	void draw(QPainter &p, EmojiPtr emoji, int x, int y);
@@ -50,6 +52,7 @@ private:
 	void generateCache();
 	void checkUniversalImages();
 	void pushSprite(QImage &&data);
+	void clearSprites();
 
 	int _id = 0;
 	int _size = 0;
@@ -61,6 +64,7 @@ private:
 class UniversalImages {
 public:
 	explicit UniversalImages(int id);
+	~UniversalImages();
 
 	int id() const;
 	bool ensureLoaded();
@@ -90,6 +94,26 @@ auto Updates = rpl::event_stream<>();
 auto MainEmojiMap = std::map<int, QPixmap>();
 auto OtherEmojiMap = std::map<int, std::map<int, QPixmap>>();
 
+template <typename Sprite>
+int64 SpriteUsage(const Sprite &sprite) {
+	return int64(sprite.width()) * sprite.height() * 4;
+}
+
+template <typename Sprites>
+int64 SpritesUsage(const Sprites &sprites) {
+	auto result = int64(0);
+	for (const auto &sprite : sprites) {
+		result += SpriteUsage(sprite);
+	}
+	return result;
+}
+
+void CountSpritesUsage(int64 amount) {
+	Core::MemoryBudget::Instance().increment(
+		Core::MemoryKind::EmojiSprites,
+		amount);
+}
+
 int RowsCount(int index) {
 	if (index + 1 < SpritesCount) {
 		return kImageRowsPerSprite;
@@ -368,13 +392,19 @@ bool UniversalImages::ensureLoaded() {
 		return true;
 	}
 	_sprites = LoadAndValidateSprites(_id);
+	CountSpritesUsage(SpritesUsage(_sprites));
 	return !_sprites.empty();
 }
 
 void UniversalImages::clear() {
+	CountSpritesUsage(-SpritesUsage(_sprites));
 	_sprites.clear();
 }
 
+UniversalImages::~UniversalImages() {
+	clear();
+}
+
 void UniversalImages::draw(
 		QPainter &p,
 		EmojiPtr emoji,
@@ -889,6 +919,10 @@ Instance::Instance(int size) : _id(Universal->id()), _size(size) {
 	}
 }
 
+Instance::~Instance() {
+	clearSprites();
+}
+
 bool Instance::cached() const {
 	Expects(Universal != nullptr);
 
@@ -927,7 +961,7 @@ void Instance::checkUniversalImages() {
 	if (_id != Universal->id()) {
 		_id = Universal->id();
 		_generating = nullptr;
-		_sprites.clear();
+		clearSprites();
 	}
 	if (!Universal->ensureLoaded() && Universal->id() != 0) {
 		ClearCurrentSetIdSync();
@@ -966,6 +1000,12 @@ void Instance::generateCache() {
 void Instance::pushSprite(QImage &&data) {
 	_sprites.push_back(App::pixmapFromImageInPlace(std::move(data)));
 	_sprites.back().setDevicePixelRatio(cRetinaFactor());
+	CountSpritesUsage(SpriteUsage(_sprites.back()));
+}
+
+void Instance::clearSprites() {
+	CountSpritesUsage(-SpritesUsage(_sprites));
+	_sprites.clear();
 }
 
 } // namespace Emoji
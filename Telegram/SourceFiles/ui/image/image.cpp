@@ -7,6 +7,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "ui/image/image.h"
 
 #include "ui/image/image_source.h"
+#include "ui/paint_stats.h"
 #include "core/media_active_cache.h"
 #include "storage/cache/storage_cache_database.h"
 #include "data/data_session.h"
@@ -18,8 +19,11 @@ using namespace Images;
 namespace Images {
 namespace {
 
-// After 128 MB of unpacked images we try to clear some memory.
-constexpr auto kMemoryForCache = 128 * 1024 * 1024;
+// Smaller pixmaps are prepared right in the paint call.
+constexpr auto kAsyncRenderMinArea = 160 * 160;
+
+// Placeholders are prepared from an image this times smaller.
+constexpr auto kPlaceholderDivider = 4;
 
 QMap<QString, Image*> LocalFileImages;
 QMap<QString, Image*> WebUrlImages;
@@ -27,6 +31,9 @@ QMap<StorageKey, Image*> StorageImages;
 QMap<StorageKey, Image*> WebCachedImages;
 QMap<StorageKey, Image*> GeoPointImages;
 
+RenderCounters Counters;
+bool RenderedNotifyScheduled = false;
+
 int64 ComputeUsage(QSize size) {
 	return int64(size.width()) * size.height() * 4;
 }
@@ -41,11 +48,20 @@ int64 ComputeUsage(const QImage &image) {
 
 [[nodiscard]] Core::MediaActiveCache<const Image> &ActiveCache() {
 	static auto Instance = Core::MediaActiveCache<const Image>(
-		kMemoryForCache,
+		Core::MemoryKind::ImageOriginals,
 		[](const Image *image) { image->unload(); });
 	return Instance;
 }
 
+// Scaled pixmaps are cheap to prepare again from the loaded original,
+// so they are unloaded separately and before the originals.
+[[nodiscard]] Core::MediaActiveCache<const Image> &ScaledCache() {
+	static auto Instance = Core::MediaActiveCache<const Image>(
+		Core::MemoryKind::ScaledPixmaps,
+		[](const Image *image) { image->unloadScaled(); });
+	return Instance;
+}
+
 uint64 PixKey(int width, int height, Options options) {
 	return static_cast<uint64>(width)
 		| (static_cast<uint64>(height) << 24)
@@ -56,8 +72,48 @@ uint64 SinglePixKey(Options options) {
 	return PixKey(0, 0, options);
 }
 
+bool IsSinglePixKey(uint64 key) {
+	return !(key & 0xFFFFFFFFFFFFULL);
+}
+
+QSize RenderedSize(const QImage &original, int w, int h) {
+	if (w <= 0 || (w == original.width() && (h <= 0 || h == original.height()))) {
+		return original.size();
+	} else if (h <= 0) {
+		return QSize(w, qMax(qRound(original.height() * w / float64(original.width())), 1));
+	}
+	return QSize(w, h);
+}
+
+bool AsyncRenderAllowed(const QImage &original, QSize size, Options options) {
+	// Circle masks are QPixmaps, they can't be used outside of the main thread.
+	if (options & Option::Circled) {
+		return false;
+	} else if (size.width() * size.height() < kAsyncRenderMinArea) {
+		return false;
+	}
+	return (size != original.size()) || (options & Option::Blurred);
+}
+
+void NotifyRendered() {
+	if (RenderedNotifyScheduled) {
+		return;
+	}
+	RenderedNotifyScheduled = true;
+	crl::on_main([] {
+		RenderedNotifyScheduled = false;
+		if (AuthSession::Exists()) {
+			Auth().downloaderTaskFinished().notify();
+		}
+	});
+}
+
 } // namespace
 
+RenderCounters GetRenderCounters() {
+	return Counters;
+}
+
 void ClearRemote() {
 	for (auto image : base::take(StorageImages)) {
 		delete image;
@@ -75,6 +131,7 @@ void ClearRemote() {
 
 void ClearAll() {
 	ActiveCache().clear();
+	ScaledCache().clear();
 	for (auto image : base::take(LocalFileImages)) {
 		delete image;
 	}
@@ -389,11 +446,15 @@ const QPixmap &Image::pix(
 	auto k = PixKey(w, h, options);
 	auto i = _sizesCache.constFind(k);
 	if (i == _sizesCache.cend()) {
-		auto p = pixNoCache(origin, w, h, options);
-        p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		auto p = pixAsync(origin, k, w, h, options);
+		if (!p) {
+			p = pixNoCache(origin, w, h, options);
+		}
+		p->setDevicePixelRatio(cRetinaFactor());
+		i = _sizesCache.insert(k, *p);
+		ScaledCache().increment(ComputeUsage(*i));
 	}
+	ScaledCache().up(this);
 	return i.value();
 }
 
@@ -428,11 +489,15 @@ const QPixmap &Image::pixRounded(
 	auto k = PixKey(w, h, options);
 	auto i = _sizesCache.constFind(k);
 	if (i == _sizesCache.cend()) {
-		auto p = pixNoCache(origin, w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		auto p = pixAsync(origin, k, w, h, options);
+		if (!p) {
+			p = pixNoCache(origin, w, h, options);
+		}
+		p->setDevicePixelRatio(cRetinaFactor());
+		i = _sizesCache.insert(k, *p);
+		ScaledCache().increment(ComputeUsage(*i));
 	}
+	ScaledCache().up(this);
 	return i.value();
 }
 
@@ -452,11 +517,15 @@ const QPixmap &Image::pixCircled(
 	auto k = PixKey(w, h, options);
 	auto i = _sizesCache.constFind(k);
 	if (i == _sizesCache.cend()) {
-		auto p = pixNoCache(origin, w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		auto p = pixAsync(origin, k, w, h, options);
+		if (!p) {
+			p = pixNoCache(origin, w, h, options);
+		}
+		p->setDevicePixelRatio(cRetinaFactor());
+		i = _sizesCache.insert(k, *p);
+		ScaledCache().increment(ComputeUsage(*i));
 	}
+	ScaledCache().up(this);
 	return i.value();
 }
 
@@ -476,11 +545,15 @@ const QPixmap &Image::pixBlurredCircled(
 	auto k = PixKey(w, h, options);
 	auto i = _sizesCache.constFind(k);
 	if (i == _sizesCache.cend()) {
-		auto p = pixNoCache(origin, w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		auto p = pixAsync(origin, k, w, h, options);
+		if (!p) {
+			p = pixNoCache(origin, w, h, options);
+		}
+		p->setDevicePixelRatio(cRetinaFactor());
+		i = _sizesCache.insert(k, *p);
+		ScaledCache().increment(ComputeUsage(*i));
 	}
+	ScaledCache().up(this);
 	return i.value();
 }
 
@@ -500,11 +573,15 @@ const QPixmap &Image::pixBlurred(
 	auto k = PixKey(w, h, options);
 	auto i = _sizesCache.constFind(k);
 	if (i == _sizesCache.cend()) {
-		auto p = pixNoCache(origin, w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		auto p = pixAsync(origin, k, w, h, options);
+		if (!p) {
+			p = pixNoCache(origin, w, h, options);
+		}
+		p->setDevicePixelRatio(cRetinaFactor());
+		i = _sizesCache.insert(k, *p);
+		ScaledCache().increment(ComputeUsage(*i));
 	}
+	ScaledCache().up(this);
 	return i.value();
 }
 
@@ -525,11 +602,15 @@ const QPixmap &Image::pixColored(
 	auto k = PixKey(w, h, options);
 	auto i = _sizesCache.constFind(k);
 	if (i == _sizesCache.cend()) {
-		auto p = pixColoredNoCache(origin, add, w, h, true);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		auto p = pixAsync(origin, k, w, h, options, -1, -1, &add);
+		if (!p) {
+			p = pixColoredNoCache(origin, add, w, h, true);
+		}
+		p->setDevicePixelRatio(cRetinaFactor());
+		i = _sizesCache.insert(k, *p);
+		ScaledCache().increment(ComputeUsage(*i));
 	}
+	ScaledCache().up(this);
 	return i.value();
 }
 
@@ -550,11 +631,15 @@ const QPixmap &Image::pixBlurredColored(
 	auto k = PixKey(w, h, options);
 	auto i = _sizesCache.constFind(k);
 	if (i == _sizesCache.cend()) {
-		auto p = pixBlurredColoredNoCache(origin, add, w, h);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		auto p = pixAsync(origin, k, w, h, options, -1, -1, &add);
+		if (!p) {
+			p = pixBlurredColoredNoCache(origin, add, w, h);
+		}
+		p->setDevicePixelRatio(cRetinaFactor());
+		i = _sizesCache.insert(k, *p);
+		ScaledCache().increment(ComputeUsage(*i));
 	}
+	ScaledCache().up(this);
 	return i.value();
 }
 
@@ -598,13 +683,25 @@ const QPixmap &Image::pixSingle(
 	auto i = _sizesCache.constFind(k);
 	if (i == _sizesCache.cend() || i->width() != (outerw * cIntRetinaFactor()) || i->height() != (outerh * cIntRetinaFactor())) {
 		if (i != _sizesCache.cend()) {
-			ActiveCache().decrement(ComputeUsage(*i));
+			ScaledCache().decrement(ComputeUsage(*i));
 		}
-		auto p = pixNoCache(origin, w, h, options, outerw, outerh, colored);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		auto p = pixAsync(
+			origin,
+			k,
+			w,
+			h,
+			options,
+			outerw,
+			outerh,
+			colored);
+		if (!p) {
+			p = pixNoCache(origin, w, h, options, outerw, outerh, colored);
+		}
+		p->setDevicePixelRatio(cRetinaFactor());
+		i = _sizesCache.insert(k, *p);
+		ScaledCache().increment(ComputeUsage(*i));
 	}
+	ScaledCache().up(this);
 	return i.value();
 }
 
@@ -644,13 +741,17 @@ const QPixmap &Image::pixBlurredSingle(
 	auto i = _sizesCache.constFind(k);
 	if (i == _sizesCache.cend() || i->width() != (outerw * cIntRetinaFactor()) || i->height() != (outerh * cIntRetinaFactor())) {
 		if (i != _sizesCache.cend()) {
-			ActiveCache().decrement(ComputeUsage(*i));
+			ScaledCache().decrement(ComputeUsage(*i));
+		}
+		auto p = pixAsync(origin, k, w, h, options, outerw, outerh);
+		if (!p) {
+			p = pixNoCache(origin, w, h, options, outerw, outerh);
 		}
-		auto p = pixNoCache(origin, w, h, options, outerw, outerh);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		p->setDevicePixelRatio(cRetinaFactor());
+		i = _sizesCache.insert(k, *p);
+		ScaledCache().increment(ComputeUsage(*i));
 	}
+	ScaledCache().up(this);
 	return i.value();
 }
 
@@ -662,6 +763,7 @@ QPixmap Image::pixNoCache(
 		int outerw,
 		int outerh,
 		const style::color *colored) const {
+	Ui::PaintStats::CountPixNoCache();
 	if (!loading()) {
 		const_cast<Image*>(this)->load(origin);
 	}
@@ -714,6 +816,7 @@ QPixmap Image::pixNoCache(
 		return App::pixmapFromImageInPlace(std::move(result));
 	}
 
+	++Counters.sync;
 	return App::pixmapFromImageInPlace(prepare(_data, w, h, options, outerw, outerh, colored));
 }
 
@@ -732,6 +835,7 @@ QPixmap Image::pixColoredNoCache(
 		return Empty()->pix(origin);
 	}
 
+	++Counters.sync;
 	auto img = _data;
 	if (w <= 0 || !width() || !height() || (w == width() && (h <= 0 || h == height()))) {
 		return App::pixmapFromImageInPlace(prepareColored(add, std::move(img)));
@@ -756,6 +860,7 @@ QPixmap Image::pixBlurredColoredNoCache(
 		return Empty()->pix(origin);
 	}
 
+	++Counters.sync;
 	auto img = prepareBlur(_data);
 	if (h <= 0) {
 		img = img.scaledToWidth(w, Qt::SmoothTransformation);
@@ -766,6 +871,137 @@ QPixmap Image::pixBlurredColoredNoCache(
 	return App::pixmapFromImageInPlace(prepareColored(add, img));
 }
 
+std::optional<QPixmap> Image::pixAsync(
+		Data::FileOrigin origin,
+		uint64 key,
+		int w,
+		int h,
+		Options options,
+		int outerw,
+		int outerh,
+		const style::color *colored) const {
+	// A newer request for the same key replaces the pending one.
+	_pixRendering.remove(key);
+
+	if (!loading()) {
+		const_cast<Image*>(this)->load(origin);
+	}
+	checkSource();
+
+	if (_data.isNull() || isNull()) {
+		return std::nullopt;
+	}
+	const auto size = RenderedSize(_data, w, h);
+	if (!AsyncRenderAllowed(_data, size, options)) {
+		return std::nullopt;
+	}
+
+	// The color may be a temporary of the caller, keep a copy for the worker.
+	const auto color = colored
+		? std::make_optional(*colored)
+		: std::nullopt;
+	auto [left, right] = base::make_binary_guard();
+	_pixRendering.emplace(key, std::move(left));
+	crl::async([
+		=,
+		original = _data,
+		guard = std::move(right)
+	]() mutable {
+		auto result = prepare(
+			std::move(original),
+			w,
+			h,
+			options,
+			outerw,
+			outerh,
+			color ? &*color : nullptr);
+		crl::on_main(std::move(guard), [
+			=,
+			result = std::move(result)
+		]() mutable {
+			pixRendered(key, std::move(result));
+		});
+	});
+	++Counters.async;
+
+	return pixPlaceholder(
+		key,
+		size,
+		w,
+		h,
+		options,
+		outerw,
+		outerh,
+		color ? &*color : nullptr);
+}
+
+QPixmap Image::pixPlaceholder(
+		uint64 key,
+		QSize size,
+		int w,
+		int h,
+		Options options,
+		int outerw,
+		int outerh,
+		const style::color *colored) const {
+	if (!IsSinglePixKey(key)) {
+		// The nearest ready size with the same options is the best one.
+		auto nearest = _sizesCache.cend();
+		auto nearestDistance = std::numeric_limits<int>::max();
+		for (auto i = _sizesCache.cbegin(); i != _sizesCache.cend(); ++i) {
+			if (IsSinglePixKey(i.key())
+				|| (i.key() >> 48) != (key >> 48)
+				|| _pixRendering.contains(i.key())) {
+				continue;
+			}
+			const auto distance = std::abs(i->width() - size.width());
+			if (distance < nearestDistance) {
+				nearest = i;
+				nearestDistance = distance;
+			}
+		}
+		if (nearest != _sizesCache.cend()) {
+			++Counters.placeholdersFromCache;
+			return nearest->scaled(
+				size,
+				Qt::IgnoreAspectRatio,
+				Qt::FastTransformation);
+		}
+	}
+
+	// Otherwise prepare it from a much smaller copy of the original,
+	// blurred options give a blurred placeholder in the same way.
+	const auto small = _data.scaled(
+		qMax(size.width() / kPlaceholderDivider, 1),
+		qMax(size.height() / kPlaceholderDivider, 1),
+		Qt::IgnoreAspectRatio,
+		Qt::FastTransformation);
+	return App::pixmapFromImageInPlace(prepare(
+		small,
+		size.width(),
+		(h > 0) ? h : size.height(),
+		options,
+		outerw,
+		outerh,
+		colored));
+}
+
+void Image::pixRendered(uint64 key, QImage &&image) const {
+	_pixRendering.remove(key);
+
+	const auto i = _sizesCache.find(key);
+	if (i == _sizesCache.end()) {
+		return;
+	}
+	auto &cache = ScaledCache();
+	cache.decrement(ComputeUsage(*i));
+	*i = App::pixmapFromImageInPlace(std::move(image));
+	i->setDevicePixelRatio(cRetinaFactor());
+	cache.increment(ComputeUsage(*i));
+
+	NotifyRendered();
+}
+
 QImage Image::original() const {
 	checkSource();
 	return _data;
@@ -821,6 +1057,10 @@ void Image::unload() const {
 	_data = QImage();
 }
 
+void Image::unloadScaled() const {
+	invalidateSizeCache();
+}
+
 void Image::setDelayedStorageLocation(
 		Data::FileOrigin origin,
 		const StorageImageLocation &location) {
@@ -836,7 +1076,9 @@ void Image::setImageBytes(const QByteArray &bytes) {
 }
 
 void Image::invalidateSizeCache() const {
-	auto &cache = ActiveCache();
+	_pixRendering.clear();
+
+	auto &cache = ScaledCache();
 	for (const auto &image : std::as_const(_sizesCache)) {
 		cache.decrement(ComputeUsage(image));
 	}
@@ -847,5 +1089,6 @@ Image::~Image() {
 	if (this != Empty() && this != BlankMedia()) {
 		unload();
 		ActiveCache().remove(this);
+		ScaledCache().remove(this);
 	}
 }
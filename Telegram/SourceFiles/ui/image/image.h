@@ -7,6 +7,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #pragma once
 
 #include "ui/image/image_prepare.h"
+#include "base/binary_guard.h"
 
 class HistoryItem;
 
@@ -42,6 +43,15 @@ ImagePtr Create(
 	int size = 0);
 ImagePtr Create(const GeoPointLocation &location);
 
+// Large scaled or blurred pixmaps are prepared in the crl::async() pool,
+// until they're ready the cache holds a cheap placeholder of the same size.
+struct RenderCounters {
+	int64 sync = 0;
+	int64 async = 0;
+	int64 placeholdersFromCache = 0;
+};
+[[nodiscard]] RenderCounters GetRenderCounters();
+
 class Source {
 public:
 	Source() = default;
@@ -231,7 +241,15 @@ public:
 
 	bool loaded() const;
 	bool isNull() const;
+
+	// Some of the pix*() results are placeholders until the exact pixmaps
+	// are prepared in the background, then downloaderTaskFinished() fires.
+	bool rendering() const {
+		return !_pixRendering.empty();
+	}
+
 	void unload() const;
+	void unloadScaled() const;
 	void setDelayedStorageLocation(
 		Data::FileOrigin origin,
 		const StorageImageLocation &location);
@@ -243,8 +261,29 @@ private:
 	void checkSource() const;
 	void invalidateSizeCache() const;
 
+	std::optional<QPixmap> pixAsync(
+		Data::FileOrigin origin,
+		uint64 key,
+		int w,
+		int h,
+		Images::Options options,
+		int outerw = -1,
+		int outerh = -1,
+		const style::color *colored = nullptr) const;
+	QPixmap pixPlaceholder(
+		uint64 key,
+		QSize size,
+		int w,
+		int h,
+		Images::Options options,
+		int outerw,
+		int outerh,
+		const style::color *colored) const;
+	void pixRendered(uint64 key, QImage &&image) const;
+
 	std::unique_ptr<Images::Source> _source;
 	mutable QMap<uint64, QPixmap> _sizesCache;
+	mutable base::flat_map<uint64, base::binary_guard> _pixRendering;
 	mutable QImage _data;
 
 };
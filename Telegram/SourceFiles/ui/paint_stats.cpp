@@ -0,0 +1,276 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#include "ui/paint_stats.h"
+
+#include "ui/rp_widget.h"
+#include "ui/image/image.h"
+#include "mainwindow.h"
+#include "base/timer.h"
+#include "styles/style_widgets.h"
+
+#include <chrono>
+
+namespace Ui {
+namespace PaintStats {
+namespace {
+
+constexpr auto kOverlayPeriod = crl::time(1000);
+constexpr auto kLogPeriods = 10;
+constexpr auto kShownNamesCount = 12;
+
+struct NameCompare {
+	bool operator()(const char *a, const char *b) const {
+		return strcmp(a, b) < 0;
+	}
+};
+
+struct Paint {
+	int count = 0;
+	int64 total = 0;
+	int64 longest = 0;
+};
+
+struct Counters {
+	std::map<const char*, Paint, NameCompare> paints;
+	int frames = 0;
+	int layouts = 0;
+	int textDraws = 0;
+	int textHeightsCached = 0;
+	int textHeightsCounted = 0;
+	int pixNoCache = 0;
+	int64 renderSync = 0;
+	int64 renderAsync = 0;
+	int64 placeholdersFromCache = 0;
+};
+
+class Overlay final : public RpWidget {
+public:
+	explicit Overlay(QWidget *parent);
+
+	void setLines(QStringList lines);
+
+private:
+	QStringList _lines;
+
+};
+
+struct State {
+	Counters period;
+	Counters logged;
+	Images::RenderCounters rendered;
+	int loggedPeriods = 0;
+	base::Timer timer;
+	QPointer<Overlay> overlay;
+};
+
+bool EnabledValue = false;
+State *GlobalState = nullptr;
+
+int64 Now() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Accumulate(Counters &to, const Counters &from) {
+	for (const auto &[name, paint] : from.paints) {
+		auto &already = to.paints[name];
+		already.count += paint.count;
+		already.total += paint.total;
+		accumulate_max(already.longest, paint.longest);
+	}
+	to.frames += from.frames;
+	to.layouts += from.layouts;
+	to.textDraws += from.textDraws;
+	to.textHeightsCached += from.textHeightsCached;
+	to.textHeightsCounted += from.textHeightsCounted;
+	to.pixNoCache += from.pixNoCache;
+	to.renderSync += from.renderSync;
+	to.renderAsync += from.renderAsync;
+	to.placeholdersFromCache += from.placeholdersFromCache;
+}
+
+QStringList Format(const Counters &counters) {
+	auto result = QStringList();
+	const auto frames = std::max(counters.frames, 1);
+	const auto heights = counters.textHeightsCached
+		+ counters.textHeightsCounted;
+	result.push_back(qsl("frames: %1, layouts per frame: %2"
+		).arg(counters.frames
+		).arg(counters.layouts / float64(frames), 0, 'f', 1));
+	result.push_back(qsl("text draws: %1, heights: %2, cached: %3%"
+		).arg(counters.textDraws
+		).arg(heights
+		).arg(heights
+			? (100 * counters.textHeightsCached / heights)
+			: 100));
+	result.push_back(qsl("pixNoCache: %1").arg(counters.pixNoCache));
+	result.push_back(qsl("renders sync: %1, async: %2, placeholders: %3"
+		).arg(counters.renderSync
+		).arg(counters.renderAsync
+		).arg(counters.placeholdersFromCache));
+
+	auto paints = std::vector<std::pair<const char*, Paint>>(
+		counters.paints.begin(),
+		counters.paints.end());
+	ranges::sort(paints, ranges::greater(), [](const auto &pair) {
+		return pair.second.total;
+	});
+	if (paints.size() > kShownNamesCount) {
+		paints.erase(paints.begin() + kShownNamesCount, paints.end());
+	}
+	for (const auto &[name, paint] : paints) {
+		result.push_back(qsl("%1: %2 x %3 ms, max %4 ms"
+			).arg(name
+			).arg(paint.count
+			).arg(paint.total / (1000. * paint.count), 0, 'f', 2
+			).arg(paint.longest / 1000., 0, 'f', 2));
+	}
+	return result;
+}
+
+Overlay::Overlay(QWidget *parent) : RpWidget(parent) {
+	setAttribute(Qt::WA_TransparentForMouseEvents);
+	paintRequest(
+	) | rpl::start_with_next([=] {
+		Painter p(this);
+		p.fillRect(rect(), QColor(0, 0, 0, 192));
+		p.setFont(st::normalFont);
+		p.setPen(QColor(255, 255, 255));
+		const auto skip = st::normalFont->height / 2;
+		auto top = skip;
+		for (const auto &line : _lines) {
+			p.drawTextLeft(skip, top, width(), line);
+			top += st::normalFont->height;
+		}
+	}, lifetime());
+}
+
+void Overlay::setLines(QStringList lines) {
+	_lines = std::move(lines);
+	const auto skip = st::normalFont->height / 2;
+	auto width = 0;
+	for (const auto &line : _lines) {
+		accumulate_max(width, st::normalFont->width(line));
+	}
+	resize(
+		width + 2 * skip,
+		_lines.size() * st::normalFont->height + 2 * skip);
+	raise();
+	update();
+}
+
+void ShowOverlay(State &state) {
+	const auto window = App::wnd();
+	if (!window) {
+		return;
+	}
+	if (!state.overlay) {
+		state.overlay = new Overlay(window->bodyWidget());
+		state.overlay->move(0, 0);
+		state.overlay->show();
+	}
+	state.overlay->setLines(Format(state.period));
+}
+
+void CollectRendered(State &state) {
+	const auto now = Images::GetRenderCounters();
+	state.period.renderSync = now.sync - state.rendered.sync;
+	state.period.renderAsync = now.async - state.rendered.async;
+	state.period.placeholdersFromCache = now.placeholdersFromCache
+		- state.rendered.placeholdersFromCache;
+	state.rendered = now;
+}
+
+void Collect() {
+	auto &state = *GlobalState;
+	CollectRendered(state);
+	ShowOverlay(state);
+	Accumulate(state.logged, state.period);
+	state.period = Counters();
+	if (++state.loggedPeriods == kLogPeriods) {
+		LOG(("Paint Stats: %1").arg(Format(state.logged).join(qsl("; "))));
+		state.logged = Counters();
+		state.loggedPeriods = 0;
+	}
+}
+
+} // namespace
+
+bool Enabled() {
+	return EnabledValue;
+}
+
+void SetEnabled(bool enabled) {
+	if (EnabledValue == enabled) {
+		return;
+	}
+	EnabledValue = enabled;
+	if (enabled) {
+		GlobalState = new State();
+		GlobalState->rendered = Images::GetRenderCounters();
+		GlobalState->timer.setCallback(Collect);
+		GlobalState->timer.callEach(kOverlayPeriod);
+	} else {
+		if (GlobalState->overlay) {
+			delete GlobalState->overlay.data();
+		}
+		delete base::take(GlobalState);
+	}
+}
+
+Measure::Measure(const char *name) {
+	if (EnabledValue && name) {
+		_name = name;
+		_start = Now();
+	}
+}
+
+Measure::~Measure() {
+	if (!_name || !EnabledValue) {
+		return;
+	}
+	const auto duration = Now() - _start;
+	auto &paint = GlobalState->period.paints[_name];
+	++paint.count;
+	paint.total += duration;
+	accumulate_max(paint.longest, duration);
+}
+
+void CountFrame() {
+	if (EnabledValue) {
+		++GlobalState->period.frames;
+	}
+}
+
+void CountLayout() {
+	if (EnabledValue) {
+		++GlobalState->period.layouts;
+	}
+}
+
+void CountTextDraw() {
+	if (EnabledValue) {
+		++GlobalState->period.textDraws;
+	}
+}
+
+void CountTextHeight(bool cached) {
+	if (EnabledValue) {
+		++(cached
+			? GlobalState->period.textHeightsCached
+			: GlobalState->period.textHeightsCounted);
+	}
+}
+
+void CountPixNoCache() {
+	if (EnabledValue) {
+		++GlobalState->period.pixNoCache;
+	}
+}
+
+} // namespace PaintStats
+} // namespace Ui
@@ -0,0 +1,45 @@
+/*
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Ui {
+namespace PaintStats {
+
+// Opt-in paint and layout counters for finding the costly frames.
+//
+// Enabled by typing "paintstats" in Settings. While enabled, the counters
+// of the last second are shown in an overlay over the main window and the
+// counters of each ten seconds are written to the log. Everything is
+// counted on the main thread only.
+[[nodiscard]] bool Enabled();
+void SetEnabled(bool enabled);
+
+// Paint time of a widget or of a message type.
+class Measure final {
+public:
+	// Name should be a string literal or other static string,
+	// nullptr skips the measuring.
+	explicit Measure(const char *name);
+	Measure(const Measure &other) = delete;
+	Measure &operator=(const Measure &other) = delete;
+	~Measure();
+
+private:
+	const char *_name = nullptr;
+	int64 _start = 0;
+
+};
+
+// Paint of a chats list or of a history widget.
+void CountFrame();
+void CountLayout();
+void CountTextDraw();
+void CountTextHeight(bool cached);
+void CountPixNoCache();
+
+} // namespace PaintStats
+} // namespace Ui
@@ -12,6 +12,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "core/crash_reports.h"
 #include "ui/text/text_block.h"
 #include "ui/emoji_config.h"
+#include "ui/paint_stats.h"
 #include "lang/lang_keys.h"
 #include "platform/platform_specific.h"
 #include "boxes/confirm_box.h"
@@ -2788,8 +2789,10 @@ int Text::countWidth(int width) const {
 
 int Text::countHeight(int width) const {
 	if (QFixed(width) >= _maxWidth) {
+		Ui::PaintStats::CountTextHeight(true);
 		return _minHeight;
 	}
+	Ui::PaintStats::CountTextHeight(false);
 	int result = 0;
 	enumerateLines(width, [&result](QFixed lineWidth, int lineHeight) {
 		result += lineHeight;
@@ -2915,12 +2918,14 @@ void Text::enumerateLines(int w, Callback callback) const {
 
 void Text::draw(Painter &painter, int32 left, int32 top, int32 w, style::align align, int32 yFrom, int32 yTo, TextSelection selection, bool fullWidthSelection) const {
 //	painter.fillRect(QRect(left, top, w, countHeight(w)), QColor(0, 0, 0, 32)); // debug
+	Ui::PaintStats::CountTextDraw();
 	TextPainter p(&painter, this);
 	p.draw(left, top, w, align, yFrom, yTo, selection, fullWidthSelection);
 }
 
 void Text::drawElided(Painter &painter, int32 left, int32 top, int32 w, int32 lines, style::align align, int32 yFrom, int32 yTo, int32 removeFromEnd, bool breakEverywhere, TextSelection selection) const {
 //	painter.fillRect(QRect(left, top, w, countHeight(w)), QColor(0, 0, 0, 32)); // debug
+	Ui::PaintStats::CountTextDraw();
 	TextPainter p(&painter, this);
 	p.drawElided(left, top, w, align, lines, yFrom, yTo, removeFromEnd, breakEverywhere, selection);
 }
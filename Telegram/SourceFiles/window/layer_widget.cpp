@@ -30,6 +30,21 @@ namespace {
 
 constexpr int kStickerPreviewEmojiLimit = 10;
 
+// The preview shows the final frame at once, so it doesn't use the async
+// rendering of Image::pix() that gives a placeholder first.
+QPixmap PreviewPixmap(
+		not_null<Image*> image,
+		Data::FileOrigin origin,
+		QSize size) {
+	auto result = image->pixNoCache(
+		origin,
+		size.width() * cIntRetinaFactor(),
+		size.height() * cIntRetinaFactor(),
+		Images::Option::Smooth);
+	result.setDevicePixelRatio(cRetinaFactor());
+	return result;
+}
+
 } // namespace
 
 namespace Window {
@@ -1019,8 +1034,7 @@ QPixmap MediaPreviewWidget::currentImage() const {
 		if (_document->sticker()) {
 			if (_cacheStatus != CacheLoaded) {
 				if (const auto image = _document->getStickerLarge()) {
-					QSize s = currentDimensions();
-					_cache = image->pix(_origin, s.width(), s.height());
+					_cache = PreviewPixmap(image, _origin, currentDimensions());
 					_cacheStatus = CacheLoaded;
 				} else if (_cacheStatus != CacheThumbLoaded
 					&& _document->hasThumbnail()
@@ -1063,8 +1077,10 @@ QPixmap MediaPreviewWidget::currentImage() const {
 	} else if (_photo) {
 		if (_cacheStatus != CacheLoaded) {
 			if (_photo->loaded()) {
-				QSize s = currentDimensions();
-				_cache = _photo->large()->pix(_origin, s.width(), s.height());
+				_cache = PreviewPixmap(
+					_photo->large(),
+					_origin,
+					currentDimensions());
 				_cacheStatus = CacheLoaded;
 			} else {
 				_photo->load(_origin);
@@ -437,6 +437,39 @@ void System::updateAll() {
 	_manager->updateAll();
 }
 
+void System::benchmark(int count) {
+	auto items = std::vector<not_null<HistoryItem*>>();
+	const auto collect = [&](not_null<PeerData*> peer) {
+		const auto history = _authSession->data().historyLoaded(peer);
+		if (const auto item = history ? history->lastMessage() : nullptr) {
+			items.push_back(item);
+		}
+	};
+	_authSession->data().enumerateUsers(collect);
+	_authSession->data().enumerateGroups(collect);
+	_authSession->data().enumerateChannels(collect);
+	if (items.empty() || count <= 0) {
+		LOG(("Notifications Benchmark: no messages to notify about."));
+		return;
+	}
+
+	const auto started = crl::now();
+	for (auto i = 0; i != count; ++i) {
+		_manager->showNotification(items[i % items.size()], 0);
+	}
+	const auto queued = crl::now() - started;
+
+	// The manager shows the queued notifications in the next iteration.
+	crl::on_main(_authSession, [=, chats = int(items.size())] {
+		LOG(("Notifications Benchmark: %1 notifications from %2 chats, "
+			"queued in %3 ms, shown in %4 ms."
+			).arg(count
+			).arg(chats
+			).arg(queued
+			).arg(crl::now() - started));
+	});
+}
+
 Manager::DisplayOptions Manager::getNotificationOptions(HistoryItem *item) {
 	const auto hideEverything = Core::App().locked()
 		|| Global::ScreenIsLocked();
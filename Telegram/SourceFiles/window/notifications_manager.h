@@ -66,6 +66,10 @@ public:
 	void clearAllFast();
 	void updateAll();
 
+	// Sends a burst of notifications for the last messages of the loaded
+	// chats right to the manager and logs how long it took to show them.
+	void benchmark(int count);
+
 	base::Observable<ChangeType> &settingsChanged() {
 		return _settingsChanged;
 	}
@@ -27,6 +27,8 @@ namespace Notifications {
 namespace Default {
 namespace {
 
+constexpr auto kCacheImagesLimit = 8;
+
 int notificationMaxHeight() {
 	return st::notifyMinHeight + st::notifyReplyArea.heightMax + st::notifyBorderWidth;
 }
@@ -53,7 +55,8 @@ std::unique_ptr<Manager> Create(System *system) {
 
 Manager::Manager(System *system)
 : Notifications::Manager(system)
-, _inputCheckTimer([=] { checkLastInput(); }) {
+, _inputCheckTimer([=] { checkLastInput(); })
+, _showQueued([=] { showNextFromQueue(); }) {
 	subscribe(system->authSession()->downloader().taskFinished(), [this] {
 		for_const (auto &notification, _notifications) {
 			notification->updatePeerPhoto();
@@ -82,6 +85,22 @@ QPixmap Manager::hiddenUserpicPlaceholder() const {
 	return _hiddenUserpicPlaceholder;
 }
 
+QImage Manager::takeCacheImage(QSize size) {
+	const auto i = ranges::find(_cacheImages, size, &QImage::size);
+	if (i == end(_cacheImages)) {
+		return QImage(size, QImage::Format_ARGB32_Premultiplied);
+	}
+	auto result = std::move(*i);
+	_cacheImages.erase(i);
+	return result;
+}
+
+void Manager::releaseCacheImage(QImage &&image) {
+	if (!image.isNull() && int(_cacheImages.size()) < kCacheImagesLimit) {
+		_cacheImages.push_back(std::move(image));
+	}
+}
+
 bool Manager::hasReplyingNotification() const {
 	for_const (auto &notification, _notifications) {
 		if (notification->isReplying()) {
@@ -288,8 +307,20 @@ void Manager::removeWidget(internal::Widget *remove) {
 }
 
 void Manager::doShowNotification(HistoryItem *item, int forwardedCount) {
-	_queuedNotifications.push_back(QueuedNotification(item, forwardedCount));
-	showNextFromQueue();
+	// A burst of messages in one chat waits in the queue as the newest
+	// of them, keeping the place of the first one. The widgets for a
+	// burst are created once in the next event loop iteration.
+	auto queued = QueuedNotification(item, forwardedCount);
+	const auto i = ranges::find(
+		_queuedNotifications,
+		queued.history,
+		&QueuedNotification::history);
+	if (i != end(_queuedNotifications)) {
+		*i = queued;
+	} else {
+		_queuedNotifications.push_back(queued);
+	}
+	_showQueued.call();
 }
 
 void Manager::doClearAll() {
@@ -555,6 +586,10 @@ Notification::Notification(
 	show();
 }
 
+Notification::~Notification() {
+	manager()->releaseCacheImage(base::take(_cache));
+}
+
 void Notification::updateReplyGeometry() {
 	_reply->moveToRight(_replyPadding, height() - _reply->height() - _replyPadding);
 }
@@ -621,7 +656,7 @@ void Notification::updateGeometry(int x, int y, int width, int height) {
 void Notification::paintEvent(QPaintEvent *e) {
 	Painter p(this);
 	p.setClipRect(e->rect());
-	p.drawPixmap(0, 0, _cache);
+	p.drawImage(0, 0, _cache);
 
 	auto buttonsLeft = st::notifyPhotoPos.x() + st::notifyPhotoSize + st::notifyTextLeft;
 	auto buttonsTop = st::notifyTextTop + st::msgNameFont->height;
@@ -647,7 +682,7 @@ void Notification::updateNotifyDisplay() {
 	_hideReplyButton = options.hideReplyButton;
 
 	int32 w = width(), h = height();
-	QImage img(w * cIntRetinaFactor(), h * cIntRetinaFactor(), QImage::Format_ARGB32_Premultiplied);
+	auto img = manager()->takeCacheImage(QSize(w, h) * cIntRetinaFactor());
 	img.setDevicePixelRatio(cRetinaFactor());
 	img.fill(st::notificationBg->c);
 
@@ -717,7 +752,7 @@ void Notification::updateNotifyDisplay() {
 		}
 	}
 
-	_cache = App::pixmapFromImageInPlace(std::move(img));
+	manager()->releaseCacheImage(std::exchange(_cache, std::move(img)));
 	if (!canReply()) {
 		toggleActionButtons(false);
 	}
@@ -730,12 +765,10 @@ void Notification::updatePeerPhoto() {
 	}
 	_userpicLoaded = true;
 
-	auto img = _cache.toImage();
 	{
-		Painter p(&img);
+		Painter p(&_cache);
 		_peer->paintUserpicLeft(p, st::notifyPhotoPos.x(), st::notifyPhotoPos.y(), width(), st::notifyPhotoSize);
 	}
-	_cache = App::pixmapFromImageInPlace(std::move(img));
 	update();
 }
 
@@ -49,6 +49,10 @@ private:
 
 	QPixmap hiddenUserpicPlaceholder() const;
 
+	// Images of the hidden notifications are reused for the new ones.
+	[[nodiscard]] QImage takeCacheImage(QSize size);
+	void releaseCacheImage(QImage &&image);
+
 	void doUpdateAll() override;
 	void doShowNotification(HistoryItem *item, int forwardedCount) override;
 	void doClearAll() override;
@@ -90,6 +94,8 @@ private:
 		int forwardedCount;
 	};
 	std::deque<QueuedNotification> _queuedNotifications;
+	SingleQueuedInvokation _showQueued;
+	std::vector<QImage> _cacheImages;
 
 	Animation _demoMasterOpacity;
 
@@ -166,6 +172,7 @@ protected:
 class Notification : public Widget {
 public:
 	Notification(Manager *manager, History *history, PeerData *peer, PeerData *author, HistoryItem *item, int forwardedCount, QPoint startPosition, int shift, Direction shiftDirection);
+	~Notification();
 
 	void startHiding();
 	void stopHiding();
@@ -208,7 +215,7 @@ private:
 	void updateGeometry(int x, int y, int width, int height) override;
 	void actionsOpacityCallback();
 
-	QPixmap _cache;
+	QImage _cache;
 
 	bool _hideReplyButton = false;
 	bool _actionsVisible = false;
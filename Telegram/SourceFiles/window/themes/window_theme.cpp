@@ -19,6 +19,7 @@ https://github.com/bettergram/bettergram/blob/master/LEGAL
 #include "ui/image/image.h"
 #include "boxes/background_box.h"
 #include "core/application.h"
+#include "core/trace.h"
 #include "styles/style_widgets.h"
 #include "styles/style_history.h"
 
@@ -32,6 +33,11 @@ constexpr auto kBackgroundSizeLimit = 25 * 1024 * 1024;
 constexpr auto kThemeSchemeSizeLimit = 1024 * 1024;
 constexpr auto kNightThemeFile = str_const(":/gui/night.tdesktop-theme");
 
+// Cached theme background is kept as raw premultiplied pixels after
+// the header: tag, width and height, so that it is used without decoding.
+constexpr auto kCachedBackgroundTag = qint32(0x54424731); // 'TBG1'
+constexpr auto kCachedBackgroundHeader = int(3 * sizeof(qint32));
+
 struct Applying {
 	QString pathRelative;
 	QString pathAbsolute;
@@ -198,7 +204,67 @@ void applyBackground(QImage &&background, bool tiled, Instance *out) {
 	}
 }
 
-bool loadThemeFromCache(const QByteArray &content, const Cached &cache) {
+QByteArray SerializeCachedBackground(const QImage &image) {
+	Expects(image.format() == QImage::Format_ARGB32_Premultiplied);
+
+	const auto width = qint32(image.width());
+	const auto height = qint32(image.height());
+	const auto perline = width * 4;
+	auto result = QByteArray(
+		kCachedBackgroundHeader + perline * height,
+		Qt::Uninitialized);
+	const auto header = std::array<qint32, 3>{ {
+		kCachedBackgroundTag,
+		width,
+		height
+	} };
+	auto dst = result.data();
+	memcpy(dst, header.data(), kCachedBackgroundHeader);
+	dst += kCachedBackgroundHeader;
+	if (image.bytesPerLine() == perline) {
+		memcpy(dst, image.constBits(), perline * height);
+	} else {
+		for (auto y = 0; y != height; ++y) {
+			memcpy(dst, image.constScanLine(y), perline);
+			dst += perline;
+		}
+	}
+	return result;
+}
+
+QImage DeserializeCachedBackground(const QByteArray &serialized) {
+	if (serialized.size() < kCachedBackgroundHeader) {
+		return QImage();
+	}
+	auto header = std::array<qint32, 3>();
+	memcpy(header.data(), serialized.constData(), kCachedBackgroundHeader);
+	const auto [tag, width, height] = header;
+	if (tag != kCachedBackgroundTag
+		|| width <= 0
+		|| height <= 0
+		|| int64(width) * height > kBackgroundSizeLimit
+		|| (serialized.size()
+			!= kCachedBackgroundHeader + int64(width) * height * 4)) {
+		return QImage();
+	}
+
+	// The image uses the cached bytes directly, the holder keeps them alive.
+	const auto holder = new QByteArray(serialized);
+	return QImage(
+		reinterpret_cast<const uchar*>(holder->constData())
+			+ kCachedBackgroundHeader,
+		width,
+		height,
+		width * 4,
+		QImage::Format_ARGB32_Premultiplied,
+		[](void *holder) { delete static_cast<QByteArray*>(holder); },
+		holder);
+}
+
+bool loadThemeFromCache(
+		const QByteArray &content,
+		const Cached &cache,
+		Instance *out = nullptr) {
 	if (cache.paletteChecksum != style::palette::Checksum()) {
 		return false;
 	}
@@ -206,24 +272,26 @@ bool loadThemeFromCache(const QByteArray &content, const Cached &cache) {
 		return false;
 	}
 
-	QImage background;
+	auto background = QImage();
 	if (!cache.background.isEmpty()) {
-		QDataStream stream(cache.background);
-		QImageReader reader(stream.device());
-#ifndef OS_MAC_OLD
-		reader.setAutoTransform(true);
-#endif // OS_MAC_OLD
-		if (!reader.read(&background) || background.isNull()) {
+		background = DeserializeCachedBackground(cache.background);
+		if (background.isNull()) {
 			return false;
 		}
 	}
 
-	if (!style::main_palette::load(cache.colors)) {
-		return false;
+	if (out) {
+		if (!out->palette.load(cache.colors)) {
+			return false;
+		}
+	} else {
+		if (!style::main_palette::load(cache.colors)) {
+			return false;
+		}
+		Background()->saveAdjustableColors();
 	}
-	Background()->saveAdjustableColors();
 	if (!background.isNull()) {
-		applyBackground(std::move(background), cache.tiled, nullptr);
+		applyBackground(std::move(background), cache.tiled, out);
 	}
 
 	return true;
@@ -304,11 +372,8 @@ bool loadTheme(const QByteArray &content, Cached &cache, Instance *out = nullptr
 				LOG(("Theme Error: could not read background image in the theme file."));
 				return false;
 			}
-			auto buffer = QBuffer(&cache.background);
-			if (!background.save(&buffer, "BMP")) {
-				LOG(("Theme Error: could not write background image as a BMP to cache."));
-				return false;
-			}
+			background = ProcessBackgroundImage(std::move(background));
+			cache.background = SerializeCachedBackground(background);
 			cache.tiled = backgroundTiled;
 
 			applyBackground(std::move(background), cache.tiled, out);
@@ -448,8 +513,12 @@ void ChatBackground::checkUploadWallPaper() {
 	});
 }
 
-void ChatBackground::set(const Data::WallPaper &paper, QImage image) {
+void ChatBackground::set(
+		const Data::WallPaper &paper,
+		QImage image,
+		std::optional<QColor> averageColor) {
 	image = ProcessBackgroundImage(std::move(image));
+	_averageColor = averageColor;
 
 	const auto needResetAdjustable = Data::IsDefaultWallPaper(paper)
 		&& !Data::IsDefaultWallPaper(_paper)
@@ -494,12 +563,10 @@ void ChatBackground::set(const Data::WallPaper &paper, QImage image) {
 			setPaper(Data::DefaultWallPaper().withParamsFrom(_paper));
 			image.load(qsl(":/gui/art/bg.jpg"));
 		}
-		Local::writeBackground(
-			_paper,
-			((Data::IsDefaultWallPaper(_paper)
-				|| Data::IsLegacy1DefaultWallPaper(_paper))
-				? QImage()
-				: image));
+		const auto imageToWrite = (Data::IsDefaultWallPaper(_paper)
+			|| Data::IsLegacy1DefaultWallPaper(_paper))
+			? QImage()
+			: image;
 		if (const auto fill = _paper.backgroundColor()) {
 			if (_paper.isPattern() && !image.isNull()) {
 				auto prepared = validateBackgroundImage(
@@ -521,6 +588,7 @@ void ChatBackground::set(const Data::WallPaper &paper, QImage image) {
 			image = validateBackgroundImage(std::move(image));
 			setPreparedImage(image, image);
 		}
+		Local::writeBackground(_paper, imageToWrite, _averageColor);
 	}
 	Assert(colorForFill()
 		|| (!_original.isNull()
@@ -615,7 +683,10 @@ bool ChatBackground::testingPalette() const {
 }
 
 void ChatBackground::adjustPaletteUsingBackground(const QImage &image) {
-	adjustPaletteUsingColor(CountAverageColor(image));
+	if (!_averageColor) {
+		_averageColor = CountAverageColor(image);
+	}
+	adjustPaletteUsingColor(*_averageColor);
 }
 
 void ChatBackground::adjustPaletteUsingColor(QColor color) {
@@ -739,6 +810,7 @@ void ChatBackground::saveForRevert() {
 		&& !Data::details::IsTestingDefaultWallPaper(_paper)) {
 		_paperForRevert = _paper;
 		_originalForRevert = std::move(_original);
+		_averageColorForRevert = _averageColor;
 		_tileForRevert = tile();
 	}
 }
@@ -784,7 +856,7 @@ void ChatBackground::setTestingTheme(Instance &&theme) {
 		setTile(theme.tiled);
 	} else {
 		// Apply current background image so that service bg colors are recounted.
-		set(_paper, std::move(_original));
+		set(_paper, std::move(_original), _averageColor);
 	}
 	notify(BackgroundUpdate(BackgroundUpdate::Type::TestingTheme, tile()), true);
 }
@@ -851,7 +923,8 @@ void ChatBackground::writeNewBackgroundSettings() {
 		((Data::IsThemeWallPaper(_paper)
 			|| Data::IsDefaultWallPaper(_paper))
 			? QImage()
-			: _original));
+			: _original),
+		_averageColor);
 }
 
 void ChatBackground::revert() {
@@ -859,10 +932,13 @@ void ChatBackground::revert() {
 		|| Data::details::IsTestingDefaultWallPaper(_paper)
 		|| Data::details::IsTestingEditorWallPaper(_paper)) {
 		setTile(_tileForRevert);
-		set(_paperForRevert, std::move(_originalForRevert));
+		set(
+			_paperForRevert,
+			std::move(_originalForRevert),
+			base::take(_averageColorForRevert));
 	} else {
 		// Apply current background image so that service bg colors are recounted.
-		set(_paper, std::move(_original));
+		set(_paper, std::move(_original), _averageColor);
 	}
 	notify(BackgroundUpdate(BackgroundUpdate::Type::RevertingTheme, tile()), true);
 }
@@ -894,10 +970,14 @@ void ChatBackground::toggleNightMode(std::optional<QString> themePath) {
 		preview->pathRelative = std::move(read.pathRelative);
 		preview->content = std::move(read.content);
 		preview->instance.cached = std::move(read.cache);
-		const auto loaded = loadTheme(
+		const auto loaded = loadThemeFromCache(
 			preview->content,
 			preview->instance.cached,
-			&preview->instance);
+			&preview->instance)
+			|| loadTheme(
+				preview->content,
+				preview->instance.cached,
+				&preview->instance);
 		if (!loaded) {
 			return false;
 		}
@@ -942,6 +1022,8 @@ ChatBackground *Background() {
 }
 
 bool Load(Saved &&saved) {
+	const auto trace = Core::TraceSpan("Window::Theme::Load");
+
 	if (saved.content.size() < 4) {
 		LOG(("Theme Error: Could not load theme from '%1' (%2)"
 			).arg(saved.pathRelative
@@ -95,7 +95,12 @@ public:
 
 	// This method is setting the default (themed) image if none was set yet.
 	void start();
-	void set(const Data::WallPaper &paper, QImage image = QImage());
+	// The average color is saved with the background, if it is known
+	// it is not counted again when the palette is adjusted.
+	void set(
+		const Data::WallPaper &paper,
+		QImage image = QImage(),
+		std::optional<QColor> averageColor = std::nullopt);
 	void setTile(bool tile);
 	void setTileDayValue(bool tile);
 	void setTileNightValue(bool tile);
@@ -180,9 +185,11 @@ private:
 	Data::WallPaper _paperForRevert
 		= Data::details::UninitializedWallPaper();
 	QImage _originalForRevert;
+	std::optional<QColor> _averageColorForRevert;
 	bool _tileForRevert = false;
 
 	std::vector<AdjustableColor> _adjustableColors;
+	std::optional<QColor> _averageColor;
 	FullMsgId _wallPaperUploadId;
 	mtpRequestId _wallPaperRequestId = 0;
 	rpl::lifetime _wallPaperUploadLifetime;
@@ -338,7 +338,7 @@ void MainMenu::paintEvent(QPaintEvent *e) {
 		p.fillRect(cover, st::mainMenuCoverBg);
 		p.setPen(st::mainMenuCoverFg);
 		p.setFont(st::semiboldFont);
-		Auth().user()->nameText.drawLeftElided(
+		Auth().user()->nameText().drawLeftElided(
 			p,
 			st::mainMenuCoverTextLeft,
 			st::mainMenuCoverNameTop,
@@ -0,0 +1,272 @@
+'''
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+'''
+# Local stand-in for the Bettergram and crypto prices servers.
+#
+# It serves synthetic data of the configured size, so the service client
+# can be measured with thousands of coins, large feeds and bad endpoints:
+#
+#   python3 bettergram_benchmark_server.py --coins 5000 --feed-items 2000
+#
+#   BETTERGRAM_BENCHMARK=1 \
+#   BETTERGRAM_API_URL=http://127.0.0.1:8765/api \
+#   BETTERGRAM_PRICES_URL=http://127.0.0.1:8765/prices \
+#   ./Bettergram
+#
+# The client then writes the benchmark statistics to its log.
+import sys, json, time, random, argparse, threading
+from email.utils import formatdate
+from http.server import HTTPServer, BaseHTTPRequestHandler
+from socketserver import ThreadingMixIn
+from urllib.parse import urlparse, parse_qs
+
+parser = argparse.ArgumentParser(description='Bettergram service stand-in server.')
+parser.add_argument('--host', default='127.0.0.1')
+parser.add_argument('--port', type=int, default=8765)
+parser.add_argument('--coins', type=int, default=3000, help='count of coins in the price list')
+parser.add_argument('--feeds', type=int, default=20, help='count of RSS channels and video channels')
+parser.add_argument('--feed-items', type=int, default=500, help='count of items in each feed')
+parser.add_argument('--resource-groups', type=int, default=50)
+parser.add_argument('--resource-items', type=int, default=40, help='count of items in each resource group')
+parser.add_argument('--pinned', type=int, default=20, help='count of pinned news and videos')
+parser.add_argument('--delay', type=int, default=0, help='delay of each reply in ms')
+parser.add_argument('--slow-rate', type=float, default=0.0, help='part of replies delayed by --slow-delay')
+parser.add_argument('--slow-delay', type=int, default=15000, help='delay of slow replies in ms, longer than the client timeout by default')
+parser.add_argument('--error-rate', type=float, default=0.0, help='part of replies failed with 500 or broken json')
+parser.add_argument('--seed', type=int, default=1)
+options = parser.parse_args()
+
+random.seed(options.seed)
+lock = threading.Lock()
+requests = {}
+
+def coinCode(index):
+    return 'C' + str(index)
+
+coins = []
+for index in range(options.coins):
+    coins.append({
+        'code': coinCode(index),
+        'name': 'Coin number ' + str(index),
+        'rank': index + 1,
+        'price': random.uniform(0.0001, 10000.0),
+        'day': random.uniform(-30.0, 30.0),
+        'minute': random.uniform(-1.0, 1.0),
+    })
+
+def names(search):
+    data = []
+    for coin in coins:
+        if search and search.lower() not in coin['name'].lower() and search.upper() not in coin['code']:
+            continue
+        data.append({
+            'type': 'coin',
+            'name': coin['name'],
+            'code': coin['code'],
+            'url': coin['name'].replace(' ', '') + '-' + coin['code'],
+            'icon': coin['code'].lower() + '.png',
+        })
+    return {
+        'success': True,
+        'coinsUrlBase': 'http://' + options.host + ':' + str(options.port) + '/site/price/',
+        'coinsIcon32Base': 'http://' + options.host + ':' + str(options.port) + '/site/icons32/',
+        'data': data,
+    }
+
+def values(query):
+    sort = query.get('sort', ['rank'])[0]
+    order = query.get('order', ['ascending'])[0]
+    offset = int(query.get('offset', ['0'])[0])
+    limit = int(query.get('limit', ['100'])[0])
+    only = query.get('only', [''])[0]
+
+    selected = coins
+    if only:
+        codes = set(only.split(','))
+        selected = [coin for coin in coins if coin['code'] in codes]
+    if sort == 'price':
+        selected = sorted(selected, key=lambda coin: coin['price'])
+    elif sort == 'delta.day':
+        selected = sorted(selected, key=lambda coin: coin['day'])
+    if order == 'descending':
+        selected = list(reversed(selected))
+
+    data = []
+    for coin in selected[offset:offset + limit]:
+        data.append({
+            'code': coin['code'],
+            'name': coin['name'],
+            'rank': coin['rank'],
+            'price': coin['price'] * random.uniform(0.99, 1.01),
+            'delta': { 'day': coin['day'], 'minute': coin['minute'] },
+        })
+    return { 'success': True, 'total': len(selected), 'data': data }
+
+def stats():
+    return {
+        'success': True,
+        'cap': random.uniform(1e11, 1e12),
+        'btcDominance': random.uniform(0.3, 0.7),
+        'freq': 60,
+    }
+
+def base():
+    return 'http://' + options.host + ':' + str(options.port)
+
+def channelList(kind):
+    return {
+        'success': True,
+        kind: [base() + '/feeds/' + kind + '/' + str(index) + '.xml' for index in range(options.feeds)],
+    }
+
+def feed(kind, index):
+    items = []
+    now = time.time()
+    for item in range(options.feed_items):
+        link = base() + '/site/' + kind + '/' + str(index) + '/' + str(item)
+        items.append(
+            '<item><title>Item ' + str(item) + ' of the channel ' + str(index) + '</title>'
+            '<link>' + link + '</link>'
+            '<guid>' + link + '</guid>'
+            '<description>' + ('Synthetic description text. ' * 20) + '</description>'
+            '<category>Category ' + str(item % 7) + '</category>'
+            '<pubDate>' + formatdate(now - item * 600) + '</pubDate>'
+            '</item>')
+    return ('<?xml version="1.0" encoding="UTF-8"?><rss version="2.0"><channel>'
+        '<title>Channel ' + str(index) + '</title>'
+        '<link>' + base() + '/site/' + kind + '/' + str(index) + '</link>'
+        '<description>Synthetic ' + kind + ' channel</description>'
+        + ''.join(items) +
+        '</channel></rss>')
+
+def resources():
+    groups = []
+    for group in range(options.resource_groups):
+        items = []
+        for item in range(options.resource_items):
+            items.append({
+                'title': 'Resource ' + str(item) + ' of the group ' + str(group),
+                'description': 'Synthetic resource description',
+                'url': base() + '/site/resources/' + str(group) + '/' + str(item),
+                'iconUrl': base() + '/site/icons32/c' + str(item) + '.png',
+            })
+        groups.append({ 'title': 'Group ' + str(group), 'items': items })
+    return { 'success': True, 'freq': 3600, 'resources': { 'groups': groups } }
+
+def pinned():
+    def items(kind):
+        result = []
+        for index in range(options.pinned):
+            result.append({
+                'title': 'Pinned ' + kind + ' ' + str(index),
+                'description': 'Synthetic pinned ' + kind,
+                'url': base() + '/site/pinned/' + kind + '/' + str(index),
+                'imageUrl': base() + '/site/icons32/c' + str(index) + '.png',
+                'date': int(time.time()) - index * 3600,
+                'endDate': int(time.time()) + 24 * 3600,
+                'pos': index,
+            })
+        return result
+    return { 'success': True, 'freq': 3600, 'news': items('news'), 'videos': items('videos') }
+
+def ad():
+    index = random.randint(0, 1000)
+    return {
+        'success': True,
+        'ad': {
+            '_id': str(index),
+            'text': 'Synthetic ad ' + str(index),
+            'url': base() + '/site/ads/' + str(index),
+            'duration': 60,
+        },
+    }
+
+class ThreadingServer(ThreadingMixIn, HTTPServer):
+    daemon_threads = True
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def log_message(self, format, *args):
+        pass
+
+    def reply(self, code, body, contentType):
+        data = body.encode('utf-8')
+        self.send_response(code)
+        self.send_header('Content-Type', contentType)
+        self.send_header('Content-Length', str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+
+    def do_GET(self):
+        url = urlparse(self.path)
+        query = parse_qs(url.query)
+        path = url.path.rstrip('/')
+
+        with lock:
+            requests[path] = requests.get(path, 0) + 1
+
+        delay = options.delay
+        if random.random() < options.slow_rate:
+            delay = options.slow_delay
+        if delay > 0:
+            time.sleep(delay / 1000.0)
+
+        if random.random() < options.error_rate:
+            if random.random() < 0.5:
+                self.reply(500, 'Internal Server Error', 'text/plain')
+            else:
+                self.reply(200, '{"success": true, "data": [', 'application/json')
+            return
+
+        if path == '/prices/currencies':
+            self.json(names(query.get('search', [''])[0]))
+        elif path == '/prices/coins':
+            self.json(values(query))
+        elif path == '/prices/stats':
+            self.json(stats())
+        elif path == '/api/news':
+            self.json(channelList('news'))
+        elif path == '/api/videos':
+            self.json(channelList('videos'))
+        elif path == '/api/resources':
+            self.json(resources())
+        elif path == '/api/pinned_news':
+            self.json(pinned())
+        elif path == '/api/ads/next':
+            self.json(ad())
+        elif path == '/api/links_stat':
+            self.json({ 'success': True })
+        elif path.startswith('/feeds/'):
+            parts = path.split('/')
+            self.reply(200, feed(parts[2], int(parts[3].split('.')[0])), 'application/rss+xml')
+        else:
+            self.reply(404, 'Not Found', 'text/plain')
+
+    def json(self, value):
+        self.reply(200, json.dumps(value), 'application/json')
+
+def report():
+    while True:
+        time.sleep(10)
+        with lock:
+            if requests:
+                print(', '.join(path + ': ' + str(count) for path, count in sorted(requests.items())))
+                sys.stdout.flush()
+
+print('Serving on ' + base())
+print('BETTERGRAM_API_URL=' + base() + '/api')
+print('BETTERGRAM_PRICES_URL=' + base() + '/prices')
+sys.stdout.flush()
+
+thread = threading.Thread(target=report)
+thread.daemon = True
+thread.start()
+
+try:
+    ThreadingServer((options.host, options.port), Handler).serve_forever()
+except KeyboardInterrupt:
+    pass
@@ -0,0 +1,140 @@
+'''
+This file is part of Bettergram.
+
+For license and copyright information please follow this link:
+https://github.com/bettergram/bettergram/blob/master/LEGAL
+'''
+# Launch time benchmark against a recorded local session.
+#
+# Record a fixture once: start the app with a separate working folder,
+# log in (a test server account with -testmode is fine), wait for the
+# chats list to load and quit:
+#
+#   ./Bettergram -many -workdir /path/to/fixture/
+#
+# Then measure the time from the process start to the first paint of the
+# chats list, using the launch timeline written by the "-trace" argument:
+#
+#   python3 startup_benchmark.py --binary ./Bettergram --fixture /path/to/fixture/
+#
+# Each cold run starts with a fresh copy of the fixture, so the local
+# caches are empty, warm runs reuse the folder of the previous run.
+# The app is started with the "offscreen" Qt platform unless --visible.
+import os, sys, json, time, shutil, argparse, tempfile, subprocess, statistics
+
+parser = argparse.ArgumentParser(description='Bettergram launch time benchmark.')
+parser.add_argument('--binary', required=True, help='path to the built app')
+parser.add_argument('--fixture', required=True, help='working folder with a recorded session')
+parser.add_argument('--cold', type=int, default=3, help='count of runs with a fresh fixture copy')
+parser.add_argument('--warm', type=int, default=5, help='count of runs after each cold run')
+parser.add_argument('--timeout', type=float, default=60.0, help='seconds to wait for the first paint')
+parser.add_argument('--testmode', action='store_true', help='the fixture uses the test servers')
+parser.add_argument('--drop-caches', action='store_true', help='drop the OS file cache before cold runs (needs root, Linux only)')
+parser.add_argument('--visible', action='store_true', help='show the window instead of painting offscreen')
+parser.add_argument('--keep-traces', help='folder to keep the trace of each run in')
+options = parser.parse_args()
+
+if not os.path.isdir(os.path.join(options.fixture, 'tdata')):
+    print('Fixture folder should contain "tdata", record it first.')
+    sys.exit(1)
+
+def dropCaches():
+    if not options.drop_caches:
+        return
+    subprocess.call(['sync'])
+    try:
+        with open('/proc/sys/vm/drop_caches', 'w') as f:
+            f.write('3\n')
+    except IOError as e:
+        print('Could not drop caches: ' + str(e))
+
+def launch(workdir, trace):
+    arguments = [options.binary, '-many', '-noupdate', '-workdir', workdir, '-trace', trace]
+    if options.testmode:
+        arguments.append('-testmode')
+    environment = dict(os.environ)
+    if not options.visible:
+        environment['QT_QPA_PLATFORM'] = 'offscreen'
+    started = time.time()
+    process = subprocess.Popen(arguments, env=environment, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    try:
+        while not os.path.exists(trace):
+            if process.poll() is not None:
+                print('App finished with code ' + str(process.returncode) + ' before the first paint.')
+                return None
+            if time.time() - started > options.timeout:
+                print('Timeout while waiting for the first paint.')
+                return None
+            time.sleep(0.01)
+        # The trace is written in one go, wait for it to be complete.
+        for attempt in range(100):
+            try:
+                with open(trace, 'r') as f:
+                    return json.load(f)
+            except ValueError:
+                time.sleep(0.01)
+        print('Could not read the trace.')
+        return None
+    finally:
+        process.terminate()
+        try:
+            process.wait(10)
+        except subprocess.TimeoutExpired:
+            process.kill()
+            process.wait()
+
+def firstPaint(events):
+    for event in events:
+        if event['name'] == 'DialogsInner::paintRegion':
+            return (event['ts'] + event['dur']) / 1000.
+    return None
+
+def spans(events):
+    result = {}
+    for event in events:
+        if event['ph'] == 'X' and event['name'] not in result:
+            result[event['name']] = event['dur'] / 1000.
+    return result
+
+results = { 'cold': [], 'warm': [] }
+details = { 'cold': {}, 'warm': {} }
+runIndex = 0
+for coldIndex in range(options.cold):
+    workdir = tempfile.mkdtemp(prefix='bettergram_startup_')
+    try:
+        shutil.copytree(os.path.join(options.fixture, 'tdata'), os.path.join(workdir, 'tdata'))
+        for warmIndex in range(options.warm + 1):
+            kind = 'warm' if warmIndex else 'cold'
+            if kind == 'cold':
+                dropCaches()
+            trace = os.path.join(workdir, 'trace.json')
+            if os.path.exists(trace):
+                os.remove(trace)
+            timeline = launch(workdir + '/', trace)
+            if timeline is None:
+                sys.exit(1)
+            if options.keep_traces:
+                if not os.path.isdir(options.keep_traces):
+                    os.makedirs(options.keep_traces)
+                shutil.copy(trace, os.path.join(options.keep_traces, 'trace_' + str(runIndex) + '_' + kind + '.json'))
+            runIndex += 1
+            events = timeline['traceEvents']
+            paint = firstPaint(events)
+            if paint is None:
+                print('No chats list paint in the trace, is the fixture logged in?')
+                sys.exit(1)
+            results[kind].append(paint)
+            for name, duration in spans(events).items():
+                details[kind].setdefault(name, []).append(duration)
+            print(kind + ' run: first paint in ' + ('%.1f' % paint) + ' ms')
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+print('')
+for kind in ['cold', 'warm']:
+    values = results[kind]
+    if not values:
+        continue
+    print(kind + ': median ' + ('%.1f' % statistics.median(values)) + ' ms, min ' + ('%.1f' % min(values)) + ' ms, max ' + ('%.1f' % max(values)) + ' ms, runs ' + str(len(values)))
+    for name in sorted(details[kind]):
+        print('    ' + name + ': median ' + ('%.1f' % statistics.median(details[kind][name])) + ' ms')
@@ -53,6 +53,8 @@
       '<(src_loc)/base/binary_guard.h',
       '<(src_loc)/base/build_config.h',
       '<(src_loc)/base/bytes.h',
+      '<(src_loc)/base/chunked_arena.h',
+      '<(src_loc)/base/chunked_flat_set.h',
       '<(src_loc)/base/concurrent_timer.cpp',
       '<(src_loc)/base/concurrent_timer.h',
       '<(src_loc)/base/flags.h',
@@ -60,12 +62,16 @@
       '<(src_loc)/base/flat_map.h',
       '<(src_loc)/base/flat_set.h',
       '<(src_loc)/base/functors.h',
+      '<(src_loc)/base/id_map.h',
       '<(src_loc)/base/index_based_iterator.h',
 	  '<(src_loc)/base/last_used_cache.h',
       '<(src_loc)/base/match_method.h',
+      '<(src_loc)/base/mpsc_queue.h',
       '<(src_loc)/base/observer.cpp',
       '<(src_loc)/base/observer.h',
       '<(src_loc)/base/ordered_set.h',
+      '<(src_loc)/base/openssl_aes.cpp',
+      '<(src_loc)/base/openssl_aes.h',
       '<(src_loc)/base/openssl_help.h',
       '<(src_loc)/base/optional.h',
       '<(src_loc)/base/overload.h',
@@ -74,6 +80,7 @@
       '<(src_loc)/base/qthelp_regex.h',
       '<(src_loc)/base/qthelp_url.cpp',
       '<(src_loc)/base/qthelp_url.h',
+      '<(src_loc)/base/request_batches.h',
       '<(src_loc)/base/runtime_composer.cpp',
       '<(src_loc)/base/runtime_composer.h',
       '<(src_loc)/base/timer.cpp',
@@ -82,6 +82,8 @@
       '<(src_loc)/export/output/export_output_stats.h',
       '<(src_loc)/export/output/export_output_text.cpp',
       '<(src_loc)/export/output/export_output_text.h',
+      '<(src_loc)/export/output/export_output_workers.cpp',
+      '<(src_loc)/export/output/export_output_workers.h',
     ],
   }],
 }
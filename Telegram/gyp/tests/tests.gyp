@@ -56,6 +56,24 @@
       '<(src_loc)/base/algorithm.h',
       '<(src_loc)/base/algorithm_tests.cpp',
     ],
+  }, {
+    'target_name': 'tests_chunked_arena',
+    'includes': [
+      'common_test.gypi',
+    ],
+    'sources': [
+      '<(src_loc)/base/chunked_arena.h',
+      '<(src_loc)/base/chunked_arena_tests.cpp',
+    ],
+  }, {
+    'target_name': 'tests_chunked_flat_set',
+    'includes': [
+      'common_test.gypi',
+    ],
+    'sources': [
+      '<(src_loc)/base/chunked_flat_set.h',
+      '<(src_loc)/base/chunked_flat_set_tests.cpp',
+    ],
   }, {
     'target_name': 'tests_flags',
     'includes': [
@@ -83,6 +101,45 @@
       '<(src_loc)/base/flat_set.h',
       '<(src_loc)/base/flat_set_tests.cpp',
     ],
+  }, {
+    'target_name': 'tests_id_map',
+    'includes': [
+      'common_test.gypi',
+    ],
+    'sources': [
+      '<(src_loc)/base/id_map.h',
+      '<(src_loc)/base/id_map_tests.cpp',
+    ],
+  }, {
+    'target_name': 'tests_mpsc_queue',
+    'includes': [
+      'common_test.gypi',
+    ],
+    'sources': [
+      '<(src_loc)/base/mpsc_queue.h',
+      '<(src_loc)/base/mpsc_queue_tests.cpp',
+    ],
+  }, {
+    'target_name': 'tests_openssl_aes',
+    'includes': [
+      'common_test.gypi',
+      '../openssl.gypi',
+    ],
+    'dependencies': [
+      '../lib_base.gyp:lib_base',
+    ],
+    'sources': [
+      '<(src_loc)/base/openssl_aes_tests.cpp',
+    ],
+  }, {
+    'target_name': 'tests_request_batches',
+    'includes': [
+      'common_test.gypi',
+    ],
+    'sources': [
+      '<(src_loc)/base/request_batches.h',
+      '<(src_loc)/base/request_batches_tests.cpp',
+    ],
   }, {
     'target_name': 'tests_rpl',
     'includes': [